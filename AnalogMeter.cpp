@@ -2,40 +2,77 @@
 
 AnalogMeter::AnalogMeter()
 {
-    startTimerHz(30); // Update 30 times per second
+    ballistics.setDecayRate(15.0f); // Slower fall than the bar meter, like a VU needle
+    ballistics.setHoldTime(0.0f);
+    ballistics.reset(0.0f);
 }
 
 AnalogMeter::~AnalogMeter()
 {
 }
 
-void AnalogMeter::setGainReduction(double newGainReduction)
+float AnalogMeter::getNeedleAngle(double reductionDB) const
 {
-    gainReduction = newGainReduction;
-    repaint();
+    return juce::jmap((float)reductionDB, 0.0f, 30.0f, -juce::MathConstants<float>::pi / 4, juce::MathConstants<float>::pi / 4);
+}
+
+juce::Line<float> AnalogMeter::getNeedle(float angle) const
+{
+    return juce::Line<float>(getWidth() / 2.0f, getHeight() / 2.0f, getWidth() / 2.0f + std::cos(angle) * getWidth() / 2.0f, getHeight() / 2.0f - std::sin(angle) * getHeight() / 2.0f);
+}
+
+juce::Rectangle<int> AnalogMeter::getNeedleArea(float angle) const
+{
+    const auto needle = getNeedle(angle);
+    return juce::Rectangle<float>(needle.getStart(), needle.getEnd()).expanded(2.0f).getSmallestIntegerContainer();
+}
+
+void AnalogMeter::update(float gainReductionDB, float elapsedSeconds)
+{
+    ballistics.update(gainReductionDB, elapsedSeconds);
+
+    // Skip the repaint until the needle tip has visibly moved.
+    const float oldAngle = getNeedleAngle(gainReduction);
+    const float newAngle = getNeedleAngle(ballistics.getValue());
+    const float tipMovement = std::abs(newAngle - oldAngle) * juce::jmax(getWidth(), getHeight()) * 0.5f;
+    if (tipMovement < 0.5f)
+        return;
+
+    gainReduction = ballistics.getValue();
+    repaint(getNeedleArea(oldAngle).getUnion(getNeedleArea(newAngle)));
 }
 
 void AnalogMeter::paint(juce::Graphics& g)
 {
-    g.fillAll(juce::Colours::black);
+    // Dial face from the cache, re-rendered when the size or display scale changes.
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (scale != faceScale)
+    {
+        faceImage = juce::Image(juce::Image::ARGB, juce::jmax(1, juce::roundToInt(getWidth() * scale)),
+                                juce::jmax(1, juce::roundToInt(getHeight() * scale)), true);
+        faceScale = scale;
+
+        juce::Graphics face(faceImage);
+        face.addTransform(juce::AffineTransform::scale(scale));
+        face.fillAll(juce::Colours::black);
 
-    // Draw the meter background
-    g.setColour(juce::Colours::darkgrey);
-    g.fillEllipse(getLocalBounds().toFloat());
+        // Draw the meter background
+        face.setColour(juce::Colours::darkgrey);
+        face.fillEllipse(getLocalBounds().toFloat());
+    }
+
+    g.setOpacity(1.0f);
+    g.drawImage(faceImage, getLocalBounds().toFloat());
 
     // Draw the needle
     g.setColour(juce::Colours::red);
-    float angle = juce::jmap((float)gainReduction, 0.0f, 30.0f, -juce::MathConstants<float>::pi / 4, juce::MathConstants<float>::pi / 4);
     juce::Path needle;
-    needle.addLineSegment(juce::Line<float>(getWidth() / 2.0f, getHeight() / 2.0f, getWidth() / 2.0f + std::cos(angle) * getWidth() / 2.0f, getHeight() / 2.0f - std::sin(angle) * getHeight() / 2.0f), 2.0f);
+    needle.addLineSegment(getNeedle(getNeedleAngle(gainReduction)), 2.0f);
     g.strokePath(needle, juce::PathStrokeType(2.0f));
 }
 
 void AnalogMeter::resized()
 {
-}
-
-void AnalogMeter::timerCallback()
-{
+    faceScale = 0.0f;
     repaint();
 }
@@ -1,22 +1,37 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MeterChannel.h"
 
-class AnalogMeter : public juce::Component, private juce::Timer
+/**
+    Needle-style gain reduction meter. It has no timer of its own: the owner
+    calls update() from its shared refresh, and only the area swept by the
+    needle is repainted, once the tip has moved by at least half a pixel. The
+    dial face is cached as an image.
+*/
+class AnalogMeter : public juce::Component
 {
 public:
     AnalogMeter();
     ~AnalogMeter() override;
 
-    void setGainReduction(double newGainReduction);
+    // Feeds the largest gain reduction (dB) since the last UI tick; the needle falls back smoothly.
+    void update(float gainReductionDB, float elapsedSeconds);
 
     void paint(juce::Graphics& g) override;
     void resized() override;
 
 private:
     double gainReduction = 0.0;
+    MeterBallistics ballistics;
 
-    void timerCallback() override;
+    // Cached dial face at the last seen display scale.
+    juce::Image faceImage;
+    float faceScale = 0.0f;
+
+    float getNeedleAngle(double reductionDB) const;
+    juce::Line<float> getNeedle(float angle) const;
+    juce::Rectangle<int> getNeedleArea(float angle) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalogMeter)
 };
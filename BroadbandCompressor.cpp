@@ -0,0 +1,311 @@
+#include "BroadbandCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+void BroadbandCompressor::prepare(int numChannels, int maxBlockSize, int maxRmsWindowSamples)
+{
+    numChannelsPrepared = std::min(std::max(numChannels, 0), maxChannels);
+    const auto rows = static_cast<size_t>(std::max(numChannelsPrepared, 1));
+
+    scratchRowSize = std::max(maxBlockSize, 1);
+    smoothedGain.assign(rows, 1.0f);
+    envelopeScratch.assign(rows * static_cast<size_t>(scratchRowSize), 0.0f);
+    gainScratch.assign(rows * static_cast<size_t>(scratchRowSize), 0.0f);
+
+    levelDetector.prepare(static_cast<int>(rows), maxRmsWindowSamples);
+    reset();
+}
+
+void BroadbandCompressor::reset()
+{
+    std::fill(smoothedGain.begin(), smoothedGain.end(), 1.0f);
+    levelDetector.reset();
+}
+
+void BroadbandCompressor::setSampleRate(double newSampleRate)
+{
+    if (newSampleRate <= 0.0 || newSampleRate == sampleRate)
+        return;
+
+    sampleRate = newSampleRate;
+    updateCoefficients();
+}
+
+void BroadbandCompressor::setTimes(float newAttackMs, float newReleaseMs)
+{
+    if (newAttackMs == attackMs && newReleaseMs == releaseMs && attackCoeff > 0.0f)
+        return;
+
+    attackMs = newAttackMs;
+    releaseMs = newReleaseMs;
+    updateCoefficients();
+}
+
+void BroadbandCompressor::updateCoefficients()
+{
+    const float rate = static_cast<float>(sampleRate);
+    const float attackTimeSec = attackMs / 1000.0f;
+    const float releaseTimeSec = releaseMs / 1000.0f;
+
+    // The same coefficients drive the envelope follower and the gain smoothing.
+    attackCoeff = std::exp(-1.0f / (attackTimeSec * rate));
+    releaseCoeff = std::exp(-1.0f / (releaseTimeSec * rate));
+
+    // Control-rate segments of at most a sixth of the attack time (0.3 dB off the
+    // per-sample gain at worst on sharp transients); 8 samples at the shortest attacks.
+    const float attackSamples = attackTimeSec * rate;
+    controlStep = maxControlStep;
+    while (controlStep > 8 && static_cast<float>(controlStep * 6) > attackSamples)
+        controlStep /= 2;
+
+    stepAttackCoeff = std::pow(attackCoeff, static_cast<float>(controlStep));
+    stepReleaseCoeff = std::pow(releaseCoeff, static_cast<float>(controlStep));
+
+    if (gainStep > 1)
+        gainStep = controlStep;
+}
+
+void BroadbandCompressor::setCurve(float thresholdDB, float ratio, float kneeDB)
+{
+    if (thresholdDB == curveThresholdDB && ratio == curveRatio && kneeDB == curveKneeDB)
+        return;
+
+    gainComputer.setParameters(thresholdDB, ratio, kneeDB);
+
+    curveThresholdDB = thresholdDB;
+    curveRatio = ratio;
+    curveKneeDB = kneeDB;
+}
+
+void BroadbandCompressor::setControlRateGain(bool shouldUseControlRate)
+{
+    gainStep = shouldUseControlRate ? controlStep : 1;
+}
+
+void BroadbandCompressor::setIsa(GainComputer::Isa newIsa)
+{
+    gainComputer.setIsa(newIsa);
+}
+
+void BroadbandCompressor::setDetector(LevelDetector::Mode newMode, int rmsWindowSamples)
+{
+    levelDetector.setMode(newMode);
+    levelDetector.setRmsWindow(rmsWindowSamples);
+}
+
+void BroadbandCompressor::setPrecision(GainComputer::Precision newPrecision)
+{
+    gainComputer.setPrecision(newPrecision);
+    gainComputer.syncTable();
+}
+
+bool BroadbandCompressor::buildTables()
+{
+    return gainComputer.buildTable();
+}
+
+float* BroadbandCompressor::getEnvelopeScratch(int channel)
+{
+    return envelopeScratch.data() + static_cast<size_t>(channel * scratchRowSize);
+}
+
+float* BroadbandCompressor::getGainScratch(int channel)
+{
+    return gainScratch.data() + static_cast<size_t>(channel * scratchRowSize);
+}
+
+//==============================================================================
+BroadbandCompressor::GroupKernel BroadbandCompressor::getGroupKernel(LinkMode mode, CompressorKernels::Makeup makeup)
+{
+    using Makeup = CompressorKernels::Makeup;
+    using Compressor = BroadbandCompressor;
+
+    // Indexed by link mode, then makeup, in the enums' order.
+    static constexpr GroupKernel kernels[3][3] = {
+        { &Compressor::compressGroup<LinkMode::off, Makeup::unity>,
+          &Compressor::compressGroup<LinkMode::off, Makeup::constant>,
+          &Compressor::compressGroup<LinkMode::off, Makeup::ramp> },
+        { &Compressor::compressGroup<LinkMode::max, Makeup::unity>,
+          &Compressor::compressGroup<LinkMode::max, Makeup::constant>,
+          &Compressor::compressGroup<LinkMode::max, Makeup::ramp> },
+        { &Compressor::compressGroup<LinkMode::average, Makeup::unity>,
+          &Compressor::compressGroup<LinkMode::average, Makeup::constant>,
+          &Compressor::compressGroup<LinkMode::average, Makeup::ramp> }
+    };
+
+    return kernels[static_cast<size_t>(mode)][static_cast<size_t>(makeup)];
+}
+
+float BroadbandCompressor::processGroup(LinkMode mode, float* const* audio, const float* const* detector,
+                                        const ChannelGroups& groups, int group, int numSamples, float link,
+                                        float makeupStart, float makeupEnd)
+{
+    const auto kernel = getGroupKernel(mode, CompressorKernels::getMakeup(makeupStart, makeupEnd));
+    return (this->*kernel)(audio, detector, groups, group, numSamples, link, makeupStart, makeupEnd);
+}
+
+template <BroadbandCompressor::LinkMode mode, CompressorKernels::Makeup makeup>
+float BroadbandCompressor::compressGroup(float* const* audio, const float* const* detector, const ChannelGroups& groups,
+                                         int group, int numSamples, float link, float makeupStart, float makeupEnd)
+{
+    const int* channels = groups.getGroupChannels(group);
+    const int numChannels = groups.getGroupSize(group);
+
+    if constexpr (mode != LinkMode::off)
+    {
+        if (numChannels > 1 && link > 0.0f)
+            return processLinkedGroup<mode == LinkMode::max, makeup>(audio, detector, channels, numChannels,
+                                                                     numSamples, link, makeupStart, makeupEnd);
+    }
+
+    float maxReductionDB = 0.0f;
+
+    for (int i = 0; i < numChannels; ++i)
+        maxReductionDB = std::max(maxReductionDB,
+            processChannel<makeup>(audio[channels[i]], detector[channels[i]], channels[i], numSamples,
+                                   makeupStart, makeupEnd));
+
+    return maxReductionDB;
+}
+
+template <CompressorKernels::Makeup makeup>
+float BroadbandCompressor::processChannel(float* data, const float* detector, int channel, int numSamples,
+                                          float makeupStart, float makeupEnd)
+{
+    auto* envelopeBuffer = getEnvelopeScratch(channel);
+    auto* gainBuffer = getGainScratch(channel);
+
+    // (1) Level detector and envelope follower, (2) static curve over the whole chunk in SIMD lanes
+    // (or once per control-rate segment), (3) gain smoothing and output.
+    levelDetector.process(channel, detector, envelopeBuffer, numSamples, attackCoeff, releaseCoeff);
+
+    // Below the knee with the gain recovered, the curve has nothing to do: only the makeup applies.
+    if (isBelowCurve(envelopeBuffer, &channel, 1, numSamples))
+    {
+        CompressorKernels::applyGainRamp(data, numSamples, makeupStart, makeupEnd);
+        return 0.0f;
+    }
+
+    return applyCurve<makeup>(&data, 1, envelopeBuffer, gainBuffer, numSamples, smoothedGain[static_cast<size_t>(channel)],
+                              makeupStart, makeupEnd);
+}
+
+template <bool useMax, CompressorKernels::Makeup makeup>
+float BroadbandCompressor::processLinkedGroup(float* const* audio, const float* const* detector, const int* channels,
+                                              int numChannels, int numSamples, float link,
+                                              float makeupStart, float makeupEnd)
+{
+    float* envelopes[maxChannels] = {};
+    const float* detectors[maxChannels] = {};
+    float* data[maxChannels] = {};
+
+    for (int i = 0; i < numChannels; ++i)
+    {
+        const int channel = channels[i];
+        envelopes[i] = getEnvelopeScratch(channel);
+        detectors[i] = detector[channel];
+        data[i] = audio[channel];
+    }
+
+    // Every channel's follower advances in one pass over the group, linked as it goes.
+    levelDetector.processLinked<useMax>(channels, numChannels, detectors, envelopes, numSamples,
+                                        attackCoeff, releaseCoeff, link);
+
+    if (link >= 1.0f)
+    {
+        // One detector level, one curve pass and one smoother drive the whole group.
+        if (isBelowCurve(envelopes[0], channels, numChannels, numSamples))
+        {
+            for (int i = 0; i < numChannels; ++i)
+                CompressorKernels::applyGainRamp(data[i], numSamples, makeupStart, makeupEnd);
+
+            return 0.0f;
+        }
+
+        auto& groupGain = smoothedGain[static_cast<size_t>(channels[0])];
+        const float maxReductionDB = applyCurve<makeup>(data, numChannels, envelopes[0], getGainScratch(channels[0]),
+                                                        numSamples, groupGain, makeupStart, makeupEnd);
+
+        for (int i = 1; i < numChannels; ++i)
+            smoothedGain[static_cast<size_t>(channels[i])] = groupGain;
+
+        return maxReductionDB;
+    }
+
+    // Partial link: each channel has moved towards the shared level by the link amount.
+    float maxReductionDB = 0.0f;
+
+    for (int i = 0; i < numChannels; ++i)
+    {
+        if (isBelowCurve(envelopes[i], channels + i, 1, numSamples))
+        {
+            CompressorKernels::applyGainRamp(data[i], numSamples, makeupStart, makeupEnd);
+            continue;
+        }
+
+        maxReductionDB = std::max(maxReductionDB,
+            applyCurve<makeup>(data + i, 1, envelopes[i], getGainScratch(channels[i]), numSamples,
+                               smoothedGain[static_cast<size_t>(channels[i])], makeupStart, makeupEnd));
+    }
+
+    return maxReductionDB;
+}
+
+template <CompressorKernels::Makeup makeup>
+float BroadbandCompressor::applyCurve(float* const* data, int numChannels, float* envelope, float* gain,
+                                      int numSamples, float& state, float makeupStart, float makeupEnd)
+{
+    if (gainStep == 1)
+    {
+        const float maxReductionDB = gainComputer.process(envelope, gain, numSamples);
+
+        CompressorKernels::applyGain<makeup>(data, numChannels, gain, numSamples, state,
+                                             attackCoeff, releaseCoeff, makeupStart, makeupEnd);
+        return maxReductionDB;
+    }
+
+    // Control rate: one curve value per segment, from its peak so no transient is missed.
+    const int numSegments = CompressorKernels::findSegmentMaxima(envelope, envelope, numSamples, gainStep);
+    const float maxReductionDB = gainComputer.process(envelope, gain, numSegments);
+
+    CompressorKernels::applyGainInterpolated<makeup>(data, numChannels, gain, gainStep, numSamples, state,
+                                                     attackCoeff, releaseCoeff,
+                                                     stepAttackCoeff, stepReleaseCoeff, makeupStart, makeupEnd);
+    return maxReductionDB;
+}
+
+bool BroadbandCompressor::isBelowCurve(const float* envelope, const int* channels, int numChannels, int numSamples)
+{
+    for (int i = 0; i < numChannels; ++i)
+        if (smoothedGain[static_cast<size_t>(channels[i])] < CompressorKernels::recoveredGain)
+            return false;
+
+    if (CompressorKernels::findMaximum(envelope, numSamples) >= gainComputer.getOnsetLevel())
+        return false;
+
+    // Unity from here on, so the next chunk starts settled as well.
+    for (int i = 0; i < numChannels; ++i)
+        smoothedGain[static_cast<size_t>(channels[i])] = 1.0f;
+
+    return true;
+}
+
+//==============================================================================
+bool BroadbandCompressor::isSettled() const
+{
+    for (int channel = 0; channel < numChannelsPrepared; ++channel)
+        if (smoothedGain[static_cast<size_t>(channel)] < CompressorKernels::recoveredGain
+            || levelDetector.getLevel(channel) >= gainComputer.getOnsetLevel())
+            return false;
+
+    return true;
+}
+
+void BroadbandCompressor::skipSilence(int numSamples)
+{
+    // Zero in, zero out: the gains stay as they are; the envelopes decay.
+    for (int channel = 0; channel < numChannelsPrepared; ++channel)
+        levelDetector.skipSilence(channel, numSamples, releaseCoeff);
+}
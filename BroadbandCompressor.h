@@ -0,0 +1,157 @@
+#pragma once
+
+#include "ChannelGroups.h"
+#include "CompressorKernels.h"
+#include "GainComputer.h"
+#include "LevelDetector.h"
+
+#include <vector>
+
+//==============================================================================
+/**
+    The broadband compressor: level detection, channel linking, the static
+    curve, gain smoothing and the output multiply, for the channels of a bus
+    in link groups.
+
+    Each chunk runs in three passes per channel: the detector (LevelDetector),
+    the vectorised static curve (GainComputer), then gain smoothing and the
+    output multiply (CompressorKernels). A linked group's detectors run as one
+    pass over all its channels, which also links them; fully linked, the group
+    then needs one curve pass and one smoother. The attack/release coefficients are
+    only recomputed when the times or the rate change. Linking (max or mean)
+    and the kind of makeup are template parameters of the group passes, so
+    their sample loops test neither; getGroupKernel picks the variant once
+    per chunk from a small table.
+
+    Chunks whose envelope stays below the curve with the gain recovered skip
+    the curve and apply only the makeup. With control-rate gain on, the curve
+    and gain smoother run once per segment of 8, 16 or 32 samples (the longest
+    that is at most a sixth of the attack time) on the segment's peak envelope,
+    and the gain is interpolated linearly in between.
+
+    Nothing here depends on JUCE: the plugin runs it with its sidechain,
+    lookahead and oversampling around it, and JsgrCompressor's C API runs it
+    on caller-owned buffers. Different groups share no state, so the groups
+    of one chunk may run on different threads.
+
+    All buffers are allocated in prepare(); nothing allocates while processing.
+*/
+class BroadbandCompressor
+{
+public:
+    // How the detectors of a link group are combined.
+    enum class LinkMode
+    {
+        off,     // Independent compression
+        max,     // Loudest channel drives the group
+        average  // Mean of the group's channels drives it
+    };
+
+    static constexpr int maxChannels = ChannelGroups::maxChannels;
+    static_assert(maxChannels <= LevelDetector::maxLinkedChannels, "A link group must fit the detector's lanes");
+    static constexpr int maxControlStep = 32;
+
+    /** maxBlockSize and maxRmsWindowSamples are at the processing rate (after any
+        oversampling); the group passes take at most maxBlockSize samples at a time. */
+    void prepare(int numChannels, int maxBlockSize, int maxRmsWindowSamples);
+    void reset();
+
+    /** The rate the passes run at; the coefficients follow when it changes. */
+    void setSampleRate(double newSampleRate);
+    void setTimes(float attackMs, float releaseMs);
+    void setCurve(float thresholdDB, float ratio, float kneeDB);
+
+    /** Curve and smoothing once per segment (on) or every sample (off). */
+    void setControlRateGain(bool shouldUseControlRate);
+
+    void setIsa(GainComputer::Isa newIsa);
+    GainComputer::Isa getIsa() const { return gainComputer.getIsa(); }
+
+    /** Detector mode (see LevelDetector); rmsWindowSamples is at the processing rate. Call it
+        once per block: the window moves towards its length in bounded steps. */
+    void setDetector(LevelDetector::Mode newMode, int rmsWindowSamples);
+
+    /** Sets the curve precision and picks up its latest table (see GainComputer::syncTable:
+        audio thread, once per block, outside the group passes). */
+    void setPrecision(GainComputer::Precision newPrecision);
+
+    /** GainComputer::buildTable; background thread only. */
+    bool buildTables();
+
+    /** Compresses one group's channels of audio in place, detecting on detector (which may
+        be the audio itself), with the makeup gain ramping linearly from makeupStart to
+        makeupEnd. link is how far each channel moves towards the group's level. Returns
+        the largest gain reduction in dB. */
+    using GroupKernel = float (BroadbandCompressor::*)(float* const*, const float* const*, const ChannelGroups&, int,
+                                                        int, float, float, float);
+    static GroupKernel getGroupKernel(LinkMode mode, CompressorKernels::Makeup makeup);
+
+    /** Looks the kernel up and runs it, for callers that don't keep it across groups. */
+    float processGroup(LinkMode mode, float* const* audio, const float* const* detector, const ChannelGroups& groups,
+                       int group, int numSamples, float link, float makeupStart, float makeupEnd);
+
+    /** True when every channel's level is below the curve and its gain has recovered:
+        silent input would come out silent. */
+    bool isSettled() const;
+
+    /** Accounts for numSamples of silent input without processing them (the envelopes
+        decay as they would have); only valid while isSettled(). */
+    void skipSilence(int numSamples);
+
+private:
+    int numChannelsPrepared{ 0 };
+    double sampleRate{ 44100.0 };
+
+    // Envelope/gain smoothing coefficients and the values they were computed from.
+    float attackMs{ 10.0f };
+    float releaseMs{ 100.0f };
+    float attackCoeff{ 0.0f };
+    float releaseCoeff{ 0.0f };
+
+    // Control-rate gain: the segment length the attack time allows, the smoothing
+    // coefficients over one segment, and the length the passes run with (1 = off).
+    int controlStep{ 8 };
+    float stepAttackCoeff{ 0.0f };
+    float stepReleaseCoeff{ 0.0f };
+    int gainStep{ 1 };
+
+    // Curve values last handed to the gain computer.
+    float curveThresholdDB{ 0.0f };
+    float curveRatio{ 0.0f };
+    float curveKneeDB{ -1.0f };
+
+    GainComputer gainComputer;
+    LevelDetector levelDetector;
+
+    // Applied linear gain per channel, and the per-chunk scratch, one row per channel.
+    // Plain vectors: worker threads write their groups' rows concurrently.
+    std::vector<float> smoothedGain;
+    std::vector<float> envelopeScratch;
+    std::vector<float> gainScratch;
+    int scratchRowSize{ 0 };
+
+    float* getEnvelopeScratch(int channel);
+    float* getGainScratch(int channel);
+
+    void updateCoefficients();
+
+    template <LinkMode mode, CompressorKernels::Makeup makeup>
+    float compressGroup(float* const* audio, const float* const* detector, const ChannelGroups& groups, int group,
+                        int numSamples, float link, float makeupStart, float makeupEnd);
+    template <CompressorKernels::Makeup makeup>
+    float processChannel(float* data, const float* detector, int channel, int numSamples,
+                         float makeupStart, float makeupEnd);
+    template <bool useMax, CompressorKernels::Makeup makeup>
+    float processLinkedGroup(float* const* audio, const float* const* detector, const int* channels, int numChannels,
+                             int numSamples, float link, float makeupStart, float makeupEnd);
+
+    // The curve, the gain smoothing and the multiply for channels sharing one gain,
+    // per sample or (gainStep > 1) at control rate; envelope is overwritten.
+    template <CompressorKernels::Makeup makeup>
+    float applyCurve(float* const* data, int numChannels, float* envelope, float* gain, int numSamples,
+                     float& state, float makeupStart, float makeupEnd);
+
+    // True (and the channels' gains snapped to unity) when the channels' gains have
+    // recovered and envelope stays below the curve's onset for the whole chunk.
+    bool isBelowCurve(const float* envelope, const int* channels, int numChannels, int numSamples);
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+//==============================================================================
+/**
+    A partition of a bus's channels into link groups: the channels of a group
+    share one detector level (and, fully linked, one gain), while different
+    groups are compressed independently of each other, which also makes them
+    the unit of work for multithreaded processing.
+
+    Plain fixed-size arrays, so a layout can be swapped in on the audio thread
+    without allocating.
+*/
+struct ChannelGroups
+{
+    static constexpr int maxChannels = 16;
+
+    int numGroups{ 0 };
+    std::array<int, maxChannels> channels{};    // Channel indices, group after group
+    std::array<int, maxChannels + 1> offsets{}; // Group g is channels[offsets[g]] .. channels[offsets[g + 1] - 1]
+
+    int getGroupSize(int group) const { return offsets[static_cast<std::size_t>(group + 1)] - offsets[static_cast<std::size_t>(group)]; }
+    const int* getGroupChannels(int group) const { return channels.data() + offsets[static_cast<std::size_t>(group)]; }
+
+    /** Starts a new group; add its channels with addChannel(). */
+    void beginGroup()
+    {
+        ++numGroups;
+        offsets[static_cast<std::size_t>(numGroups)] = offsets[static_cast<std::size_t>(numGroups - 1)];
+    }
+
+    void addChannel(int channel)
+    {
+        channels[static_cast<std::size_t>(offsets[static_cast<std::size_t>(numGroups)]++)] = channel;
+    }
+
+    void clear()
+    {
+        numGroups = 0;
+        offsets[0] = 0;
+    }
+
+    /** All channels in one group. */
+    static ChannelGroups wholeBus(int numChannels)
+    {
+        ChannelGroups groups;
+        groups.beginGroup();
+
+        for (int ch = 0; ch < numChannels && ch < maxChannels; ++ch)
+            groups.addChannel(ch);
+
+        return groups;
+    }
+
+    /** Every channel on its own. */
+    static ChannelGroups independent(int numChannels)
+    {
+        ChannelGroups groups;
+
+        for (int ch = 0; ch < numChannels && ch < maxChannels; ++ch)
+        {
+            groups.beginGroup();
+            groups.addChannel(ch);
+        }
+
+        return groups;
+    }
+};
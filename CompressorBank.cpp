@@ -0,0 +1,255 @@
+#include "CompressorBank.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // As in GainComputer: envelopes are floored at -100 dB, and 100 dB of reduction mutes.
+    constexpr float minusInfinityGain = 1.0e-5f;
+    constexpr float maxReductionDB = 100.0f;
+
+    // The lane loops run on 4-float vectors where the platform has them, one float otherwise.
+#if FASTMATH_SSE2
+    using Vector = __m128;
+    using Mask = __m128;
+    constexpr int vectorSize = 4;
+
+    inline Vector load(const float* source)              { return _mm_loadu_ps(source); }
+    inline void store(float* destination, Vector v)      { _mm_storeu_ps(destination, v); }
+    inline Vector broadcast(float x)                     { return _mm_set1_ps(x); }
+    inline Vector add(Vector a, Vector b)                { return _mm_add_ps(a, b); }
+    inline Vector subtract(Vector a, Vector b)           { return _mm_sub_ps(a, b); }
+    inline Vector multiply(Vector a, Vector b)           { return _mm_mul_ps(a, b); }
+    inline Vector minimum(Vector a, Vector b)            { return _mm_min_ps(a, b); }
+    inline Vector maximum(Vector a, Vector b)            { return _mm_max_ps(a, b); }
+    inline Vector absolute(Vector v)                     { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+    inline Mask greaterThan(Vector a, Vector b)          { return _mm_cmpgt_ps(a, b); }
+    inline Vector select(Mask m, Vector a, Vector b)     { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    inline Vector log2(Vector v)                         { return FastMath::sse2::log2(v); }
+    inline Vector exp2(Vector v)                         { return FastMath::sse2::exp2(v); }
+#elif FASTMATH_NEON
+    using Vector = float32x4_t;
+    using Mask = uint32x4_t;
+    constexpr int vectorSize = 4;
+
+    inline Vector load(const float* source)              { return vld1q_f32(source); }
+    inline void store(float* destination, Vector v)      { vst1q_f32(destination, v); }
+    inline Vector broadcast(float x)                     { return vdupq_n_f32(x); }
+    inline Vector add(Vector a, Vector b)                { return vaddq_f32(a, b); }
+    inline Vector subtract(Vector a, Vector b)           { return vsubq_f32(a, b); }
+    inline Vector multiply(Vector a, Vector b)           { return vmulq_f32(a, b); }
+    inline Vector minimum(Vector a, Vector b)            { return vminq_f32(a, b); }
+    inline Vector maximum(Vector a, Vector b)            { return vmaxq_f32(a, b); }
+    inline Vector absolute(Vector v)                     { return vabsq_f32(v); }
+    inline Mask greaterThan(Vector a, Vector b)          { return vcgtq_f32(a, b); }
+    inline Vector select(Mask m, Vector a, Vector b)     { return vbslq_f32(m, a, b); }
+    inline Vector log2(Vector v)                         { return FastMath::neon::log2(v); }
+    inline Vector exp2(Vector v)                         { return FastMath::neon::exp2(v); }
+#else
+    using Vector = float;
+    using Mask = bool;
+    constexpr int vectorSize = 1;
+
+    inline Vector load(const float* source)              { return *source; }
+    inline void store(float* destination, Vector v)      { *destination = v; }
+    inline Vector broadcast(float x)                     { return x; }
+    inline Vector add(Vector a, Vector b)                { return a + b; }
+    inline Vector subtract(Vector a, Vector b)           { return a - b; }
+    inline Vector multiply(Vector a, Vector b)           { return a * b; }
+    inline Vector minimum(Vector a, Vector b)            { return std::min(a, b); }
+    inline Vector maximum(Vector a, Vector b)            { return std::max(a, b); }
+    inline Vector absolute(Vector v)                     { return std::abs(v); }
+    inline Mask greaterThan(Vector a, Vector b)          { return a > b; }
+    inline Vector select(Mask m, Vector a, Vector b)     { return m ? a : b; }
+    inline Vector log2(Vector v)                         { return FastMath::log2(v); }
+    inline Vector exp2(Vector v)                         { return FastMath::exp2(v); }
+#endif
+}
+
+//==============================================================================
+void CompressorBank::prepare(int newNumCompressors, double newSampleRate, int maxBlockSize)
+{
+    numCompressors = std::max(newNumCompressors, 0);
+    groupWidth = numCompressors >= 16 ? 16 : (numCompressors >= 8 ? 8 : 4);
+    numLanes = (numCompressors + groupWidth - 1) / groupWidth * groupWidth;
+    blockSize = std::max(maxBlockSize, 1);
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+
+    const auto lanes = static_cast<size_t>(numLanes);
+    parameters.assign(lanes, Parameters{});
+
+    for (auto* values : { &thresholdDB, &slope, &kneeDB, &kneeStartDB, &kneeEndDB, &kneeScale,
+                          &attackCoeff, &releaseCoeff, &makeupGain,
+                          &envelope, &smoothedGain, &appliedMakeupGain, &reductionDB })
+        values->assign(lanes, 0.0f);
+
+    interleaved.assign(static_cast<size_t>(blockSize) * static_cast<size_t>(groupWidth), 0.0f);
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        updateLane(lane);
+
+    reset();
+}
+
+void CompressorBank::reset()
+{
+    std::fill(envelope.begin(), envelope.end(), 0.0f);
+    std::fill(smoothedGain.begin(), smoothedGain.end(), 1.0f);
+    std::fill(reductionDB.begin(), reductionDB.end(), 0.0f);
+    appliedMakeupGain = makeupGain;
+}
+
+void CompressorBank::setParameters(int index, const Parameters& newParameters)
+{
+    parameters[static_cast<size_t>(index)] = newParameters;
+    updateLane(index);
+}
+
+void CompressorBank::updateLane(int lane)
+{
+    // The curve constants as GainComputer::setParameters derives them, and the
+    // processor's attack/release coefficients.
+    const auto i = static_cast<size_t>(lane);
+    const auto& p = parameters[i];
+    const float rate = static_cast<float>(sampleRate);
+
+    thresholdDB[i] = p.thresholdDB;
+    slope[i] = 1.0f - 1.0f / p.ratio;
+    kneeDB[i] = std::max(p.kneeDB, 0.0f);
+    kneeStartDB[i] = p.thresholdDB - kneeDB[i] * 0.5f;
+    kneeEndDB[i] = p.thresholdDB + kneeDB[i] * 0.5f;
+    kneeScale[i] = kneeDB[i] > 0.0f ? slope[i] / (2.0f * kneeDB[i]) : 0.0f;
+    attackCoeff[i] = std::exp(-1.0f / (p.attackMs / 1000.0f * rate));
+    releaseCoeff[i] = std::exp(-1.0f / (p.releaseMs / 1000.0f * rate));
+    makeupGain[i] = std::pow(10.0f, p.makeupDB * 0.05f);
+}
+
+void CompressorBank::process(float* const* channels, int numSamples)
+{
+    numSamples = std::min(numSamples, blockSize);
+    if (numSamples <= 0)
+        return;
+
+    for (int firstLane = 0; firstLane < numLanes; firstLane += groupWidth)
+    {
+        const int numInGroup = std::min(groupWidth, numCompressors - firstLane);
+
+        // Lane-major in: one frame of groupWidth values per sample, silence in the padding.
+        for (int lane = 0; lane < groupWidth; ++lane)
+        {
+            const float* source = lane < numInGroup ? channels[firstLane + lane] : nullptr;
+
+            for (int i = 0; i < numSamples; ++i)
+                interleaved[static_cast<size_t>(i * groupWidth + lane)] = source != nullptr ? source[i] : 0.0f;
+        }
+
+        switch (groupWidth)
+        {
+            case 16: processGroup<16>(firstLane, numSamples); break;
+            case 8:  processGroup<8>(firstLane, numSamples);  break;
+            default: processGroup<4>(firstLane, numSamples);  break;
+        }
+
+        for (int lane = 0; lane < numInGroup; ++lane)
+        {
+            float* destination = channels[firstLane + lane];
+
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = interleaved[static_cast<size_t>(i * groupWidth + lane)];
+        }
+    }
+}
+
+template <int width>
+void CompressorBank::processGroup(int firstLane, int numSamples)
+{
+    // The group as width / vectorSize vectors per quantity, held in registers for the
+    // whole block: each sample advances every vector of the group, and the vectors'
+    // recursions are independent, so they overlap instead of waiting on each other.
+    constexpr int numVectors = width / vectorSize;
+    Vector threshold[numVectors], slopes[numVectors], knee[numVectors], kneeStart[numVectors];
+    Vector kneeEnd[numVectors], kneeScales[numVectors], attack[numVectors], release[numVectors];
+    Vector env[numVectors], gain[numVectors], makeup[numVectors], makeupStep[numVectors], minTarget[numVectors];
+
+    float steps[width];
+    const float sampleScale = 1.0f / static_cast<float>(numSamples);
+
+    for (int lane = 0; lane < width; ++lane)
+    {
+        const auto i = static_cast<size_t>(firstLane + lane);
+        steps[lane] = (makeupGain[i] - appliedMakeupGain[i]) * sampleScale;
+    }
+
+    for (int v = 0; v < numVectors; ++v)
+    {
+        const auto i = static_cast<size_t>(firstLane + v * vectorSize);
+        threshold[v] = load(&thresholdDB[i]);
+        slopes[v] = load(&slope[i]);
+        knee[v] = load(&kneeDB[i]);
+        kneeStart[v] = load(&kneeStartDB[i]);
+        kneeEnd[v] = load(&kneeEndDB[i]);
+        kneeScales[v] = load(&kneeScale[i]);
+        attack[v] = load(&attackCoeff[i]);
+        release[v] = load(&releaseCoeff[i]);
+        env[v] = load(&envelope[i]);
+        gain[v] = load(&smoothedGain[i]);
+        makeup[v] = load(&appliedMakeupGain[i]);
+        makeupStep[v] = load(steps + v * vectorSize);
+        minTarget[v] = broadcast(1.0f);
+    }
+
+    const Vector one = broadcast(1.0f);
+    const Vector zero = broadcast(0.0f);
+    const Vector floor = broadcast(minusInfinityGain);
+    const Vector dbPerLog2 = broadcast(FastMath::dbPerLog2);
+    const Vector negLog2PerDb = broadcast(-FastMath::log2PerDb);
+    const Vector infinityDB = broadcast(maxReductionDB);
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        float* frame = interleaved.data() + static_cast<size_t>(sample * width);
+
+        for (int v = 0; v < numVectors; ++v)
+        {
+            // Peak envelope follower (CompressorKernels::followEnvelope).
+            const Vector inputAbs = absolute(load(frame + v * vectorSize));
+            const Vector envCoeff = select(greaterThan(inputAbs, env[v]), attack[v], release[v]);
+            env[v] = add(multiply(envCoeff, env[v]), multiply(subtract(one, envCoeff), inputAbs));
+
+            // Static curve, as in the GainComputer SIMD kernels.
+            const Vector levelDB = multiply(dbPerLog2, log2(maximum(env[v], floor)));
+            const Vector delta = minimum(maximum(subtract(levelDB, kneeStart[v]), zero), knee[v]);
+            const Vector reduction = select(greaterThan(levelDB, kneeEnd[v]),
+                                            multiply(subtract(levelDB, threshold[v]), slopes[v]),
+                                            multiply(kneeScales[v], multiply(delta, delta)));
+            const Vector target = select(greaterThan(infinityDB, reduction), exp2(multiply(reduction, negLog2PerDb)), zero);
+            minTarget[v] = minimum(minTarget[v], target);
+
+            // Gain smoothing and makeup (CompressorKernels::applyGain).
+            const Vector gainCoeff = select(greaterThan(gain[v], target), attack[v], release[v]);
+            gain[v] = add(target, multiply(subtract(gain[v], target), gainCoeff));
+            makeup[v] = add(makeup[v], makeupStep[v]);
+            store(frame + v * vectorSize, multiply(load(frame + v * vectorSize), multiply(gain[v], makeup[v])));
+        }
+    }
+
+    float minTargets[width];
+
+    for (int v = 0; v < numVectors; ++v)
+    {
+        const auto i = static_cast<size_t>(firstLane + v * vectorSize);
+        store(&envelope[i], env[v]);
+        store(&smoothedGain[i], gain[v]);
+        store(minTargets + v * vectorSize, minTarget[v]);
+    }
+
+    for (int lane = 0; lane < width; ++lane)
+    {
+        const auto i = static_cast<size_t>(firstLane + lane);
+        appliedMakeupGain[i] = makeupGain[i];
+        reductionDB[i] = minTargets[lane] >= 1.0f ? 0.0f
+                       : (minTargets[lane] > 0.0f ? -20.0f * std::log10(minTargets[lane]) : maxReductionDB);
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+//==============================================================================
+/**
+    Many independent mono compressors processed together: the peak envelope
+    follower, the static curve (threshold, ratio, soft knee), the gain smoothing
+    and the makeup, as in the plugin's broadband path, for a few hundred stems
+    at once.
+
+    State and per-compressor constants are kept as structure of arrays, one
+    array per quantity with one slot per compressor. The compressors run in
+    groups of 4, 8 or 16 lanes (the widest the bank's size fills): each group's
+    audio is interleaved into a lane-major scratch, every sample advances all
+    lanes of the group as 1, 2 or 4 SSE2/NEON vectors (one float at a time on
+    other targets) whose recursions overlap, and the result is written back.
+    The curve uses FastMath's approximations, the same as the GainComputer
+    SIMD kernels, so a bank of one gives the plugin's output for the same
+    settings (unlinked, peak detector, no lookahead or oversampling) to within
+    their 0.001 dB.
+
+    All buffers are allocated in prepare(); nothing allocates while processing.
+    One thread at a time: parameters are set between process() calls.
+*/
+class CompressorBank
+{
+public:
+    struct Parameters
+    {
+        float thresholdDB{ -24.0f };
+        float ratio{ 4.0f };
+        float kneeDB{ 0.0f };
+        float attackMs{ 10.0f };
+        float releaseMs{ 100.0f };
+        float makeupDB{ 0.0f };
+    };
+
+    /** Allocates numCompressors compressors with default parameters; process() takes
+        at most maxBlockSize samples at a time. Not realtime safe. */
+    void prepare(int numCompressors, double sampleRate, int maxBlockSize);
+    void reset();
+
+    int getNumCompressors() const { return numCompressors; }
+
+    /** Lanes each group advances per sample (4, 8 or 16, picked in prepare()). */
+    int getGroupWidth() const { return groupWidth; }
+
+    /** Takes effect at the next process(); a makeup change ramps over that block. */
+    void setParameters(int index, const Parameters& newParameters);
+    const Parameters& getParameters(int index) const { return parameters[static_cast<size_t>(index)]; }
+
+    /** Compresses channels[i] in place with compressor i, for every compressor. */
+    void process(float* const* channels, int numSamples);
+
+    /** Largest gain reduction of compressor index in the last process(), in dB (>= 0). */
+    float getReductionDB(int index) const { return reductionDB[static_cast<size_t>(index)]; }
+
+private:
+    int numCompressors{ 0 };
+    int numLanes{ 0 };       // numCompressors rounded up to whole groups
+    int groupWidth{ 4 };
+    int blockSize{ 0 };
+    double sampleRate{ 44100.0 };
+
+    std::vector<Parameters> parameters;
+
+    // Per-lane constants (padding lanes keep the defaults and see silence).
+    std::vector<float> thresholdDB;
+    std::vector<float> slope;           // 1 - 1 / ratio
+    std::vector<float> kneeDB;
+    std::vector<float> kneeStartDB;
+    std::vector<float> kneeEndDB;
+    std::vector<float> kneeScale;       // slope / (2 * knee), 0 for a hard knee
+    std::vector<float> attackCoeff;
+    std::vector<float> releaseCoeff;
+    std::vector<float> makeupGain;      // Target for the next block
+
+    // Per-lane state.
+    std::vector<float> envelope;
+    std::vector<float> smoothedGain;
+    std::vector<float> appliedMakeupGain;
+    std::vector<float> reductionDB;
+
+    // One group's audio, sample-major: [sample * groupWidth + lane].
+    std::vector<float> interleaved;
+
+    void updateLane(int lane);
+
+    template <int width>
+    void processGroup(int firstLane, int numSamples);
+};
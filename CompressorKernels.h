@@ -0,0 +1,320 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+/**
+    The per-channel passes of the compressor around the static curve, shared by
+    the broadband path and every band of the multiband engine:
+
+    followEnvelope -> [linkEnvelopes] -> GainComputer::process -> applyGain
+
+    Each pass runs over a whole chunk and carries its state (envelope level,
+    smoothed gain) in and out by reference. The envelope follower and the gain
+    smoother are recursive and stay scalar; the multi-lane versions run several
+    independent recursions side by side instead. Linking and the final multiply
+    are plain loops the compiler can vectorise.
+
+    Settings that hold for a whole chunk (max or mean linking, the kind of
+    makeup) are template parameters rather than per-sample tests, so each
+    instantiation's loop only does the work of its mode; callers pick the
+    instantiation once per chunk.
+*/
+namespace CompressorKernels
+{
+    /** Smoothed gains this close to unity count as recovered for the below-threshold bypass. */
+    inline constexpr float recoveredGain = 1.0f - 1.0e-5f;
+
+    /** Attack/release envelope of |detector|, written to envelope. */
+    inline void followEnvelope(const float* detector, float* envelope, int numSamples, float& state,
+                               float attackCoeff, float releaseCoeff)
+    {
+        float env = state;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float inputAbs = std::abs(detector[i]);
+            const float coeff = inputAbs > env ? attackCoeff : releaseCoeff;
+            env = coeff * env + (1.0f - coeff) * inputAbs;
+            envelope[i] = env;
+        }
+
+        state = env;
+    }
+
+    /** followEnvelope for numLanes independent detectors at once (e.g. every band
+        and channel of the multiband split). The lanes advance sample by sample
+        side by side, so one lane's recursion overlaps the others' instead of
+        stalling on its own latency. states and the coefficients are per lane. */
+    inline void followEnvelopes(const float* const* detectors, float* const* envelopes, int numLanes, int numSamples,
+                                float* states, const float* attackCoeffs, const float* releaseCoeffs)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                const float inputAbs = std::abs(detectors[lane][i]);
+                const float env = states[lane];
+                const float coeff = inputAbs > env ? attackCoeffs[lane] : releaseCoeffs[lane];
+                states[lane] = coeff * env + (1.0f - coeff) * inputAbs;
+                envelopes[lane][i] = states[lane];
+            }
+        }
+    }
+
+    /** The level a stereo pair is linked towards: the louder side, or the mean. */
+    template <bool useMax>
+    inline float getLinkedLevel(float left, float right)
+    {
+        if constexpr (useMax)
+            return std::max(left, right);
+        else
+            return 0.5f * (left + right);
+    }
+
+    /** Moves each side of a stereo pair towards their max (or mean) by link (0..1).
+        A full link leaves the shared level in both. */
+    template <bool useMax>
+    inline void linkEnvelopes(float* left, float* right, int numSamples, float link)
+    {
+        if (link >= 1.0f)
+        {
+            for (int i = 0; i < numSamples; ++i)
+                left[i] = right[i] = getLinkedLevel<useMax>(left[i], right[i]);
+
+            return;
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float linked = getLinkedLevel<useMax>(left[i], right[i]);
+            left[i] += link * (linked - left[i]);
+            right[i] += link * (linked - right[i]);
+        }
+    }
+
+    /** linkEnvelopes for a link group of any size: every channel moves towards the
+        group's max (or mean). Pairs take the stereo version above. */
+    template <bool useMax>
+    inline void linkEnvelopes(float* const* envelopes, int numChannels, int numSamples, float link)
+    {
+        if (numChannels < 2)
+            return;
+
+        if (numChannels == 2)
+        {
+            linkEnvelopes<useMax>(envelopes[0], envelopes[1], numSamples, link);
+            return;
+        }
+
+        const float meanScale = 1.0f / static_cast<float>(numChannels);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float linked = envelopes[0][i];
+
+            for (int ch = 1; ch < numChannels; ++ch)
+            {
+                if constexpr (useMax)
+                    linked = std::max(linked, envelopes[ch][i]);
+                else
+                    linked += envelopes[ch][i];
+            }
+
+            if constexpr (!useMax)
+                linked *= meanScale;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                envelopes[ch][i] += link * (linked - envelopes[ch][i]);
+        }
+    }
+
+    /** linkEnvelopes with the link mode chosen at run time (once for the chunk). */
+    inline void linkEnvelopes(float* const* envelopes, int numChannels, int numSamples, float link, bool useMax)
+    {
+        if (useMax)
+            linkEnvelopes<true>(envelopes, numChannels, numSamples, link);
+        else
+            linkEnvelopes<false>(envelopes, numChannels, numSamples, link);
+    }
+
+    /** What applyGain multiplies in besides the smoothed gain: nothing (unity makeup),
+        one constant, or a linear ramp while the makeup parameter moves. */
+    enum class Makeup
+    {
+        unity,
+        constant,
+        ramp
+    };
+
+    inline Makeup getMakeup(float makeupStart, float makeupEnd)
+    {
+        if (makeupStart != makeupEnd)
+            return Makeup::ramp;
+
+        return makeupStart == 1.0f ? Makeup::unity : Makeup::constant;
+    }
+
+    /** Smooths the curve's target gains with the attack/release coefficients and
+        applies them, together with a linear makeup ramp from makeupStart to
+        makeupEnd, to numChannels channels that share one gain. makeup must be
+        getMakeup(makeupStart, makeupEnd); every mode gives the ramp's result. */
+    template <Makeup makeup>
+    inline void applyGain(float* const* channels, int numChannels, const float* targetGain, int numSamples,
+                          float& state, float attackCoeff, float releaseCoeff, float makeupStart, float makeupEnd)
+    {
+        float gain = state;
+        float makeupGainLinear = makeupStart;
+        const float makeupIncrement = (makeupEnd - makeupStart) / static_cast<float>(numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float desiredGain = targetGain[i];
+            const float gainCoeff = (desiredGain < gain) ? attackCoeff : releaseCoeff;
+            gain = desiredGain + (gain - desiredGain) * gainCoeff;
+
+            float totalGain = gain;
+
+            if constexpr (makeup == Makeup::ramp)
+            {
+                makeupGainLinear += makeupIncrement;
+                totalGain *= makeupGainLinear;
+            }
+            else if constexpr (makeup == Makeup::constant)
+            {
+                totalGain *= makeupStart;
+            }
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch][i] *= totalGain;
+        }
+
+        state = gain;
+    }
+
+    /** applyGain for numLanes independent channels at once, each with its own
+        target gains, state, coefficients and makeup ramp (see followEnvelopes). */
+    inline void applyGains(float* const* channels, const float* const* targetGains, int numLanes, int numSamples,
+                           float* states, const float* attackCoeffs, const float* releaseCoeffs,
+                           const float* makeupStarts, const float* makeupEnds)
+    {
+        const float sampleScale = 1.0f / static_cast<float>(numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float position = static_cast<float>(i + 1) * sampleScale;
+
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                const float desiredGain = targetGains[lane][i];
+                const float gain = states[lane];
+                const float gainCoeff = (desiredGain < gain) ? attackCoeffs[lane] : releaseCoeffs[lane];
+                states[lane] = desiredGain + (gain - desiredGain) * gainCoeff;
+
+                const float makeupGainLinear = makeupStarts[lane] + (makeupEnds[lane] - makeupStarts[lane]) * position;
+                channels[lane][i] *= states[lane] * makeupGainLinear;
+            }
+        }
+    }
+
+    template <Makeup makeup>
+    inline void applyGain(float* data, const float* targetGain, int numSamples, float& state,
+                          float attackCoeff, float releaseCoeff, float makeupStart, float makeupEnd)
+    {
+        applyGain<makeup>(&data, 1, targetGain, numSamples, state, attackCoeff, releaseCoeff, makeupStart, makeupEnd);
+    }
+
+    /** Linear gain ramp from start to end (the makeup ramp on its own); a no-op at unity. */
+    inline void applyGainRamp(float* data, int numSamples, float start, float end)
+    {
+        if (start == 1.0f && end == 1.0f)
+            return;
+
+        float gain = start;
+        const float increment = (end - start) / static_cast<float>(numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            gain += increment;
+            data[i] *= gain;
+        }
+    }
+
+    /** Largest value of a block, for the below-threshold checks. */
+    inline float findMaximum(const float* data, int numSamples)
+    {
+        float maximum = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+            maximum = std::max(maximum, data[i]);
+
+        return maximum;
+    }
+
+    /** Control-rate gain: the largest envelope value of each step samples (the last
+        segment may be shorter), one per segment into control. control may be
+        envelope itself. Returns the number of segments. */
+    inline int findSegmentMaxima(const float* envelope, float* control, int numSamples, int step)
+    {
+        int numSegments = 0;
+
+        for (int start = 0; start < numSamples; start += step)
+            control[numSegments++] = findMaximum(envelope + start, std::min(step, numSamples - start));
+
+        return numSegments;
+    }
+
+    /** applyGain at control rate, for target gains from findSegmentMaxima's segments.
+        The smoother advances one segment at a time with the per-segment coefficients
+        (the per-sample ones to the power step; a short last segment works its own out),
+        so it lands where the per-sample smoother would for a target held over the
+        segment, and the gain is interpolated linearly in between. */
+    template <Makeup makeup>
+    inline void applyGainInterpolated(float* const* channels, int numChannels, const float* targetGain, int step,
+                                      int numSamples, float& state, float attackCoeff, float releaseCoeff,
+                                      float stepAttackCoeff, float stepReleaseCoeff, float makeupStart, float makeupEnd)
+    {
+        float gain = state;
+        float makeupGainLinear = makeupStart;
+        const float makeupIncrement = (makeupEnd - makeupStart) / static_cast<float>(numSamples);
+        const float stepScale = 1.0f / static_cast<float>(step);
+
+        for (int start = 0, segment = 0; start < numSamples; start += step, ++segment)
+        {
+            const int length = std::min(step, numSamples - start);
+            const float desiredGain = targetGain[segment];
+            const bool attacking = desiredGain < gain;
+
+            const float gainCoeff = length == step ? (attacking ? stepAttackCoeff : stepReleaseCoeff)
+                                                   : std::pow(attacking ? attackCoeff : releaseCoeff,
+                                                              static_cast<float>(length));
+            const float segmentEnd = desiredGain + (gain - desiredGain) * gainCoeff;
+            const float increment = (segmentEnd - gain) * (length == step ? stepScale : 1.0f / static_cast<float>(length));
+
+            for (int i = start; i < start + length; ++i)
+            {
+                gain += increment;
+                float totalGain = gain;
+
+                if constexpr (makeup == Makeup::ramp)
+                {
+                    makeupGainLinear += makeupIncrement;
+                    totalGain *= makeupGainLinear;
+                }
+                else if constexpr (makeup == Makeup::constant)
+                {
+                    totalGain *= makeupStart;
+                }
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    channels[ch][i] *= totalGain;
+            }
+
+            // The next segment starts from the exact end, not the accumulated increments.
+            gain = segmentEnd;
+        }
+
+        state = gain;
+    }
+}
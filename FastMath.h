@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define FASTMATH_SSE2 1
+ #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #define FASTMATH_NEON 1
+ #include <arm_neon.h>
+#endif
+
+//==============================================================================
+/**
+    Cheap log2/exp2 approximations used by the vectorised gain computer.
+
+    The scalar versions and the 4-lane SSE2/NEON ones below mirror each other
+    (and the AVX2 ones in GainComputer.cpp) term for term, so the tail of a
+    block (which is handled one sample at a time) gives the same result as the
+    vector body.
+
+    Error bounds over the range the compressor uses (-100 dB .. +24 dB):
+    - log2: |error| < 3e-7 (about 2e-6 dB)
+    - exp2: relative error < 2e-7 (about 2e-6 dB)
+*/
+namespace FastMath
+{
+    constexpr float dbPerLog2 = 6.0205999132796239f;  // 20 * log10(2)
+    constexpr float log2PerDb = 0.16609640474436813f; // log2(10) / 20
+    constexpr float log2e = 1.4426950408889634f;
+    constexpr float ln2 = 0.69314718055994531f;
+    constexpr float sqrt2 = 1.4142135623730951f;
+
+    inline std::int32_t floatBits(float x)
+    {
+        std::int32_t i;
+        std::memcpy(&i, &x, sizeof(i));
+        return i;
+    }
+
+    inline float bitsToFloat(std::int32_t i)
+    {
+        float x;
+        std::memcpy(&x, &i, sizeof(x));
+        return x;
+    }
+
+    /** log2(x) for normal, positive x. The mantissa is folded into [sqrt(0.5), sqrt(2))
+        and ln(m) evaluated with the atanh series 2 * (t + t^3/3 + t^5/5 + t^7/7). */
+    inline float log2(float x)
+    {
+        const auto bits = floatBits(x);
+        auto exponent = static_cast<float>(((bits >> 23) & 0xff) - 127);
+        auto mantissa = bitsToFloat((bits & 0x007fffff) | 0x3f800000);
+
+        if (mantissa > sqrt2)
+        {
+            mantissa *= 0.5f;
+            exponent += 1.0f;
+        }
+
+        const float t = (mantissa - 1.0f) / (mantissa + 1.0f);
+        const float t2 = t * t;
+        const float series = 1.0f + t2 * (1.0f / 3.0f + t2 * (1.0f / 5.0f + t2 * (1.0f / 7.0f)));
+
+        return exponent + 2.0f * log2e * t * series;
+    }
+
+    /** 2^x for x in [-126, 126]. The fractional part is kept in [-0.5, 0.5] and
+        e^(f * ln2) evaluated with a degree 6 Taylor polynomial. */
+    inline float exp2(float x)
+    {
+        x = x < -126.0f ? -126.0f : (x > 126.0f ? 126.0f : x);
+
+        const float rounded = static_cast<float>(static_cast<std::int32_t>(x + (x >= 0.0f ? 0.5f : -0.5f)));
+        const float f = (x - rounded) * ln2;
+        const float p = 1.0f + f * (1.0f + f * (1.0f / 2.0f + f * (1.0f / 6.0f + f * (1.0f / 24.0f
+                      + f * (1.0f / 120.0f + f * (1.0f / 720.0f))))));
+
+        return p * bitsToFloat((static_cast<std::int32_t>(rounded) + 127) << 23);
+    }
+
+    inline float gainToDecibels(float gain)   { return dbPerLog2 * log2(gain); }
+    inline float decibelsToGain(float dB)     { return exp2(dB * log2PerDb); }
+
+#if FASTMATH_SSE2
+    //==============================================================================
+    namespace sse2
+    {
+        inline __m128 log2(__m128 x)
+        {
+            const __m128i bits = _mm_castps_si128(x);
+            __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xff)),
+                                                            _mm_set1_epi32(127)));
+            __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                                            _mm_set1_epi32(0x3f800000)));
+
+            const __m128 fold = _mm_cmpgt_ps(mantissa, _mm_set1_ps(FastMath::sqrt2));
+            mantissa = _mm_or_ps(_mm_and_ps(fold, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f))), _mm_andnot_ps(fold, mantissa));
+            exponent = _mm_add_ps(exponent, _mm_and_ps(fold, _mm_set1_ps(1.0f)));
+
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+            const __m128 t2 = _mm_mul_ps(t, t);
+            __m128 series = _mm_add_ps(_mm_set1_ps(1.0f / 5.0f), _mm_mul_ps(t2, _mm_set1_ps(1.0f / 7.0f)));
+            series = _mm_add_ps(_mm_set1_ps(1.0f / 3.0f), _mm_mul_ps(t2, series));
+            series = _mm_add_ps(one, _mm_mul_ps(t2, series));
+
+            return _mm_add_ps(exponent, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.0f * FastMath::log2e), t), series));
+        }
+
+        inline __m128 exp2(__m128 x)
+        {
+            x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(126.0f));
+
+            const __m128i rounded = _mm_cvtps_epi32(x);
+            const __m128 f = _mm_mul_ps(_mm_sub_ps(x, _mm_cvtepi32_ps(rounded)), _mm_set1_ps(FastMath::ln2));
+
+            __m128 p = _mm_add_ps(_mm_set1_ps(1.0f / 120.0f), _mm_mul_ps(f, _mm_set1_ps(1.0f / 720.0f)));
+            p = _mm_add_ps(_mm_set1_ps(1.0f / 24.0f), _mm_mul_ps(f, p));
+            p = _mm_add_ps(_mm_set1_ps(1.0f / 6.0f), _mm_mul_ps(f, p));
+            p = _mm_add_ps(_mm_set1_ps(1.0f / 2.0f), _mm_mul_ps(f, p));
+            p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(f, p));
+            p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(f, p));
+
+            return _mm_mul_ps(p, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(rounded, _mm_set1_epi32(127)), 23)));
+        }
+    }
+#endif
+
+#if FASTMATH_NEON
+    //==============================================================================
+    namespace neon
+    {
+        inline float32x4_t log2(float32x4_t x)
+        {
+            const int32x4_t bits = vreinterpretq_s32_f32(x);
+            float32x4_t exponent = vcvtq_f32_s32(vsubq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(127)));
+            float32x4_t mantissa = vreinterpretq_f32_s32(vorrq_s32(vandq_s32(bits, vdupq_n_s32(0x007fffff)),
+                                                                   vdupq_n_s32(0x3f800000)));
+
+            const uint32x4_t fold = vcgtq_f32(mantissa, vdupq_n_f32(FastMath::sqrt2));
+            mantissa = vbslq_f32(fold, vmulq_n_f32(mantissa, 0.5f), mantissa);
+            exponent = vbslq_f32(fold, vaddq_f32(exponent, vdupq_n_f32(1.0f)), exponent);
+
+            const float32x4_t one = vdupq_n_f32(1.0f);
+            const float32x4_t den = vaddq_f32(mantissa, one);
+            float32x4_t recip = vrecpeq_f32(den);
+            recip = vmulq_f32(recip, vrecpsq_f32(den, recip));
+            recip = vmulq_f32(recip, vrecpsq_f32(den, recip));
+
+            const float32x4_t t = vmulq_f32(vsubq_f32(mantissa, one), recip);
+            const float32x4_t t2 = vmulq_f32(t, t);
+            float32x4_t series = vmlaq_f32(vdupq_n_f32(1.0f / 5.0f), t2, vdupq_n_f32(1.0f / 7.0f));
+            series = vmlaq_f32(vdupq_n_f32(1.0f / 3.0f), t2, series);
+            series = vmlaq_f32(one, t2, series);
+
+            return vmlaq_f32(exponent, vmulq_n_f32(t, 2.0f * FastMath::log2e), series);
+        }
+
+        inline float32x4_t exp2(float32x4_t x)
+        {
+            x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-126.0f)), vdupq_n_f32(126.0f));
+
+            // Round to nearest by biasing towards the sign and truncating.
+            const float32x4_t bias = vbslq_f32(vcgeq_f32(x, vdupq_n_f32(0.0f)), vdupq_n_f32(0.5f), vdupq_n_f32(-0.5f));
+            const int32x4_t rounded = vcvtq_s32_f32(vaddq_f32(x, bias));
+            const float32x4_t f = vmulq_n_f32(vsubq_f32(x, vcvtq_f32_s32(rounded)), FastMath::ln2);
+
+            float32x4_t p = vmlaq_f32(vdupq_n_f32(1.0f / 120.0f), f, vdupq_n_f32(1.0f / 720.0f));
+            p = vmlaq_f32(vdupq_n_f32(1.0f / 24.0f), f, p);
+            p = vmlaq_f32(vdupq_n_f32(1.0f / 6.0f), f, p);
+            p = vmlaq_f32(vdupq_n_f32(1.0f / 2.0f), f, p);
+            p = vmlaq_f32(vdupq_n_f32(1.0f), f, p);
+            p = vmlaq_f32(vdupq_n_f32(1.0f), f, p);
+
+            return vmulq_f32(p, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(rounded, vdupq_n_s32(127)), 23)));
+        }
+    }
+#endif
+}
@@ -0,0 +1,520 @@
+#include "GainComputer.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define GAINCOMPUTER_X86 1
+ #include <immintrin.h>
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #define GAINCOMPUTER_NEON 1
+ #include <arm_neon.h>
+#endif
+
+namespace
+{
+    // Matches juce::Decibels' default floor: -100 dB in, 0 gain out.
+    constexpr float minusInfinityDB = -100.0f;
+    constexpr float minusInfinityGain = 1.0e-5f;
+
+    //==============================================================================
+    // Reference kernel: the original per-sample maths, unchanged, with the knee test
+    // taken out of the loop (a hard knee only has the threshold to compare against).
+    template <bool softKnee>
+    float processScalar(const GainComputer::Curve& c, const float* envelope, float* gain, int numSamples)
+    {
+        float maxReductionDB = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float env = envelope[i];
+            const float levelDB = env > 0.0f ? std::max(minusInfinityDB, std::log10(env) * 20.0f)
+                                             : minusInfinityDB;
+
+            float reductionDB = 0.0f;
+            if constexpr (softKnee)
+            {
+                if (levelDB > c.kneeEndDB)
+                {
+                    reductionDB = (levelDB - c.thresholdDB) * c.slope;
+                }
+                else if (levelDB >= c.kneeStartDB)
+                {
+                    float delta = levelDB - c.kneeStartDB;
+                    reductionDB = c.slope * (delta * delta) / (2.0f * c.kneeDB);
+                }
+            }
+            else
+            {
+                if (levelDB > c.thresholdDB)
+                    reductionDB = (levelDB - c.thresholdDB) * c.slope;
+            }
+
+            gain[i] = -reductionDB > minusInfinityDB ? std::pow(10.0f, -reductionDB * 0.05f) : 0.0f;
+            maxReductionDB = std::max(maxReductionDB, reductionDB);
+        }
+
+        return maxReductionDB;
+    }
+
+    //==============================================================================
+    // Fast mode: piecewise-linear lookup on the envelope's float bits (see GainComputer::Table).
+    constexpr float tableSegmentScale = 1.0f / static_cast<float>(1 << GainComputer::Table::segmentBits);
+    constexpr std::int32_t tableSegmentMask = (1 << GainComputer::Table::segmentBits) - 1;
+
+    // Returns the smallest gain of the block, starting from minGain.
+    float lookUpTable(const GainComputer::Table& t, const float* envelope, float* gain, int numSamples, float minGain)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float level = std::min(std::max(envelope[i], t.minLevel), t.maxLevel);
+            const std::int32_t offset = FastMath::floatBits(level) - t.baseBits;
+            const auto node = static_cast<size_t>(offset >> GainComputer::Table::segmentBits);
+            const float fraction = static_cast<float>(offset & tableSegmentMask) * tableSegmentScale;
+
+            gain[i] = t.gain[node] + fraction * t.step[node];
+            minGain = std::min(minGain, gain[i]);
+        }
+
+        return minGain;
+    }
+
+    // The curve is monotonic, so the smallest gain carries the largest reduction.
+    float getTableReductionDB(float minGain)
+    {
+        if (minGain >= 1.0f)
+            return 0.0f;
+
+        return minGain > 0.0f ? -20.0f * std::log10(minGain) : -minusInfinityDB;
+    }
+
+    float processTable(const GainComputer::Table& t, const float* envelope, float* gain, int numSamples)
+    {
+        return getTableReductionDB(lookUpTable(t, envelope, gain, numSamples, 1.0f));
+    }
+
+    // Tail handling for the SIMD kernels: same approximations, one sample at a time.
+    float processFastScalar(const GainComputer::Curve& c, const float* envelope, float* gain, int numSamples,
+                            float maxReductionDB)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float levelDB = FastMath::gainToDecibels(std::max(envelope[i], minusInfinityGain));
+            const float delta = std::min(std::max(levelDB - c.kneeStartDB, 0.0f), c.kneeDB);
+            const float reductionDB = levelDB > c.kneeEndDB ? (levelDB - c.thresholdDB) * c.slope
+                                                            : c.kneeScale * delta * delta;
+
+            gain[i] = reductionDB < -minusInfinityDB ? FastMath::decibelsToGain(-reductionDB) : 0.0f;
+            maxReductionDB = std::max(maxReductionDB, reductionDB);
+        }
+
+        return maxReductionDB;
+    }
+
+#if GAINCOMPUTER_X86
+    //==============================================================================
+    namespace sse2
+    {
+        using FastMath::sse2::log2;
+        using FastMath::sse2::exp2;
+
+        float process(const GainComputer::Curve& c, const float* envelope, float* gain, int numSamples)
+        {
+            const __m128 floor = _mm_set1_ps(minusInfinityGain);
+            const __m128 dbPerLog2 = _mm_set1_ps(FastMath::dbPerLog2);
+            const __m128 negLog2PerDb = _mm_set1_ps(-FastMath::log2PerDb);
+            const __m128 threshold = _mm_set1_ps(c.thresholdDB);
+            const __m128 slope = _mm_set1_ps(c.slope);
+            const __m128 knee = _mm_set1_ps(c.kneeDB);
+            const __m128 kneeStart = _mm_set1_ps(c.kneeStartDB);
+            const __m128 kneeEnd = _mm_set1_ps(c.kneeEndDB);
+            const __m128 kneeScale = _mm_set1_ps(c.kneeScale);
+            const __m128 infinityDB = _mm_set1_ps(-minusInfinityDB);
+            const __m128 zero = _mm_setzero_ps();
+            __m128 maxReduction = zero;
+
+            int i = 0;
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                const __m128 levelDB = _mm_mul_ps(dbPerLog2, log2(_mm_max_ps(_mm_loadu_ps(envelope + i), floor)));
+
+                const __m128 delta = _mm_min_ps(_mm_max_ps(_mm_sub_ps(levelDB, kneeStart), zero), knee);
+                const __m128 kneeReduction = _mm_mul_ps(kneeScale, _mm_mul_ps(delta, delta));
+                const __m128 lineReduction = _mm_mul_ps(_mm_sub_ps(levelDB, threshold), slope);
+                const __m128 above = _mm_cmpgt_ps(levelDB, kneeEnd);
+                const __m128 reduction = _mm_or_ps(_mm_and_ps(above, lineReduction), _mm_andnot_ps(above, kneeReduction));
+
+                const __m128 audible = _mm_cmplt_ps(reduction, infinityDB);
+                _mm_storeu_ps(gain + i, _mm_and_ps(audible, exp2(_mm_mul_ps(reduction, negLog2PerDb))));
+                maxReduction = _mm_max_ps(maxReduction, reduction);
+            }
+
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, maxReduction);
+            const float maxReductionDB = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+
+            return processFastScalar(c, envelope + i, gain + i, numSamples - i, maxReductionDB);
+        }
+    }
+
+    //==============================================================================
+   #if defined(__clang__)
+    #pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+   #elif defined(__GNUC__)
+    #pragma GCC push_options
+    #pragma GCC target("avx2,fma")
+   #endif
+
+    namespace avx2
+    {
+        inline __m256 log2(__m256 x)
+        {
+            const __m256i bits = _mm256_castps_si256(x);
+            __m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+            __m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                                  _mm256_set1_epi32(0x3f800000)));
+
+            const __m256 fold = _mm256_cmp_ps(mantissa, _mm256_set1_ps(FastMath::sqrt2), _CMP_GT_OQ);
+            mantissa = _mm256_blendv_ps(mantissa, _mm256_mul_ps(mantissa, _mm256_set1_ps(0.5f)), fold);
+            exponent = _mm256_add_ps(exponent, _mm256_and_ps(fold, _mm256_set1_ps(1.0f)));
+
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 t = _mm256_div_ps(_mm256_sub_ps(mantissa, one), _mm256_add_ps(mantissa, one));
+            const __m256 t2 = _mm256_mul_ps(t, t);
+            __m256 series = _mm256_fmadd_ps(t2, _mm256_set1_ps(1.0f / 7.0f), _mm256_set1_ps(1.0f / 5.0f));
+            series = _mm256_fmadd_ps(t2, series, _mm256_set1_ps(1.0f / 3.0f));
+            series = _mm256_fmadd_ps(t2, series, one);
+
+            return _mm256_fmadd_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f * FastMath::log2e), t), series, exponent);
+        }
+
+        inline __m256 exp2(__m256 x)
+        {
+            x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-126.0f)), _mm256_set1_ps(126.0f));
+
+            const __m256 rounded = _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            const __m256 f = _mm256_mul_ps(_mm256_sub_ps(x, rounded), _mm256_set1_ps(FastMath::ln2));
+
+            __m256 p = _mm256_fmadd_ps(f, _mm256_set1_ps(1.0f / 720.0f), _mm256_set1_ps(1.0f / 120.0f));
+            p = _mm256_fmadd_ps(f, p, _mm256_set1_ps(1.0f / 24.0f));
+            p = _mm256_fmadd_ps(f, p, _mm256_set1_ps(1.0f / 6.0f));
+            p = _mm256_fmadd_ps(f, p, _mm256_set1_ps(1.0f / 2.0f));
+            p = _mm256_fmadd_ps(f, p, _mm256_set1_ps(1.0f));
+            p = _mm256_fmadd_ps(f, p, _mm256_set1_ps(1.0f));
+
+            const __m256i scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(rounded), _mm256_set1_epi32(127)), 23);
+            return _mm256_mul_ps(p, _mm256_castsi256_ps(scale));
+        }
+
+        float process(const GainComputer::Curve& c, const float* envelope, float* gain, int numSamples)
+        {
+            const __m256 floor = _mm256_set1_ps(minusInfinityGain);
+            const __m256 dbPerLog2 = _mm256_set1_ps(FastMath::dbPerLog2);
+            const __m256 negLog2PerDb = _mm256_set1_ps(-FastMath::log2PerDb);
+            const __m256 threshold = _mm256_set1_ps(c.thresholdDB);
+            const __m256 slope = _mm256_set1_ps(c.slope);
+            const __m256 knee = _mm256_set1_ps(c.kneeDB);
+            const __m256 kneeStart = _mm256_set1_ps(c.kneeStartDB);
+            const __m256 kneeEnd = _mm256_set1_ps(c.kneeEndDB);
+            const __m256 kneeScale = _mm256_set1_ps(c.kneeScale);
+            const __m256 infinityDB = _mm256_set1_ps(-minusInfinityDB);
+            const __m256 zero = _mm256_setzero_ps();
+            __m256 maxReduction = zero;
+
+            int i = 0;
+            for (; i + 8 <= numSamples; i += 8)
+            {
+                // The envelope is positive, so the exponent field needs no masking.
+                const __m256 levelDB = _mm256_mul_ps(dbPerLog2, log2(_mm256_max_ps(_mm256_loadu_ps(envelope + i), floor)));
+
+                const __m256 delta = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(levelDB, kneeStart), zero), knee);
+                const __m256 kneeReduction = _mm256_mul_ps(kneeScale, _mm256_mul_ps(delta, delta));
+                const __m256 lineReduction = _mm256_mul_ps(_mm256_sub_ps(levelDB, threshold), slope);
+                const __m256 above = _mm256_cmp_ps(levelDB, kneeEnd, _CMP_GT_OQ);
+                const __m256 reduction = _mm256_blendv_ps(kneeReduction, lineReduction, above);
+
+                const __m256 audible = _mm256_cmp_ps(reduction, infinityDB, _CMP_LT_OQ);
+                _mm256_storeu_ps(gain + i, _mm256_and_ps(audible, exp2(_mm256_mul_ps(reduction, negLog2PerDb))));
+                maxReduction = _mm256_max_ps(maxReduction, reduction);
+            }
+
+            const __m128 halves = _mm_max_ps(_mm256_castps256_ps128(maxReduction), _mm256_extractf128_ps(maxReduction, 1));
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, halves);
+            const float maxReductionDB = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+
+            return processFastScalar(c, envelope + i, gain + i, numSamples - i, maxReductionDB);
+        }
+
+        float processTable(const GainComputer::Table& t, const float* envelope, float* gain, int numSamples)
+        {
+            const __m256 minLevel = _mm256_set1_ps(t.minLevel);
+            const __m256 maxLevel = _mm256_set1_ps(t.maxLevel);
+            const __m256i baseBits = _mm256_set1_epi32(t.baseBits);
+            const __m256i segmentMask = _mm256_set1_epi32(tableSegmentMask);
+            const __m256 segmentScale = _mm256_set1_ps(tableSegmentScale);
+            __m256 minGain = _mm256_set1_ps(1.0f);
+
+            int i = 0;
+            for (; i + 8 <= numSamples; i += 8)
+            {
+                const __m256 level = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(envelope + i), minLevel), maxLevel);
+                const __m256i offset = _mm256_sub_epi32(_mm256_castps_si256(level), baseBits);
+                const __m256i node = _mm256_srli_epi32(offset, GainComputer::Table::segmentBits);
+                const __m256 fraction = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(offset, segmentMask)), segmentScale);
+
+                const __m256 value = _mm256_fmadd_ps(fraction, _mm256_i32gather_ps(t.step.data(), node, 4),
+                                                     _mm256_i32gather_ps(t.gain.data(), node, 4));
+                _mm256_storeu_ps(gain + i, value);
+                minGain = _mm256_min_ps(minGain, value);
+            }
+
+            const __m128 halves = _mm_min_ps(_mm256_castps256_ps128(minGain), _mm256_extractf128_ps(minGain, 1));
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, halves);
+            const float blockMinGain = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+
+            return getTableReductionDB(lookUpTable(t, envelope + i, gain + i, numSamples - i, blockMinGain));
+        }
+    }
+
+   #if defined(__clang__)
+    #pragma clang attribute pop
+   #elif defined(__GNUC__)
+    #pragma GCC pop_options
+   #endif
+
+    //==============================================================================
+    bool cpuHasAvx2()
+    {
+       #if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        __cpuid(info, 1);
+        const bool hasFma = (info[2] & (1 << 12)) != 0;
+        const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+        __cpuidex(info, 7, 0);
+        return hasFma && osSavesYmm && (info[1] & (1 << 5)) != 0;
+       #else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+       #endif
+    }
+#endif
+
+#if GAINCOMPUTER_NEON
+    //==============================================================================
+    namespace neon
+    {
+        using FastMath::neon::log2;
+        using FastMath::neon::exp2;
+
+        float process(const GainComputer::Curve& c, const float* envelope, float* gain, int numSamples)
+        {
+            const float32x4_t floor = vdupq_n_f32(minusInfinityGain);
+            const float32x4_t threshold = vdupq_n_f32(c.thresholdDB);
+            const float32x4_t knee = vdupq_n_f32(c.kneeDB);
+            const float32x4_t kneeStart = vdupq_n_f32(c.kneeStartDB);
+            const float32x4_t kneeEnd = vdupq_n_f32(c.kneeEndDB);
+            const float32x4_t infinityDB = vdupq_n_f32(-minusInfinityDB);
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+            float32x4_t maxReduction = zero;
+
+            int i = 0;
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                const float32x4_t levelDB = vmulq_n_f32(log2(vmaxq_f32(vld1q_f32(envelope + i), floor)), FastMath::dbPerLog2);
+
+                const float32x4_t delta = vminq_f32(vmaxq_f32(vsubq_f32(levelDB, kneeStart), zero), knee);
+                const float32x4_t kneeReduction = vmulq_n_f32(vmulq_f32(delta, delta), c.kneeScale);
+                const float32x4_t lineReduction = vmulq_n_f32(vsubq_f32(levelDB, threshold), c.slope);
+                const float32x4_t reduction = vbslq_f32(vcgtq_f32(levelDB, kneeEnd), lineReduction, kneeReduction);
+
+                const float32x4_t target = exp2(vmulq_n_f32(reduction, -FastMath::log2PerDb));
+                vst1q_f32(gain + i, vbslq_f32(vcltq_f32(reduction, infinityDB), target, zero));
+                maxReduction = vmaxq_f32(maxReduction, reduction);
+            }
+
+            float lanes[4];
+            vst1q_f32(lanes, maxReduction);
+            const float maxReductionDB = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+
+            return processFastScalar(c, envelope + i, gain + i, numSamples - i, maxReductionDB);
+        }
+    }
+#endif
+
+    // The SIMD kernels evaluate both sides of the knee branch-free, so only the
+    // scalar one has a variant per knee.
+    GainComputer::Kernel getKernel(GainComputer::Isa isa, bool softKnee)
+    {
+        switch (isa)
+        {
+           #if GAINCOMPUTER_X86
+            case GainComputer::Isa::sse2:   return sse2::process;
+            case GainComputer::Isa::avx2:   return avx2::process;
+           #endif
+           #if GAINCOMPUTER_NEON
+            case GainComputer::Isa::neon:   return neon::process;
+           #endif
+            default:                        return softKnee ? processScalar<true> : processScalar<false>;
+        }
+    }
+}
+
+//==============================================================================
+GainComputer::GainComputer()
+{
+    builtCurve.slope = -1.0f; // Matches no curve, so the first request is built
+    setIsa(getBestIsa());
+    setParameters(-24.0f, 4.0f, 0.0f);
+}
+
+GainComputer::Isa GainComputer::getBestIsa()
+{
+#if GAINCOMPUTER_X86
+    static const Isa best = cpuHasAvx2() ? Isa::avx2 : Isa::sse2;
+    return best;
+#elif GAINCOMPUTER_NEON
+    return Isa::neon;
+#else
+    return Isa::scalar;
+#endif
+}
+
+const char* GainComputer::getIsaName(Isa isaToName)
+{
+    switch (isaToName)
+    {
+        case Isa::sse2:     return "SSE2";
+        case Isa::avx2:     return "AVX2";
+        case Isa::neon:     return "NEON";
+        case Isa::scalar:
+        default:            return "Scalar";
+    }
+}
+
+void GainComputer::setIsa(Isa newIsa)
+{
+    const auto best = getBestIsa();
+    bool supported = newIsa == Isa::scalar || newIsa == best;
+
+#if GAINCOMPUTER_X86
+    supported = supported || newIsa == Isa::sse2;
+#endif
+
+    isa = supported ? newIsa : best;
+    kernel = getKernel(isa, curve.kneeDB > 0.0f);
+
+#if GAINCOMPUTER_X86
+    tableKernel = isa == Isa::avx2 ? avx2::processTable : processTable;
+#else
+    tableKernel = processTable;
+#endif
+}
+
+void GainComputer::setParameters(float thresholdDB, float ratio, float kneeDB)
+{
+    curve.thresholdDB = thresholdDB;
+    curve.slope = 1.0f - 1.0f / ratio;
+    curve.kneeDB = std::max(kneeDB, 0.0f);
+    curve.kneeStartDB = thresholdDB - curve.kneeDB * 0.5f;
+    curve.kneeEndDB = thresholdDB + curve.kneeDB * 0.5f;
+    curve.kneeScale = curve.kneeDB > 0.0f ? curve.slope / (2.0f * curve.kneeDB) : 0.0f;
+    kernel = getKernel(isa, curve.kneeDB > 0.0f);
+
+    // 0.01 dB of headroom covers the fast log approximation near the knee.
+    onsetLevel = std::pow(10.0f, (curve.kneeStartDB - 0.01f) * 0.05f);
+
+    requestedThresholdDB.store(curve.thresholdDB, std::memory_order_relaxed);
+    requestedSlope.store(curve.slope, std::memory_order_relaxed);
+    requestedKneeDB.store(curve.kneeDB, std::memory_order_relaxed);
+    updateUseTable();
+}
+
+void GainComputer::setPrecision(Precision newPrecision)
+{
+    precision = newPrecision;
+    tableWanted.store(precision == Precision::fast, std::memory_order_relaxed);
+    updateUseTable();
+}
+
+bool GainComputer::buildTable()
+{
+    Curve requested;
+    requested.thresholdDB = requestedThresholdDB.load(std::memory_order_relaxed);
+    requested.slope = requestedSlope.load(std::memory_order_relaxed);
+    requested.kneeDB = requestedKneeDB.load(std::memory_order_relaxed);
+
+    if (!tableWanted.load(std::memory_order_relaxed)
+        || (requested.thresholdDB == builtCurve.thresholdDB && requested.slope == builtCurve.slope
+            && requested.kneeDB == builtCurve.kneeDB))
+        return false;
+
+    auto& t = tables[static_cast<size_t>(builderIndex)];
+    t.thresholdDB = requested.thresholdDB;
+    t.slope = requested.slope;
+    t.kneeDB = requested.kneeDB;
+
+    // Nodes from 2^-18 (below the -100 dB floor, where the curve is flat) up, 64 per octave.
+    // They stay aligned to the octaves: a segment across a power of two would bend.
+    const std::int32_t segment = 1 << Table::segmentBits;
+    t.baseBits = (127 - 18) << 23;
+    t.minLevel = FastMath::bitsToFloat(t.baseBits);
+    t.maxLevel = FastMath::bitsToFloat(t.baseBits + (Table::size - 2) * segment);
+
+    // The scalar kernel's curve, in double precision, at every node.
+    const double kneeStartDB = t.thresholdDB - t.kneeDB * 0.5;
+    const double kneeEndDB = t.thresholdDB + t.kneeDB * 0.5;
+
+    for (int node = 0; node < Table::size - 1; ++node)
+    {
+        const double levelDB = 20.0 * std::log10(static_cast<double>(FastMath::bitsToFloat(t.baseBits + node * segment)));
+        double reductionDB = 0.0;
+
+        if (levelDB > kneeEndDB)
+            reductionDB = (levelDB - t.thresholdDB) * t.slope;
+        else if (t.kneeDB > 0.0f && levelDB >= kneeStartDB)
+            reductionDB = t.slope * (levelDB - kneeStartDB) * (levelDB - kneeStartDB) / (2.0 * t.kneeDB);
+
+        t.gain[static_cast<size_t>(node)] = -reductionDB > minusInfinityDB ? static_cast<float>(std::pow(10.0, -reductionDB * 0.05)) : 0.0f;
+    }
+
+    t.gain[Table::size - 1] = t.gain[Table::size - 2];
+
+    for (int node = 0; node < Table::size - 1; ++node)
+        t.step[static_cast<size_t>(node)] = t.gain[static_cast<size_t>(node + 1)] - t.gain[static_cast<size_t>(node)];
+
+    builtCurve = requested;
+    builderIndex = publishedIndex.exchange(builderIndex | freshTable, std::memory_order_acq_rel) & ~freshTable;
+    return true;
+}
+
+void GainComputer::syncTable()
+{
+    if ((publishedIndex.load(std::memory_order_relaxed) & freshTable) != 0)
+        readerIndex = publishedIndex.exchange(readerIndex, std::memory_order_acq_rel) & ~freshTable;
+
+    updateUseTable();
+}
+
+void GainComputer::updateUseTable()
+{
+    useTable = precision == Precision::fast && tables[static_cast<size_t>(readerIndex)].matches(curve);
+}
+
+float GainComputer::process(const float* envelope, float* gain, int numSamples) const
+{
+    if (useTable)
+        return tableKernel(tables[static_cast<size_t>(readerIndex)], envelope, gain, numSamples);
+
+    return kernel(curve, envelope, gain, numSamples);
+}
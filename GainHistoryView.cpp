@@ -0,0 +1,175 @@
+#include "GainHistoryView.h"
+
+namespace
+{
+    const juce::Colour backgroundColour{ 0xff1c1c1c };
+    const juce::Colour inputColour{ 0xff4a4a4a };
+    const juce::Colour outputColour{ 0xff5f8fbf };
+    const juce::Colour reductionColour{ 0xffd04040 };
+}
+
+GainHistoryView::GainHistoryView()
+{
+    setOpaque(true);
+}
+
+GainHistoryView::~GainHistoryView() {}
+
+void GainHistoryView::resized()
+{
+    plotScale = 0.0f;
+    repaint();
+}
+
+void GainHistoryView::update(HistoryChannel& channel)
+{
+    const bool scrolling = plotScale > 0.0f && plot.isValid();
+    newPixels.clear();
+
+    HistoryColumn columns[64];
+
+    for (int numRead; (numRead = channel.pop(columns, static_cast<int>(std::size(columns)))) > 0;)
+    {
+        for (int i = 0; i < numRead; ++i)
+        {
+            ring[static_cast<size_t>(writeIndex)] = columns[i];
+            writeIndex = writeIndex + 1 == numColumns ? 0 : writeIndex + 1;
+            numStored = juce::jmin(numStored + 1, numColumns);
+
+            if (!scrolling)
+                continue;
+
+            if (pixelStarted)
+                pendingPixel.merge(columns[i]);
+            else
+                pendingPixel = columns[i];
+
+            pixelStarted = true;
+            pixelPhase += 1.0;
+
+            // A pixel may span several columns, or (on a wide plot) a column several pixels.
+            for (; pixelPhase >= columnsPerPixel; pixelPhase -= columnsPerPixel)
+            {
+                newPixels.push_back(pendingPixel);
+                pixelStarted = false;
+            }
+        }
+    }
+
+    if (newPixels.empty())
+        return;
+
+    const int width = plot.getWidth();
+    const int numNew = static_cast<int>(newPixels.size());
+
+    if (numNew >= width)
+    {
+        plotScale = 0.0f;
+    }
+    else
+    {
+        // Scroll what is there and draw only the pixels that just filled up.
+        plot.moveImageSection(0, 0, numNew, 0, width - numNew, plot.getHeight());
+
+        juce::Graphics g(plot);
+        for (int i = 0; i < numNew; ++i)
+            drawPixel(g, width - numNew + i, newPixels[static_cast<size_t>(i)], false);
+    }
+
+    repaint();
+}
+
+void GainHistoryView::renderPlot(float scale)
+{
+    const int imageWidth = juce::jmax(1, juce::roundToInt(getWidth() * scale));
+    const int imageHeight = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+    plot = juce::Image(juce::Image::RGB, imageWidth, imageHeight, false);
+    plotScale = scale;
+
+    columnsPerPixel = static_cast<double>(numColumns) / imageWidth;
+    pixelPhase = 0.0;
+    pixelStarted = false;
+    newPixels.reserve(static_cast<size_t>(imageWidth));
+
+    // Window slot j (0 = oldest of numColumns) is ring[(writeIndex + j) % numColumns]
+    // once it holds a column, i.e. for the newest numStored slots.
+    const int firstStored = numColumns - numStored;
+    juce::Graphics g(plot);
+
+    for (int x = 0; x < imageWidth; ++x)
+    {
+        const int begin = static_cast<int>(x * columnsPerPixel);
+        const int end = juce::jmax(begin + 1, static_cast<int>((x + 1) * columnsPerPixel));
+
+        HistoryColumn pixel;
+        bool empty = true;
+
+        for (int j = juce::jmax(begin, firstStored); j < juce::jmin(end, numColumns); ++j)
+        {
+            const auto& column = ring[static_cast<size_t>((writeIndex + j) % numColumns)];
+
+            if (empty)
+                pixel = column;
+            else
+                pixel.merge(column);
+
+            empty = false;
+        }
+
+        drawPixel(g, x, pixel, empty);
+    }
+}
+
+void GainHistoryView::drawPixel(juce::Graphics& g, int x, const HistoryColumn& column, bool empty) const
+{
+    const int height = plot.getHeight();
+
+    g.setColour(backgroundColour);
+    g.fillRect(x, 0, 1, height);
+
+    if (empty)
+        return;
+
+    // Peaks on a dB scale, mirrored around the centre line; the output over the input.
+    const float centre = height * 0.5f;
+    auto levelToHalfHeight = [centre](float peak)
+        {
+            const float db = juce::Decibels::gainToDecibels(peak, minLevelDB);
+            return centre * (db - minLevelDB) / -minLevelDB;
+        };
+
+    const float inputHalf = levelToHalfHeight(column.inputPeak);
+    const float outputHalf = levelToHalfHeight(column.outputPeak);
+
+    g.setColour(inputColour);
+    g.fillRect(juce::Rectangle<float>(static_cast<float>(x), centre - inputHalf, 1.0f, 2.0f * inputHalf));
+    g.setColour(outputColour);
+    g.fillRect(juce::Rectangle<float>(static_cast<float>(x), centre - outputHalf, 1.0f, 2.0f * outputHalf));
+
+    // Gain reduction from the top edge: a shade down to the largest value, solid over the range.
+    auto reductionToY = [height](float db) { return height * juce::jlimit(0.0f, 1.0f, db / maxReductionDB); };
+    const float minY = reductionToY(column.minReductionDB);
+    const float maxY = reductionToY(column.maxReductionDB);
+
+    if (column.maxReductionDB > 0.0f)
+    {
+        g.setColour(reductionColour.withAlpha(0.25f));
+        g.fillRect(juce::Rectangle<float>(static_cast<float>(x), 0.0f, 1.0f, minY));
+        g.setColour(reductionColour);
+        g.fillRect(juce::Rectangle<float>(static_cast<float>(x), minY, 1.0f, juce::jmax(1.0f, maxY - minY)));
+    }
+}
+
+void GainHistoryView::paint(juce::Graphics& g)
+{
+    // Drawn in full only when the size or display scale changed; otherwise a blit.
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (scale != plotScale || !plot.isValid())
+        renderPlot(scale);
+
+    g.setOpacity(1.0f);
+    g.drawImage(plot, getLocalBounds().toFloat());
+
+    g.setColour(juce::Colours::grey);
+    g.drawRect(getLocalBounds(), 1);
+}
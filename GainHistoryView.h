@@ -0,0 +1,59 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MeterChannel.h"
+
+/**
+    Scrolling history of the last ten seconds: gain reduction hanging from the
+    top edge (its min-max range per pixel) over the input and output peak
+    envelopes mirrored around the centre line.
+
+    The columns the audio thread decimated (HistoryChannel) are kept in a
+    fixed ring, so memory doesn't depend on the history length. The plot is
+    an image at the display's pixel scale that scrolls: update() moves it left
+    by the pixels that filled up since the last tick and draws only those new
+    pixel columns, and paint() just blits it. The ring is only walked again to
+    redraw everything after a resize or a change of display scale.
+*/
+class GainHistoryView : public juce::Component
+{
+public:
+    static constexpr float historySeconds = 10.0f;
+    static constexpr int numColumns = static_cast<int>(historySeconds * 1000.0f / HistoryChannel::columnMs);
+
+    GainHistoryView();
+    ~GainHistoryView() override;
+
+    // Takes every column that arrived since the last UI tick and scrolls the plot.
+    void update(HistoryChannel& channel);
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    static constexpr float maxReductionDB = 24.0f;
+    static constexpr float minLevelDB = -60.0f;
+
+    // The last numColumns columns, oldest at writeIndex once full.
+    std::array<HistoryColumn, numColumns> ring;
+    int writeIndex = 0;
+    int numStored = 0;
+
+    // The plot at physical pixels; plotScale 0 means it has to be drawn in full.
+    juce::Image plot;
+    float plotScale = 0.0f;
+
+    // Columns per image pixel, and the one being collected for the next pixel.
+    double columnsPerPixel = 1.0;
+    double pixelPhase = 0.0;
+    HistoryColumn pendingPixel;
+    bool pixelStarted = false;
+
+    // Pixel columns completed during one update() (sized in resized()).
+    std::vector<HistoryColumn> newPixels;
+
+    void renderPlot(float scale);
+    void drawPixel(juce::Graphics& g, int x, const HistoryColumn& column, bool empty) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GainHistoryView)
+};
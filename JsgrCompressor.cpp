@@ -0,0 +1,428 @@
+#include "JsgrCompressor.h"
+#include "BroadbandCompressor.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+
+struct JsgrCompressor
+{
+    BroadbandCompressor compressor;
+    JsgrParameters parameters{};
+    int numChannels{ 0 };
+    int maxFrames{ 0 };
+    double sampleRate{ 44100.0 };
+
+    // Link groups for the linked modes and for off.
+    ChannelGroups linkedGroups;
+    ChannelGroups independentGroups;
+
+    // Planar float audio of one chunk, [channel * maxFrames + frame].
+    std::vector<float> scratch;
+
+    int rmsWindowSamples{ 1 };       // The detector moves towards it a step per chunk
+    float makeupGain{ 1.0f };        // Target of the next chunk
+    float appliedMakeupGain{ 1.0f }; // Reached at the end of the last one
+    float gainReductionDB{ 0.0f };
+};
+
+namespace
+{
+    constexpr int maxChannels = BroadbandCompressor::maxChannels;
+    constexpr float maxRmsWindowMs = 50.0f;
+
+    //==============================================================================
+    // The sample formats: size in bytes, and conversion to and from float at full scale 1.
+    // memcpy keeps the loads legal for any alignment of the caller's buffers.
+    struct Float32
+    {
+        static constexpr int size = 4;
+
+        static float read(const unsigned char* source)
+        {
+            float sample;
+            std::memcpy(&sample, source, sizeof(sample));
+            return sample;
+        }
+
+        static void write(unsigned char* destination, float sample)
+        {
+            std::memcpy(destination, &sample, sizeof(sample));
+        }
+    };
+
+    struct Int16
+    {
+        static constexpr int size = 2;
+
+        static float read(const unsigned char* source)
+        {
+            int16_t sample;
+            std::memcpy(&sample, source, sizeof(sample));
+            return static_cast<float>(sample) * (1.0f / 32768.0f);
+        }
+
+        static void write(unsigned char* destination, float sample)
+        {
+            const auto value = static_cast<int16_t>(std::lrint(std::min(std::max(sample * 32768.0f, -32768.0f), 32767.0f)));
+            std::memcpy(destination, &value, sizeof(value));
+        }
+    };
+
+    struct Int24
+    {
+        static constexpr int size = 3;
+
+        static float read(const unsigned char* source)
+        {
+            // Sign-extend from bit 23.
+            const int32_t bits = source[0] | (source[1] << 8) | (source[2] << 16);
+            return static_cast<float>((bits ^ 0x800000) - 0x800000) * (1.0f / 8388608.0f);
+        }
+
+        static void write(unsigned char* destination, float sample)
+        {
+            const auto value = static_cast<int32_t>(std::lrint(std::min(std::max(sample * 8388608.0f, -8388608.0f), 8388607.0f)));
+            destination[0] = static_cast<unsigned char>(value);
+            destination[1] = static_cast<unsigned char>(value >> 8);
+            destination[2] = static_cast<unsigned char>(value >> 16);
+        }
+    };
+
+    template <typename Format>
+    void readInterleaved(const void* source, float* const* planes, int numChannels, int offset, int numFrames)
+    {
+        auto* bytes = static_cast<const unsigned char*>(source) + static_cast<size_t>(offset * numChannels * Format::size);
+
+        for (int frame = 0; frame < numFrames; ++frame)
+            for (int channel = 0; channel < numChannels; ++channel, bytes += Format::size)
+                planes[channel][frame] = Format::read(bytes);
+    }
+
+    template <typename Format>
+    void writeInterleaved(const float* const* planes, void* destination, int numChannels, int offset, int numFrames)
+    {
+        auto* bytes = static_cast<unsigned char*>(destination) + static_cast<size_t>(offset * numChannels * Format::size);
+
+        for (int frame = 0; frame < numFrames; ++frame)
+            for (int channel = 0; channel < numChannels; ++channel, bytes += Format::size)
+                Format::write(bytes, planes[channel][frame]);
+    }
+
+    template <typename Format>
+    void readPlanar(const void* const* sources, float* const* planes, int numChannels, int offset, int numFrames)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* bytes = static_cast<const unsigned char*>(sources[channel]) + static_cast<size_t>(offset * Format::size);
+
+            for (int frame = 0; frame < numFrames; ++frame, bytes += Format::size)
+                planes[channel][frame] = Format::read(bytes);
+        }
+    }
+
+    template <typename Format>
+    void writePlanar(const float* const* planes, void* const* destinations, int numChannels, int offset, int numFrames)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* bytes = static_cast<unsigned char*>(destinations[channel]) + static_cast<size_t>(offset * Format::size);
+
+            for (int frame = 0; frame < numFrames; ++frame, bytes += Format::size)
+                Format::write(bytes, planes[channel][frame]);
+        }
+    }
+
+    //==============================================================================
+    // Denormals flushed to zero while processing, as the plugin's ScopedNoDenormals does.
+    class ScopedFlushDenormals
+    {
+    public:
+#if FASTMATH_SSE2
+        ScopedFlushDenormals() : previous(_mm_getcsr()) { _mm_setcsr(previous | 0x8040); } // FTZ | DAZ
+        ~ScopedFlushDenormals() { _mm_setcsr(previous); }
+
+    private:
+        unsigned int previous;
+#elif FASTMATH_NEON && defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+        ScopedFlushDenormals()
+        {
+            asm volatile("mrs %0, fpcr" : "=r"(previous));
+            asm volatile("msr fpcr, %0" : : "r"(previous | (1ull << 24))); // FZ
+        }
+
+        ~ScopedFlushDenormals() { asm volatile("msr fpcr, %0" : : "r"(previous)); }
+
+    private:
+        unsigned long long previous;
+#else
+        ScopedFlushDenormals() {}
+#endif
+
+        ScopedFlushDenormals(const ScopedFlushDenormals&) = delete;
+        ScopedFlushDenormals& operator=(const ScopedFlushDenormals&) = delete;
+    };
+
+    float clamp(float value, float low, float high)
+    {
+        return std::min(std::max(value, low), high);
+    }
+
+    float* getPlane(JsgrCompressor& c, int channel)
+    {
+        return c.scratch.data() + static_cast<size_t>(channel * c.maxFrames);
+    }
+
+    /** Compresses numFrames (at most maxFrames) of every channel of audio in place. */
+    float processChunk(JsgrCompressor& c, float* const* audio, int numFrames)
+    {
+        const auto mode = static_cast<BroadbandCompressor::LinkMode>(c.parameters.linkMode);
+        const auto& groups = mode == BroadbandCompressor::LinkMode::off ? c.independentGroups : c.linkedGroups;
+        const float makeupStart = c.appliedMakeupGain;
+        const float makeupEnd = c.makeupGain;
+        const auto kernel = BroadbandCompressor::getGroupKernel(mode, CompressorKernels::getMakeup(makeupStart, makeupEnd));
+
+        c.compressor.setDetector(static_cast<LevelDetector::Mode>(c.parameters.detectorMode), c.rmsWindowSamples);
+
+        // The detector is the audio itself: every pass reads a chunk's level before it writes the gain.
+        float maxReductionDB = 0.0f;
+
+        for (int group = 0; group < groups.numGroups; ++group)
+            maxReductionDB = std::max(maxReductionDB,
+                (c.compressor.*kernel)(audio, audio, groups, group, numFrames, c.parameters.link, makeupStart, makeupEnd));
+
+        c.appliedMakeupGain = makeupEnd;
+        return maxReductionDB;
+    }
+
+    template <typename Format>
+    void processInterleaved(JsgrCompressor& c, const void* input, void* output, int numFrames)
+    {
+        float* planes[maxChannels];
+        for (int channel = 0; channel < c.numChannels; ++channel)
+            planes[channel] = getPlane(c, channel);
+
+        for (int start = 0; start < numFrames; start += c.maxFrames)
+        {
+            const int chunk = std::min(c.maxFrames, numFrames - start);
+            readInterleaved<Format>(input, planes, c.numChannels, start, chunk);
+            c.gainReductionDB = std::max(c.gainReductionDB, processChunk(c, planes, chunk));
+            writeInterleaved<Format>(planes, output, c.numChannels, start, chunk);
+        }
+    }
+
+    template <typename Format>
+    void processPlanar(JsgrCompressor& c, const void* const* input, void* const* output, int numFrames)
+    {
+        float* planes[maxChannels];
+        for (int channel = 0; channel < c.numChannels; ++channel)
+            planes[channel] = getPlane(c, channel);
+
+        for (int start = 0; start < numFrames; start += c.maxFrames)
+        {
+            const int chunk = std::min(c.maxFrames, numFrames - start);
+            readPlanar<Format>(input, planes, c.numChannels, start, chunk);
+            c.gainReductionDB = std::max(c.gainReductionDB, processChunk(c, planes, chunk));
+            writePlanar<Format>(planes, output, c.numChannels, start, chunk);
+        }
+    }
+
+    /** Float planes need no conversion: the output is compressed where it lies. */
+    void processPlanarFloat(JsgrCompressor& c, const void* const* input, void* const* output, int numFrames)
+    {
+        for (int channel = 0; channel < c.numChannels; ++channel)
+            if (output[channel] != input[channel])
+                std::memmove(output[channel], input[channel], static_cast<size_t>(numFrames) * sizeof(float));
+
+        float* planes[maxChannels];
+
+        for (int start = 0; start < numFrames; start += c.maxFrames)
+        {
+            const int chunk = std::min(c.maxFrames, numFrames - start);
+
+            for (int channel = 0; channel < c.numChannels; ++channel)
+                planes[channel] = static_cast<float*>(output[channel]) + start;
+
+            c.gainReductionDB = std::max(c.gainReductionDB, processChunk(c, planes, chunk));
+        }
+    }
+}
+
+//==============================================================================
+void jsgr_get_default_parameters(JsgrParameters* parameters)
+{
+    if (parameters == nullptr)
+        return;
+
+    parameters->thresholdDB = -24.0f;
+    parameters->ratio = 4.0f;
+    parameters->kneeDB = 0.0f;
+    parameters->attackMs = 10.0f;
+    parameters->releaseMs = 100.0f;
+    parameters->makeupDB = 0.0f;
+    parameters->linkMode = JSGR_LINK_OFF;
+    parameters->link = 1.0f;
+    parameters->detectorMode = JSGR_DETECTOR_PEAK;
+    parameters->rmsWindowMs = 10.0f;
+    parameters->controlRateGain = 0;
+}
+
+JsgrCompressor* jsgr_create(int numChannels, double sampleRate, int maxFrames)
+{
+    if (numChannels < 1 || numChannels > maxChannels || !(sampleRate > 0.0) || maxFrames < 1)
+        return nullptr;
+
+    auto* c = new (std::nothrow) JsgrCompressor();
+    if (c == nullptr)
+        return nullptr;
+
+    try
+    {
+        c->numChannels = numChannels;
+        c->maxFrames = maxFrames;
+        c->sampleRate = sampleRate;
+        c->linkedGroups = ChannelGroups::wholeBus(numChannels);
+        c->independentGroups = ChannelGroups::independent(numChannels);
+        c->scratch.assign(static_cast<size_t>(numChannels) * static_cast<size_t>(maxFrames), 0.0f);
+
+        const int maxRmsWindow = static_cast<int>(std::ceil(maxRmsWindowMs * 0.001 * sampleRate));
+        c->compressor.prepare(numChannels, maxFrames, maxRmsWindow);
+        c->compressor.setSampleRate(sampleRate);
+    }
+    catch (const std::bad_alloc&)
+    {
+        delete c;
+        return nullptr;
+    }
+
+    JsgrParameters defaults;
+    jsgr_get_default_parameters(&defaults);
+    jsgr_set_parameters(c, &defaults);
+    jsgr_reset(c);
+    return c;
+}
+
+void jsgr_destroy(JsgrCompressor* compressor)
+{
+    delete compressor;
+}
+
+int jsgr_get_num_channels(const JsgrCompressor* compressor)
+{
+    return compressor != nullptr ? compressor->numChannels : 0;
+}
+
+int jsgr_max_frames(const JsgrCompressor* compressor)
+{
+    return compressor != nullptr ? compressor->maxFrames : 0;
+}
+
+int jsgr_set_parameters(JsgrCompressor* compressor, const JsgrParameters* parameters)
+{
+    if (compressor == nullptr || parameters == nullptr)
+        return JSGR_ERROR_INVALID_ARGUMENT;
+
+    const auto& p = *parameters;
+
+    for (float value : { p.thresholdDB, p.ratio, p.kneeDB, p.attackMs, p.releaseMs, p.makeupDB, p.link, p.rmsWindowMs })
+        if (!std::isfinite(value))
+            return JSGR_ERROR_INVALID_ARGUMENT;
+
+    if (p.linkMode < JSGR_LINK_OFF || p.linkMode > JSGR_LINK_AVERAGE
+        || p.detectorMode < JSGR_DETECTOR_PEAK || p.detectorMode > JSGR_DETECTOR_PROGRAM)
+        return JSGR_ERROR_INVALID_ARGUMENT;
+
+    // The plugin parameters' ranges.
+    auto& stored = compressor->parameters;
+    stored.thresholdDB = clamp(p.thresholdDB, -60.0f, 0.0f);
+    stored.ratio = clamp(p.ratio, 1.0f, 20.0f);
+    stored.kneeDB = clamp(p.kneeDB, 0.0f, 24.0f);
+    stored.attackMs = clamp(p.attackMs, 1.0f, 100.0f);
+    stored.releaseMs = clamp(p.releaseMs, 10.0f, 500.0f);
+    stored.makeupDB = clamp(p.makeupDB, 0.0f, 24.0f);
+    stored.linkMode = p.linkMode;
+    stored.link = clamp(p.link, 0.0f, 1.0f);
+    stored.detectorMode = p.detectorMode;
+    stored.rmsWindowMs = clamp(p.rmsWindowMs, 1.0f, maxRmsWindowMs);
+    stored.controlRateGain = p.controlRateGain != 0 ? 1 : 0;
+
+    auto& c = compressor->compressor;
+    c.setCurve(stored.thresholdDB, stored.ratio, stored.kneeDB);
+    c.setTimes(stored.attackMs, stored.releaseMs);
+    c.setControlRateGain(stored.controlRateGain != 0);
+    compressor->rmsWindowSamples = static_cast<int>(std::lround(stored.rmsWindowMs * 0.001 * compressor->sampleRate));
+    c.setDetector(static_cast<LevelDetector::Mode>(stored.detectorMode), compressor->rmsWindowSamples);
+    compressor->makeupGain = std::pow(10.0f, stored.makeupDB * 0.05f);
+    return JSGR_OK;
+}
+
+void jsgr_get_parameters(const JsgrCompressor* compressor, JsgrParameters* parameters)
+{
+    if (compressor != nullptr && parameters != nullptr)
+        *parameters = compressor->parameters;
+}
+
+void jsgr_reset(JsgrCompressor* compressor)
+{
+    if (compressor == nullptr)
+        return;
+
+    compressor->compressor.reset();
+    compressor->appliedMakeupGain = compressor->makeupGain;
+    compressor->gainReductionDB = 0.0f;
+}
+
+int jsgr_process_interleaved(JsgrCompressor* compressor, const void* input, void* output, int numFrames,
+                             JsgrSampleFormat format)
+{
+    if (compressor == nullptr || input == nullptr || output == nullptr || numFrames < 0)
+        return JSGR_ERROR_INVALID_ARGUMENT;
+
+    const ScopedFlushDenormals flushDenormals;
+    auto& c = *compressor;
+    c.gainReductionDB = 0.0f;
+
+    switch (format)
+    {
+        case JSGR_FORMAT_FLOAT32: processInterleaved<Float32>(c, input, output, numFrames); break;
+        case JSGR_FORMAT_INT16:   processInterleaved<Int16>(c, input, output, numFrames); break;
+        case JSGR_FORMAT_INT24:   processInterleaved<Int24>(c, input, output, numFrames); break;
+        default:                  return JSGR_ERROR_INVALID_ARGUMENT;
+    }
+
+    return JSGR_OK;
+}
+
+int jsgr_process_planar(JsgrCompressor* compressor, const void* const* input, void* const* output, int numFrames,
+                        JsgrSampleFormat format)
+{
+    if (compressor == nullptr || input == nullptr || output == nullptr || numFrames < 0)
+        return JSGR_ERROR_INVALID_ARGUMENT;
+
+    for (int channel = 0; channel < compressor->numChannels; ++channel)
+        if (input[channel] == nullptr || output[channel] == nullptr)
+            return JSGR_ERROR_INVALID_ARGUMENT;
+
+    const ScopedFlushDenormals flushDenormals;
+    auto& c = *compressor;
+    c.gainReductionDB = 0.0f;
+
+    switch (format)
+    {
+        case JSGR_FORMAT_FLOAT32: processPlanarFloat(c, input, output, numFrames); break;
+        case JSGR_FORMAT_INT16:   processPlanar<Int16>(c, input, output, numFrames); break;
+        case JSGR_FORMAT_INT24:   processPlanar<Int24>(c, input, output, numFrames); break;
+        default:                  return JSGR_ERROR_INVALID_ARGUMENT;
+    }
+
+    return JSGR_OK;
+}
+
+float jsgr_get_gain_reduction_db(const JsgrCompressor* compressor)
+{
+    return compressor != nullptr ? compressor->gainReductionDB : 0.0f;
+}
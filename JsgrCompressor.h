@@ -0,0 +1,104 @@
+#pragma once
+
+/*
+    C API of the compressor core: the plugin's broadband compressor (detector, static
+    curve, gain smoothing, makeup and channel linking) on caller-owned audio, for hosts
+    and services that don't use JUCE. Usable from C and C++.
+
+    Audio is interleaved (one buffer, frame after frame) or planar (one buffer per
+    channel), in one of the sample formats below, processed in place (output == input)
+    or from one buffer into another. Planar float32 is processed directly in the output
+    buffers; every other layout and format is converted through the compressor's own
+    scratch. Everything is allocated by jsgr_create(): processing never allocates, locks
+    or makes system calls, so it may run on a realtime thread.
+
+    A compressor is used by one thread at a time: jsgr_set_parameters() goes between
+    jsgr_process_*() calls, and takes effect at the next one (a makeup change ramps over
+    the first chunk of up to maxFrames frames; the gain smoothing covers the other steps).
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct JsgrCompressor JsgrCompressor;
+
+typedef enum JsgrSampleFormat
+{
+    JSGR_FORMAT_FLOAT32 = 0, /* Native-endian float, full scale at +-1 (not clipped) */
+    JSGR_FORMAT_INT16 = 1,   /* Native-endian signed 16-bit, saturated on output */
+    JSGR_FORMAT_INT24 = 2    /* Packed 3-byte little-endian signed 24-bit, saturated on output */
+} JsgrSampleFormat;
+
+typedef enum JsgrLinkMode
+{
+    JSGR_LINK_OFF = 0,     /* Every channel compressed on its own */
+    JSGR_LINK_MAX = 1,     /* The loudest channel drives all of them */
+    JSGR_LINK_AVERAGE = 2  /* The mean of the channels drives all of them */
+} JsgrLinkMode;
+
+typedef enum JsgrDetectorMode
+{
+    JSGR_DETECTOR_PEAK = 0,
+    JSGR_DETECTOR_RMS = 1,
+    JSGR_DETECTOR_TRUE_PEAK = 2,
+    JSGR_DETECTOR_PROGRAM = 3 /* Peak with a program-dependent release */
+} JsgrDetectorMode;
+
+enum
+{
+    JSGR_OK = 0,
+    JSGR_ERROR_INVALID_ARGUMENT = -1
+};
+
+/* Values outside the plugin's ranges are clamped to them (shown as min .. max). */
+typedef struct JsgrParameters
+{
+    float thresholdDB;   /* -60 .. 0, default -24 */
+    float ratio;         /* 1 .. 20, default 4 */
+    float kneeDB;        /* 0 .. 24, default 0 (hard knee) */
+    float attackMs;      /* 1 .. 100, default 10 */
+    float releaseMs;     /* 10 .. 500, default 100 */
+    float makeupDB;      /* 0 .. 24, default 0 */
+    int linkMode;        /* JsgrLinkMode, default JSGR_LINK_OFF */
+    float link;          /* 0 .. 1: how far each channel moves towards the linked level, default 1 */
+    int detectorMode;    /* JsgrDetectorMode, default JSGR_DETECTOR_PEAK */
+    float rmsWindowMs;   /* 1 .. 50, default 10 */
+    int controlRateGain; /* Non-zero: curve and smoothing every 8-32 samples, default 0 */
+} JsgrParameters;
+
+/* Fills parameters with the plugin's defaults. */
+void jsgr_get_default_parameters(JsgrParameters* parameters);
+
+/* A compressor for 1 .. 16 channels with the default parameters, processing up to maxFrames
+   frames at a time internally (longer calls are split). Returns NULL if an argument is out
+   of range or memory runs out. Not realtime safe. */
+JsgrCompressor* jsgr_create(int numChannels, double sampleRate, int maxFrames);
+void jsgr_destroy(JsgrCompressor* compressor);
+
+int jsgr_get_num_channels(const JsgrCompressor* compressor);
+int jsgr_max_frames(const JsgrCompressor* compressor);
+
+/* Returns JSGR_OK, or JSGR_ERROR_INVALID_ARGUMENT (nothing changed) for NULL pointers,
+   unknown modes or values that aren't numbers. */
+int jsgr_set_parameters(JsgrCompressor* compressor, const JsgrParameters* parameters);
+void jsgr_get_parameters(const JsgrCompressor* compressor, JsgrParameters* parameters);
+
+/* Back to silence: envelopes and gains restart, the makeup jumps to its target. */
+void jsgr_reset(JsgrCompressor* compressor);
+
+/* numFrames frames of numChannels samples each, input[frame * numChannels + channel].
+   output may be input. */
+int jsgr_process_interleaved(JsgrCompressor* compressor, const void* input, void* output, int numFrames,
+                             JsgrSampleFormat format);
+
+/* One buffer of numFrames samples per channel. output[channel] may be input[channel]. */
+int jsgr_process_planar(JsgrCompressor* compressor, const void* const* input, void* const* output, int numFrames,
+                        JsgrSampleFormat format);
+
+/* The largest gain reduction of the last jsgr_process_*() call, in dB (>= 0). */
+float jsgr_get_gain_reduction_db(const JsgrCompressor* compressor);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,72 @@
+#include "KeyFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+void KeyFilter::setParameters(Mode newMode, float newFrequency, double newSampleRate)
+{
+    if (newMode == mode && newFrequency == frequency && newSampleRate == sampleRate)
+        return;
+
+    mode = newMode;
+    frequency = newFrequency;
+    sampleRate = newSampleRate;
+    updateCoefficients();
+}
+
+void KeyFilter::reset()
+{
+    s1.fill(0.0f);
+    s2.fill(0.0f);
+}
+
+void KeyFilter::updateCoefficients()
+{
+    if (mode == Mode::off || sampleRate <= 0.0)
+        return;
+
+    const double pi = 3.14159265358979323846;
+    const double f = std::min(static_cast<double>(frequency), sampleRate * 0.49);
+    const double w0 = 2.0 * pi * f / sampleRate;
+    const double cosW0 = std::cos(w0);
+    const double q = mode == Mode::highPass ? 0.70710678118654752 : 1.0;
+    const double alpha = std::sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+
+    if (mode == Mode::highPass)
+    {
+        b0 = static_cast<float>((1.0 + cosW0) * 0.5 / a0);
+        b1 = static_cast<float>(-(1.0 + cosW0) / a0);
+        b2 = b0;
+    }
+    else
+    {
+        b0 = static_cast<float>(alpha / a0);
+        b1 = 0.0f;
+        b2 = -b0;
+    }
+
+    a1 = static_cast<float>(-2.0 * cosW0 / a0);
+    a2 = static_cast<float>((1.0 - alpha) / a0);
+}
+
+void KeyFilter::process(float* const* channels, int numChannels, int numSamples)
+{
+    if (mode == Mode::off)
+        return;
+
+    numChannels = std::min(numChannels, maxChannels);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // Same coefficients on every lane: y = b0 x + s1, s1 = b1 x - a1 y + s2, s2 = b2 x - a2 y.
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float x = channels[ch][i];
+            const float y = b0 * x + s1[ch];
+            s1[ch] = b1 * x - a1 * y + s2[ch];
+            s2[ch] = b2 * x - a2 * y;
+            channels[ch][i] = y;
+        }
+    }
+}
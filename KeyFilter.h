@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+
+//==============================================================================
+/**
+    Key (sidechain) filter for the detector: a single biquad in transposed
+    direct form II, run in place over the detector signal.
+
+    All channels share one coefficient set and keep their state side by side,
+    so the per-sample update runs across channels as lanes. Coefficients (RBJ
+    cookbook) are only recomputed when the mode, frequency or sample rate change.
+*/
+class KeyFilter
+{
+public:
+    enum class Mode
+    {
+        off,
+        highPass, // Q = 0.707, removes low end from the detector
+        bandPass  // Q = 1, 0 dB at the centre frequency
+    };
+
+    static constexpr int maxChannels = 16;
+
+    void setParameters(Mode newMode, float newFrequency, double newSampleRate);
+    Mode getMode() const { return mode; }
+
+    void reset();
+
+    /** Filters numChannels detector channels in place. */
+    void process(float* const* channels, int numChannels, int numSamples);
+
+private:
+    Mode mode{ Mode::off };
+    float frequency{ 0.0f };
+    double sampleRate{ 0.0 };
+
+    // Normalised coefficients (a0 == 1).
+    float b0{ 1.0f }, b1{ 0.0f }, b2{ 0.0f }, a1{ 0.0f }, a2{ 0.0f };
+
+    std::array<float, maxChannels> s1{};
+    std::array<float, maxChannels> s2{};
+
+    void updateCoefficients();
+};
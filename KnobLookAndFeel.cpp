@@ -1,6 +1,19 @@
 #include "KnobLookAndFeel.h"
 #include <cmath>
 
+bool KnobLookAndFeel::LayerKey::operator==(const LayerKey& other) const
+{
+    return width == other.width && height == other.height && scale == other.scale
+        && startAngle == other.startAngle && endAngle == other.endAngle
+        && tickValues == other.tickValues && smallRange == other.smallRange;
+}
+
+void KnobLookAndFeel::setStaticLayerCaching(bool shouldCache)
+{
+    cacheStaticLayers = shouldCache;
+    layerCache.clear();
+}
+
 void KnobLookAndFeel::drawRotarySlider(juce::Graphics& g,
     int x, int y, int width, int height,
     float sliderPosProportional,
@@ -17,18 +30,27 @@ void KnobLookAndFeel::drawRotarySlider(juce::Graphics& g,
     const float angleRange = rotaryEndAngle - rotaryStartAngle;
     const float angle = rotaryStartAngle + sliderPosProportional * angleRange;
 
-    // --- (1) Draw the outer ring for style ---
-    juce::ColourGradient ringGradient(juce::Colours::lightgrey, centre.x, centre.y,
-        juce::Colours::darkgrey, centre.x, centre.y, true);
-    ringGradient.addColour(0.5, juce::Colours::grey);
-    g.setGradientFill(ringGradient);
+    // Tick values follow the slider's skew, so log-scaled knobs (e.g. KeyFilterFreq) get true labels.
+    LayerKey key;
+    key.width = width;
+    key.height = height;
+    key.scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    key.startAngle = rotaryStartAngle;
+    key.endAngle = rotaryEndAngle;
+    key.smallRange = std::abs(slider.getRange().getLength()) < 10.0;
+    for (int i = 0; i < numTicks; ++i)
+        key.tickValues[(size_t)i] = slider.proportionOfLengthToValue((double)i / (double)(numTicks - 1));
 
-    const float ringRadius = radius + 5.0f;
-    g.fillEllipse(centre.x - ringRadius, centre.y - ringRadius, ringRadius * 2.0f, ringRadius * 2.0f);
+    const Layers* layers = cacheStaticLayers ? &getLayers(key, radius) : nullptr;
 
-    // --- (2) Subtle inner circle ---
-    g.setColour(juce::Colours::black.withAlpha(0.2f));
-    g.fillEllipse(centre.x - radius, centre.y - radius, radius * 2.0f, radius * 2.0f);
+    // --- (1)-(2) Outer ring, inner circle and centre dot ---
+    if (layers != nullptr)
+    {
+        g.setOpacity(1.0f);
+        g.drawImage(layers->background, bounds);
+    }
+    else
+        drawBackground(g, centre, radius);
 
     // --- (3) Draw the main value arc ---
     const float arcThickness = 6.0f;
@@ -61,14 +83,10 @@ void KnobLookAndFeel::drawRotarySlider(juce::Graphics& g,
         indicatorRadius * 2.0f,
         indicatorRadius * 2.0f);
 
-    // --- (5) Centre circle (small black dot) ---
-    g.setColour(juce::Colours::black);
-    g.fillEllipse(centre.x - 3.0f, centre.y - 3.0f, 6.0f, 6.0f);
-
-    // --- (6) Knobs current value in the centre ---
+    // --- (5) Knobs current value in the centre ---
     const double currentValue = slider.getValue();
     juce::String valueText;
-    if (std::abs(slider.getRange().getLength()) < 10.0)
+    if (key.smallRange)
         valueText = juce::String(currentValue, 2);
     else
         valueText = juce::String((int)currentValue);
@@ -79,19 +97,80 @@ void KnobLookAndFeel::drawRotarySlider(juce::Graphics& g,
     juce::Rectangle<float> textRect(centre.x - 20.0f, centre.y - 10.0f, 40.0f, 20.0f);
     g.drawFittedText(valueText, textRect.toNearestInt(), juce::Justification::centred, 1);
 
-    // --- (7) Tick Marks around the knob ---
-    drawTickMarks(g, centre.x, centre.y, radius, rotaryStartAngle, angleRange, slider);
+    // --- (6) Tick Marks around the knob ---
+    if (layers != nullptr)
+    {
+        g.setOpacity(1.0f);
+        g.drawImage(layers->overlay, bounds);
+    }
+    else
+        drawTickMarks(g, centre.x, centre.y, radius, rotaryStartAngle, angleRange, key.tickValues, key.smallRange);
+}
+
+const KnobLookAndFeel::Layers& KnobLookAndFeel::getLayers(const LayerKey& key, float radius)
+{
+    for (const auto& layers : layerCache)
+        if (layers.key == key)
+            return layers;
+
+    // Knobs come and go with resizes; keep the cache from growing without bound.
+    if (layerCache.size() >= maxCachedLayers)
+        layerCache.erase(layerCache.begin());
+
+    // Render at physical resolution so the blit stays sharp on high-DPI displays.
+    const int imageWidth = juce::jmax(1, juce::roundToInt(key.width * key.scale));
+    const int imageHeight = juce::jmax(1, juce::roundToInt(key.height * key.scale));
+    const auto centre = juce::Point<float>(key.width * 0.5f, key.height * 0.5f);
+    const auto transform = juce::AffineTransform::scale(key.scale);
+
+    Layers layers;
+    layers.key = key;
+    layers.background = juce::Image(juce::Image::ARGB, imageWidth, imageHeight, true);
+    layers.overlay = juce::Image(juce::Image::ARGB, imageWidth, imageHeight, true);
+
+    {
+        juce::Graphics backgroundGraphics(layers.background);
+        backgroundGraphics.addTransform(transform);
+        drawBackground(backgroundGraphics, centre, radius);
+    }
+
+    {
+        juce::Graphics overlayGraphics(layers.overlay);
+        overlayGraphics.addTransform(transform);
+        drawTickMarks(overlayGraphics, centre.x, centre.y, radius, key.startAngle,
+                      key.endAngle - key.startAngle, key.tickValues, key.smallRange);
+    }
+
+    layerCache.push_back(std::move(layers));
+    return layerCache.back();
+}
+
+void KnobLookAndFeel::drawBackground(juce::Graphics& g, juce::Point<float> centre, float radius)
+{
+    // --- (1) Draw the outer ring for style ---
+    juce::ColourGradient ringGradient(juce::Colours::lightgrey, centre.x, centre.y,
+        juce::Colours::darkgrey, centre.x, centre.y, true);
+    ringGradient.addColour(0.5, juce::Colours::grey);
+    g.setGradientFill(ringGradient);
+
+    const float ringRadius = radius + 5.0f;
+    g.fillEllipse(centre.x - ringRadius, centre.y - ringRadius, ringRadius * 2.0f, ringRadius * 2.0f);
+
+    // --- (2) Subtle inner circle ---
+    g.setColour(juce::Colours::black.withAlpha(0.2f));
+    g.fillEllipse(centre.x - radius, centre.y - radius, radius * 2.0f, radius * 2.0f);
+
+    // Centre circle (small black dot); the arc and indicator never reach it.
+    g.setColour(juce::Colours::black);
+    g.fillEllipse(centre.x - 3.0f, centre.y - 3.0f, 6.0f, 6.0f);
 }
 
 
 void KnobLookAndFeel::drawTickMarks(juce::Graphics& g,
     float centreX, float centreY, float radius,
     float startAngle, float angleRange,
-    juce::Slider& slider)
+    const std::array<double, numTicks>& tickValues, bool smallRange)
 {
-    // Example: 7 tick marks
-    const int numTicks = 7;
-
     for (int i = 0; i < numTicks; ++i)
     {
         float fraction = (float)i / (float)(numTicks - 1);
@@ -112,11 +191,11 @@ void KnobLookAndFeel::drawTickMarks(juce::Graphics& g,
         float labelX = centreX + labelRadius * std::cos(thisAngle);
         float labelY = centreY + labelRadius * std::sin(thisAngle);
 
-        double tickValue = slider.getRange().getStart() + fraction * slider.getRange().getLength();
+        double tickValue = tickValues[(size_t)i];
 
         // Format label
         juce::String labelText;
-        if (std::abs(slider.getRange().getLength()) < 10.0)
+        if (smallRange)
             labelText = juce::String(tickValue, 2);
         else
             labelText = juce::String((int)tickValue);
@@ -2,6 +2,15 @@
 
 #include <JuceHeader.h>
 
+/**
+    Rotary knob look: gradient ring, orange value arc with a white indicator,
+    the value in the centre and labelled tick marks around the edge.
+
+    Everything that doesn't move with the value (ring, inner circle, centre
+    dot, ticks and their labels) is rendered once into two images per knob
+    size, display scale and tick labelling, and blitted on later repaints; only
+    the arc, the indicator and the value text are drawn each time.
+*/
 class KnobLookAndFeel : public juce::LookAndFeel_V4
 {
 public:
@@ -12,9 +21,42 @@ public:
         float rotaryEndAngle,
         juce::Slider& slider) override;
 
+    // Turns the static-layer cache off to draw every layer directly (for timing comparisons).
+    void setStaticLayerCaching(bool shouldCache);
+
 private:
+    static constexpr int numTicks = 7;
+
+    // Everything the static layers depend on.
+    struct LayerKey
+    {
+        int width{ 0 }, height{ 0 };
+        float scale{ 1.0f };
+        float startAngle{ 0.0f }, endAngle{ 0.0f };
+        std::array<double, numTicks> tickValues{};
+        bool smallRange{ false };
+
+        bool operator==(const LayerKey& other) const;
+    };
+
+    struct Layers
+    {
+        LayerKey key;
+        juce::Image background; // Ring, inner circle, centre dot: below the arc
+        juce::Image overlay;    // Ticks and labels: above the arc and value text
+    };
+
+    std::vector<Layers> layerCache;
+    bool cacheStaticLayers{ true };
+
+    static constexpr size_t maxCachedLayers = 32;
+
+    const Layers& getLayers(const LayerKey& key, float radius);
+
+    void drawBackground(juce::Graphics& g, juce::Point<float> centre, float radius);
+
     void drawTickMarks(juce::Graphics& g,
         float centreX, float centreY, float radius,
         float startAngle, float angleRange,
-        juce::Slider& slider);
+        const std::array<double, numTicks>& tickValues, bool smallRange);
 };
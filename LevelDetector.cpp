@@ -0,0 +1,443 @@
+#include "LevelDetector.h"
+#include "CompressorKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // ITU-R BS.1770-4 Annex 2: the 4x true-peak interpolator, one row per tap, one column per phase.
+    constexpr float truePeakCoefficients[12][4] = {
+        {  0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f },
+        {  0.0109863281250f,  0.0292968750000f,  0.0330810546875f,  0.0148925781250f },
+        { -0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f },
+        {  0.0332031250000f,  0.0891113281250f,  0.1015625000000f,  0.0476074218750f },
+        { -0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f },
+        {  0.1373291015625f,  0.4650878906250f,  0.7797851562500f,  0.9721679687500f },
+        {  0.9721679687500f,  0.7797851562500f,  0.4650878906250f,  0.1373291015625f },
+        { -0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f },
+        {  0.0476074218750f,  0.1015625000000f,  0.0891113281250f,  0.0332031250000f },
+        { -0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f },
+        {  0.0148925781250f,  0.0330810546875f,  0.0292968750000f,  0.0109863281250f },
+        { -0.0083007812500f, -0.0189208984375f, -0.0291748046875f,  0.0017089843750f }
+    };
+
+    // Transients release this many times faster than sustained material.
+    constexpr int programReleaseSpeedup = 4;
+
+    inline int wrap(int index, int size)
+    {
+        return index < 0 ? index + size : (index >= size ? index - size : index);
+    }
+}
+
+//==============================================================================
+void LevelDetector::prepare(int numChannels, int maxRmsWindowSamples)
+{
+    numChannels = std::max(numChannels, 0);
+    rmsRingSize = std::max(maxRmsWindowSamples, 1);
+    rmsWindowTarget = std::min(rmsWindowTarget, rmsRingSize);
+
+    squares.resize(static_cast<size_t>(numChannels) * static_cast<size_t>(rmsRingSize));
+    truePeakHistory.resize(static_cast<size_t>(numChannels * 2 * truePeakTaps));
+    channels.resize(static_cast<size_t>(numChannels));
+    reset();
+}
+
+void LevelDetector::reset()
+{
+    std::fill(squares.begin(), squares.end(), 0.0f);
+    std::fill(truePeakHistory.begin(), truePeakHistory.end(), 0.0f);
+    std::fill(channels.begin(), channels.end(), ChannelState{});
+
+    // A reset ring holds silence, which counts as history; the window can jump straight
+    // to its length.
+    for (auto& state : channels)
+        state.rmsCount = rmsRingSize;
+
+    rmsWindow = rmsWindowTarget;
+}
+
+void LevelDetector::setMode(Mode newMode)
+{
+    if (newMode == mode)
+        return;
+
+    // The follower keeps the level the curve saw last (the larger stage when leaving the
+    // program-dependent release, both stages when entering it). The RMS ring is marked
+    // empty rather than cleared, and the true-peak history is only 2 * taps per channel.
+    for (auto& state : channels)
+    {
+        state.envelope = std::max(state.envelope, state.slowEnvelope);
+        state.slowEnvelope = newMode == Mode::programDependent ? state.envelope : 0.0f;
+        state.sumOfSquares = 0.0;
+        state.rmsCount = 0;
+    }
+
+    if (newMode == Mode::truePeak)
+        std::fill(truePeakHistory.begin(), truePeakHistory.end(), 0.0f);
+
+    mode = newMode;
+}
+
+void LevelDetector::setRmsWindow(int numSamples)
+{
+    rmsWindowTarget = std::min(std::max(numSamples, 1), rmsRingSize);
+    if (rmsWindowTarget == rmsWindow)
+        return;
+
+    numSamples = rmsWindowTarget > rmsWindow ? std::min(rmsWindowTarget, rmsWindow + maxRmsWindowStep)
+                                             : std::max(rmsWindowTarget, rmsWindow - maxRmsWindowStep);
+
+    // The ring holds the last rmsCount squares: add the ones a longer window takes in,
+    // or take out the ones a shorter window lets go.
+    const int first = std::min(rmsWindow, numSamples) + 1;
+    const int last = std::max(rmsWindow, numSamples);
+    const double sign = numSamples > rmsWindow ? 1.0 : -1.0;
+
+    for (size_t ch = 0; ch < channels.size(); ++ch)
+    {
+        auto& state = channels[ch];
+        const float* ring = squares.data() + ch * static_cast<size_t>(rmsRingSize);
+        const int newest = std::min(last, state.rmsCount);
+        double delta = 0.0;
+
+        for (int age = first; age <= newest; ++age)
+            delta += ring[wrap(state.rmsPosition - age, rmsRingSize)];
+
+        state.sumOfSquares = std::max(state.sumOfSquares + sign * delta, 0.0);
+    }
+
+    rmsWindow = numSamples;
+}
+
+void LevelDetector::process(int channel, const float* detector, float* envelope, int numSamples,
+                            float attackCoeff, float releaseCoeff)
+{
+    auto& state = channels[static_cast<size_t>(channel)];
+
+    switch (mode)
+    {
+        case Mode::peak:
+            CompressorKernels::followEnvelope(detector, envelope, numSamples, state.envelope,
+                                              attackCoeff, releaseCoeff);
+            break;
+
+        case Mode::rms:
+            // The level goes through the envelope buffer, which the follower then smooths in place.
+            measureRms(state, squares.data() + static_cast<size_t>(channel) * static_cast<size_t>(rmsRingSize),
+                       detector, envelope, numSamples);
+            CompressorKernels::followEnvelope(envelope, envelope, numSamples, state.envelope,
+                                              attackCoeff, releaseCoeff);
+            break;
+
+        case Mode::truePeak:
+            measureTruePeak(state, truePeakHistory.data() + static_cast<size_t>(channel * 2 * truePeakTaps),
+                            detector, envelope, numSamples);
+            CompressorKernels::followEnvelope(envelope, envelope, numSamples, state.envelope,
+                                              attackCoeff, releaseCoeff);
+            break;
+
+        case Mode::programDependent:
+            followDualRelease(state, detector, envelope, numSamples, attackCoeff, releaseCoeff);
+            break;
+    }
+}
+
+float LevelDetector::getLevel(int channel) const
+{
+    const auto& state = channels[static_cast<size_t>(channel)];
+    return std::max(state.envelope, state.slowEnvelope);
+}
+
+void LevelDetector::skipSilence(int channel, int numSamples, float releaseCoeff)
+{
+    auto& state = channels[static_cast<size_t>(channel)];
+    const float decay = std::pow(releaseCoeff, static_cast<float>(numSamples));
+
+    if (mode == Mode::programDependent)
+    {
+        // The fast stage decays by r^4 per sample (f_k = f rf^k); the slow stage follows it:
+        // s_n = r^n s + (1 - r) f rf (r^n - rf^n) / (r - rf).
+        float fastReleaseCoeff = releaseCoeff;
+        for (int i = 1; i < programReleaseSpeedup; ++i)
+            fastReleaseCoeff *= releaseCoeff;
+
+        const float fastDecay = std::pow(fastReleaseCoeff, static_cast<float>(numSamples));
+        const float spread = releaseCoeff - fastReleaseCoeff;
+        const float followed = spread > 0.0f
+            ? (1.0f - releaseCoeff) * state.envelope * fastReleaseCoeff * (decay - fastDecay) / spread
+            : 0.0f;
+
+        state.slowEnvelope = decay * state.slowEnvelope + followed;
+        state.envelope *= fastDecay;
+        return;
+    }
+
+    state.envelope *= decay;
+
+    if (mode == Mode::rms)
+    {
+        // The last min(numSamples, ring) squares written would all have been zero.
+        float* ring = squares.data() + static_cast<size_t>(channel) * static_cast<size_t>(rmsRingSize);
+        const int end = static_cast<int>((static_cast<int64_t>(state.rmsPosition) + numSamples) % rmsRingSize);
+        const int count = std::min(numSamples, rmsRingSize);
+
+        for (int age = 1; age <= count; ++age)
+            ring[wrap(end - age, rmsRingSize)] = 0.0f;
+
+        state.rmsPosition = end;
+        state.rmsCount = std::min(state.rmsCount + count, rmsRingSize);
+        state.sumOfSquares = 0.0;
+    }
+}
+
+void LevelDetector::measureRms(ChannelState& state, float* ring, const float* detector, float* level, int numSamples)
+{
+    const double windowScale = 1.0 / static_cast<double>(rmsWindow);
+    double sum = state.sumOfSquares;
+    int position = state.rmsPosition;
+    int oldest = wrap(position - rmsWindow, rmsRingSize);
+    int count = state.rmsCount;
+    int i = 0;
+
+    // Until the window has filled since the ring was emptied, nothing leaves it and the
+    // level is the mean of what has come in so far.
+    for (; i < numSamples && count < rmsWindow; ++i)
+    {
+        const float square = detector[i] * detector[i];
+
+        sum += static_cast<double>(square);
+        ring[position] = square;
+
+        position = position + 1 == rmsRingSize ? 0 : position + 1;
+        oldest = oldest + 1 == rmsRingSize ? 0 : oldest + 1;
+        ++count;
+
+        level[i] = static_cast<float>(std::sqrt(sum / static_cast<double>(count)));
+    }
+
+    for (; i < numSamples; ++i)
+    {
+        const float square = detector[i] * detector[i];
+
+        // Read before writing: with a full-length window the oldest square is the one overwritten.
+        sum += static_cast<double>(square) - static_cast<double>(ring[oldest]);
+        ring[position] = square;
+
+        position = position + 1 == rmsRingSize ? 0 : position + 1;
+        oldest = oldest + 1 == rmsRingSize ? 0 : oldest + 1;
+
+        level[i] = static_cast<float>(std::sqrt(std::max(sum, 0.0) * windowScale));
+    }
+
+    state.sumOfSquares = std::max(sum, 0.0);
+    state.rmsPosition = position;
+    state.rmsCount = std::min(state.rmsCount + numSamples, rmsRingSize);
+}
+
+void LevelDetector::measureTruePeak(ChannelState& state, float* history, const float* detector, float* level,
+                                    int numSamples)
+{
+    // Each sample is stored at position and position + taps, so the last taps samples
+    // are always the contiguous run history[position + 1 .. position + taps].
+    int position = state.historyPosition;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        position = position + 1 == truePeakTaps ? 0 : position + 1;
+        history[position] = history[position + truePeakTaps] = detector[i];
+
+        // Taps outside, phases inside: the four phases are one 4-lane multiply-add per tap.
+        const float* window = history + position + 1;
+        float y[truePeakPhases] = {};
+
+        for (int tap = 0; tap < truePeakTaps; ++tap)
+            for (int phase = 0; phase < truePeakPhases; ++phase)
+                y[phase] += truePeakCoefficients[tap][phase] * window[tap];
+
+        level[i] = std::max(std::max(std::abs(y[0]), std::abs(y[1])), std::max(std::abs(y[2]), std::abs(y[3])));
+    }
+
+    state.historyPosition = position;
+}
+
+void LevelDetector::followDualRelease(ChannelState& state, const float* detector, float* envelope, int numSamples,
+                                      float attackCoeff, float releaseCoeff)
+{
+    // The fast stage releases programReleaseSpeedup times quicker than the release time
+    // (coefficient to that power); the slow stage averages it with the release time both ways.
+    float fastReleaseCoeff = releaseCoeff;
+    for (int i = 1; i < programReleaseSpeedup; ++i)
+        fastReleaseCoeff *= releaseCoeff;
+
+    float fast = state.envelope;
+    float slow = state.slowEnvelope;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float inputAbs = std::abs(detector[i]);
+        const float coeff = inputAbs > fast ? attackCoeff : fastReleaseCoeff;
+        fast = coeff * fast + (1.0f - coeff) * inputAbs;
+        slow = releaseCoeff * slow + (1.0f - releaseCoeff) * fast;
+        envelope[i] = std::max(fast, slow);
+    }
+
+    state.envelope = fast;
+    state.slowEnvelope = slow;
+}
+
+//==============================================================================
+template <bool useMax>
+void LevelDetector::processLinked(const int* groupChannels, int numChannels, const float* const* detectors,
+                                  float* const* envelopes, int numSamples, float attackCoeff, float releaseCoeff,
+                                  float link)
+{
+    numChannels = std::min(numChannels, maxLinkedChannels);
+    const float* inputs[maxLinkedChannels] = {};
+
+    for (int lane = 0; lane < numChannels; ++lane)
+    {
+        const auto channel = static_cast<size_t>(groupChannels[lane]);
+        inputs[lane] = detectors[lane];
+
+        // The RMS and true-peak levels are measured per channel into the envelope rows
+        // (no recursion there worth interleaving); the followers then run on them in place.
+        if (mode == Mode::rms)
+        {
+            measureRms(channels[channel], squares.data() + channel * static_cast<size_t>(rmsRingSize),
+                       detectors[lane], envelopes[lane], numSamples);
+            inputs[lane] = envelopes[lane];
+        }
+        else if (mode == Mode::truePeak)
+        {
+            measureTruePeak(channels[channel], truePeakHistory.data() + channel * 2 * truePeakTaps,
+                            detectors[lane], envelopes[lane], numSamples);
+            inputs[lane] = envelopes[lane];
+        }
+    }
+
+    if (mode == Mode::programDependent)
+        followLinked<useMax, true>(groupChannels, numChannels, inputs, envelopes, numSamples,
+                                   attackCoeff, releaseCoeff, link);
+    else
+        followLinked<useMax, false>(groupChannels, numChannels, inputs, envelopes, numSamples,
+                                    attackCoeff, releaseCoeff, link);
+}
+
+template <bool useMax, bool dualRelease>
+void LevelDetector::followLinked(const int* groupChannels, int numChannels, const float* const* inputs,
+                                 float* const* envelopes, int numSamples, float attackCoeff, float releaseCoeff,
+                                 float link)
+{
+    // Stereo pairs, by far the common group, get a two-lane loop the compiler unrolls.
+    if (link >= 1.0f)
+    {
+        if (numChannels == 2)
+            followLinked<useMax, dualRelease, true, 2>(groupChannels, numChannels, inputs, envelopes, numSamples,
+                                                       attackCoeff, releaseCoeff, link);
+        else
+            followLinked<useMax, dualRelease, true, 0>(groupChannels, numChannels, inputs, envelopes, numSamples,
+                                                       attackCoeff, releaseCoeff, link);
+    }
+    else
+    {
+        if (numChannels == 2)
+            followLinked<useMax, dualRelease, false, 2>(groupChannels, numChannels, inputs, envelopes, numSamples,
+                                                        attackCoeff, releaseCoeff, link);
+        else
+            followLinked<useMax, dualRelease, false, 0>(groupChannels, numChannels, inputs, envelopes, numSamples,
+                                                        attackCoeff, releaseCoeff, link);
+    }
+}
+
+template <bool useMax, bool dualRelease, bool fullLink, int numLanes>
+void LevelDetector::followLinked(const int* groupChannels, int numChannels, const float* const* inputs,
+                                 float* const* envelopes, int numSamples, float attackCoeff, float releaseCoeff,
+                                 float link)
+{
+    const int lanes = numLanes > 0 ? numLanes : numChannels;
+    const float meanScale = 1.0f / static_cast<float>(lanes);
+
+    float fastReleaseCoeff = releaseCoeff;
+    if constexpr (dualRelease)
+        for (int i = 1; i < programReleaseSpeedup; ++i)
+            fastReleaseCoeff *= releaseCoeff;
+
+    // The followers' states live in lane arrays for the chunk, so the recursions of
+    // the group overlap each other instead of each stalling on its own latency.
+    float fast[maxLinkedChannels];
+    float slow[maxLinkedChannels];
+    float level[maxLinkedChannels];
+
+    for (int lane = 0; lane < lanes; ++lane)
+    {
+        const auto& state = channels[static_cast<size_t>(groupChannels[lane])];
+        fast[lane] = state.envelope;
+        slow[lane] = state.slowEnvelope;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            const float inputAbs = std::abs(inputs[lane][i]);
+            const float coeff = inputAbs > fast[lane] ? attackCoeff : fastReleaseCoeff;
+            fast[lane] = coeff * fast[lane] + (1.0f - coeff) * inputAbs;
+
+            if constexpr (dualRelease)
+            {
+                slow[lane] = releaseCoeff * slow[lane] + (1.0f - releaseCoeff) * fast[lane];
+                level[lane] = std::max(fast[lane], slow[lane]);
+            }
+            else
+            {
+                level[lane] = fast[lane];
+            }
+        }
+
+        float linked = level[0];
+
+        if constexpr (numLanes == 2)
+        {
+            linked = CompressorKernels::getLinkedLevel<useMax>(level[0], level[1]);
+        }
+        else
+        {
+            for (int lane = 1; lane < lanes; ++lane)
+            {
+                if constexpr (useMax)
+                    linked = std::max(linked, level[lane]);
+                else
+                    linked += level[lane];
+            }
+
+            if constexpr (!useMax)
+                linked *= meanScale;
+        }
+
+        if constexpr (fullLink)
+        {
+            envelopes[0][i] = linked;
+        }
+        else
+        {
+            for (int lane = 0; lane < lanes; ++lane)
+                envelopes[lane][i] = level[lane] + link * (linked - level[lane]);
+        }
+    }
+
+    for (int lane = 0; lane < lanes; ++lane)
+    {
+        auto& state = channels[static_cast<size_t>(groupChannels[lane])];
+        state.envelope = fast[lane];
+
+        if constexpr (dualRelease)
+            state.slowEnvelope = slow[lane];
+    }
+}
+
+template void LevelDetector::processLinked<true>(const int*, int, const float* const*, float* const*, int,
+                                                 float, float, float);
+template void LevelDetector::processLinked<false>(const int*, int, const float* const*, float* const*, int,
+                                                  float, float, float);
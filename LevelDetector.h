@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//==============================================================================
+/**
+    The detector stage of the compressor: turns a channel's detector signal
+    into the envelope the gain curve reads, in one of four modes.
+
+    - peak: the attack/release follower on |x| (CompressorKernels::followEnvelope).
+    - rms: the follower on the root mean square of a sliding window. The window
+      is a ring of squares with a running sum (kept in double, so removing old
+      samples never drifts), so its cost per sample doesn't depend on its length.
+    - truePeak: the follower on the inter-sample peak, the largest magnitude of
+      a 4x polyphase interpolation (the 48-tap filter of ITU-R BS.1770), which
+      delays the detector by about six samples.
+    - programDependent: a peak follower whose release depends on the material.
+      A second, slow stage averages the first over the release time and the
+      envelope is the larger of the two: short transients recover at a quarter
+      of the release time, sustained material at the release time.
+
+    A link group's channels can also be processed together (processLinked):
+    their followers advance side by side, sample by sample, and are linked in
+    the same pass, so the group's audio is walked once rather than once per
+    channel and then again to link.
+
+    All state is per channel and allocated in prepare(), so channels may be
+    processed on different threads and nothing allocates while processing.
+*/
+class LevelDetector
+{
+public:
+    enum class Mode
+    {
+        peak,
+        rms,
+        truePeak,
+        programDependent
+    };
+
+    /** Allocates for numChannels and RMS windows up to maxRmsWindowSamples. */
+    void prepare(int numChannels, int maxRmsWindowSamples);
+    void reset();
+
+    /** The followers carry on from the level the curve last saw, so switching doesn't
+        make the gain jump; the RMS window and true-peak history of the new mode start
+        empty and fill as the input comes in. */
+    void setMode(Mode newMode);
+    Mode getMode() const { return mode; }
+
+    /** Clamped to 1 .. the prepared maximum. The running sums take the new length
+        over from the history they already hold, so moving it doesn't reset them. The
+        window moves at most maxRmsWindowStep samples per call, so the work is bounded;
+        call it once per block and it reaches the requested length within a few blocks. */
+    void setRmsWindow(int numSamples);
+    int getRmsWindow() const { return rmsWindow; }
+
+    static constexpr int maxRmsWindowStep = 512;
+
+    /** Writes numSamples of channel's envelope. attackCoeff and releaseCoeff are the
+        follower's one-pole coefficients at the rate the detector runs at. */
+    void process(int channel, const float* detector, float* envelope, int numSamples,
+                 float attackCoeff, float releaseCoeff);
+
+    static constexpr int maxLinkedChannels = 16;
+
+    /** process() for a link group of up to maxLinkedChannels channels at once, with the
+        envelopes moved towards the group's max (useMax) or mean by link (0..1), as
+        CompressorKernels::linkEnvelopes would. detectors and envelopes are per group
+        channel. With link >= 1 only envelopes[0] is written (the shared level). */
+    template <bool useMax>
+    void processLinked(const int* channels, int numChannels, const float* const* detectors, float* const* envelopes,
+                       int numSamples, float attackCoeff, float releaseCoeff, float link);
+
+    /** The level the curve would see next from channel, without new input. */
+    float getLevel(int channel) const;
+
+    /** Advances channel by numSamples of zero input in closed form: the envelopes decay
+        and the RMS ring takes zeros. The input must already have been silent for the
+        longest RMS window and the true-peak history, so the measured level is zero. */
+    void skipSilence(int channel, int numSamples, float releaseCoeff);
+
+private:
+    static constexpr int truePeakPhases = 4;
+    static constexpr int truePeakTaps = 12;
+
+    struct ChannelState
+    {
+        float envelope{ 0.0f };
+        float slowEnvelope{ 0.0f };  // Program-dependent release
+        double sumOfSquares{ 0.0 };  // Over the last min(rmsWindow, rmsCount) squares
+        int rmsPosition{ 0 };        // Next write into the ring of squares
+        int rmsCount{ 0 };           // Valid (newest) squares in the ring, up to its size
+        int historyPosition{ 0 };    // Newest sample of the true-peak history
+    };
+
+    Mode mode{ Mode::peak };
+    int rmsWindow{ 1 };
+    int rmsWindowTarget{ 1 };
+    int rmsRingSize{ 1 };
+
+    std::vector<float> squares;          // numChannels * rmsRingSize
+    std::vector<float> truePeakHistory;  // numChannels * 2 * truePeakTaps, each sample written twice
+    std::vector<ChannelState> channels;
+
+    void measureRms(ChannelState& state, float* ring, const float* detector, float* level, int numSamples);
+    void measureTruePeak(ChannelState& state, float* history, const float* detector, float* level, int numSamples);
+    void followDualRelease(ChannelState& state, const float* detector, float* envelope, int numSamples,
+                           float attackCoeff, float releaseCoeff);
+
+    // The follower (single or dual release) of every lane and the link, in one pass;
+    // numLanes is fixed at compile time for pairs and 0 (use numChannels) otherwise.
+    template <bool useMax, bool dualRelease, bool fullLink, int numLanes>
+    void followLinked(const int* channels, int numChannels, const float* const* inputs, float* const* envelopes,
+                      int numSamples, float attackCoeff, float releaseCoeff, float link);
+    template <bool useMax, bool dualRelease>
+    void followLinked(const int* channels, int numChannels, const float* const* inputs, float* const* envelopes,
+                      int numSamples, float attackCoeff, float releaseCoeff, float link);
+};
@@ -0,0 +1,161 @@
+#include "Lookahead.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    uint32_t nextPowerOfTwo(uint32_t n)
+    {
+        uint32_t size = 1;
+        while (size < n)
+            size <<= 1;
+        return size;
+    }
+}
+
+void Lookahead::prepare(int numChannels, int maxLookaheadSamples, int fadeSamples)
+{
+    maxLookahead = std::max(maxLookaheadSamples, 0);
+    lookahead = std::min(lookahead, maxLookahead);
+    fadeLength = std::max(fadeSamples, 1);
+
+    // The delay reads maxLookahead samples back and the deque holds at most a
+    // full window, so both need maxLookahead + 1 slots.
+    const uint32_t size = nextPowerOfTwo(static_cast<uint32_t>(maxLookahead) + 1);
+    delayMask = dequeMask = size - 1;
+
+    delayLines.assign(static_cast<size_t>(numChannels) * size, 0.0);
+    peakDeques.assign(static_cast<size_t>(numChannels) * size, PeakEntry{ 0, 0.0f });
+    channels.assign(static_cast<size_t>(numChannels), ChannelState{});
+    reset();
+}
+
+void Lookahead::reset()
+{
+    std::fill(delayLines.begin(), delayLines.end(), 0.0);
+
+    for (auto& state : channels)
+    {
+        state = ChannelState{};
+        state.delay = state.fadeFrom = static_cast<uint32_t>(lookahead);
+        state.fadePosition = fadeLength;
+    }
+}
+
+void Lookahead::setLookahead(int numSamples)
+{
+    const int newLookahead = std::min(std::max(numSamples, 0), maxLookahead);
+
+    // The deques weren't fed while the lookahead was off; their peaks are stale.
+    if (lookahead == 0 && newLookahead > 0)
+        for (auto& state : channels)
+            state.head = state.tail;
+
+    lookahead = newLookahead;
+}
+
+void Lookahead::processDetector(int channel, float* detector, int numSamples)
+{
+    if (lookahead == 0 || channel >= static_cast<int>(channels.size()))
+        return;
+
+    auto& state = channels[static_cast<size_t>(channel)];
+    auto* deque = peakDeques.data() + static_cast<size_t>(channel) * (dequeMask + 1);
+    const uint32_t window = static_cast<uint32_t>(lookahead) + 1;
+
+    uint32_t head = state.head;
+    uint32_t tail = state.tail;
+    uint32_t index = state.sampleIndex;
+
+    for (int i = 0; i < numSamples; ++i, ++index)
+    {
+        const float magnitude = std::abs(detector[i]);
+
+        // Entries no larger than the new one can never be the maximum again.
+        while (tail != head && deque[(tail - 1) & dequeMask].magnitude <= magnitude)
+            --tail;
+
+        // Drop whatever slid out of the window (wrap-safe distance; a shorter
+        // window after setLookahead() can expire several entries at once).
+        while (tail != head && index - deque[head & dequeMask].index >= window)
+            ++head;
+
+        deque[tail & dequeMask] = { index, magnitude };
+        ++tail;
+
+        detector[i] = deque[head & dequeMask].magnitude;
+    }
+
+    state.head = head;
+    state.tail = tail;
+    state.sampleIndex = index;
+}
+
+template <typename SampleType>
+void Lookahead::processAudio(int channel, SampleType* data, int numSamples)
+{
+    if (channel >= static_cast<int>(channels.size()))
+        return;
+
+    auto& state = channels[static_cast<size_t>(channel)];
+    auto* line = delayLines.data() + static_cast<size_t>(channel) * (delayMask + 1);
+    uint32_t writePosition = state.writePosition;
+
+    // A new lookahead starts a fade once the previous one has finished.
+    if (state.fadePosition >= fadeLength && state.delay != static_cast<uint32_t>(lookahead))
+    {
+        state.fadeFrom = state.delay;
+        state.delay = static_cast<uint32_t>(lookahead);
+        state.fadePosition = 0;
+    }
+
+    const uint32_t delay = state.delay;
+    int i = 0;
+
+    if (state.fadePosition < fadeLength)
+    {
+        // Linear crossfade from the old read position to the new one.
+        const uint32_t fadeFrom = state.fadeFrom;
+        const double fadeStep = 1.0 / static_cast<double>(fadeLength);
+        const int fadeEnd = std::min(numSamples, fadeLength - state.fadePosition);
+        double position = static_cast<double>(state.fadePosition) * fadeStep;
+
+        for (; i < fadeEnd; ++i, ++writePosition)
+        {
+            line[writePosition & delayMask] = data[i];
+            position += fadeStep;
+
+            const double from = line[(writePosition - fadeFrom) & delayMask];
+            const double to = line[(writePosition - delay) & delayMask];
+            data[i] = static_cast<SampleType>(from + (to - from) * position);
+        }
+
+        state.fadePosition += fadeEnd;
+    }
+
+    if (delay == 0)
+    {
+        // Only recorded, so a lookahead switched on later starts from this audio. Older
+        // samples than the longest delay would be overwritten before they are read.
+        const int skipped = std::max(numSamples - i - maxLookahead, 0);
+        writePosition += static_cast<uint32_t>(skipped);
+
+        for (i += skipped; i < numSamples; ++i, ++writePosition)
+            line[writePosition & delayMask] = data[i];
+
+        state.writePosition = writePosition;
+        return;
+    }
+
+    for (; i < numSamples; ++i, ++writePosition)
+    {
+        line[writePosition & delayMask] = data[i];
+        data[i] = static_cast<SampleType>(line[(writePosition - delay) & delayMask]);
+    }
+
+    state.writePosition = writePosition;
+}
+
+template void Lookahead::processAudio<float>(int, float*, int);
+template void Lookahead::processAudio<double>(int, double*, int);
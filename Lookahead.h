@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//==============================================================================
+/**
+    Lookahead for the compressor: the audio is delayed by N samples while the
+    detector sees the peak of the window the delayed audio is about to play,
+    so the gain is already down when a transient reaches the output.
+
+    The window peak is a sliding maximum kept in a monotonic deque (indices of
+    decreasing magnitudes), which costs O(1) amortised per sample whatever the
+    window length. The delay lines and deques are ring buffers with power-of-two
+    sizes, allocated in prepare() only; changing the lookahead at run time only
+    moves read positions.
+
+    The delay lines hold doubles, so float and double audio both pass through
+    unchanged and a host switching precision keeps the delayed samples. They
+    keep recording while the lookahead is 0, so turning it on continues from
+    the current audio instead of replaying whatever was last delayed.
+
+    A new lookahead time doesn't jump the read position: each channel
+    crossfades from the old delay to the new one over the prepared fade
+    length. Changes that arrive during a fade wait for it to finish, then
+    fade to the latest time, so automation never cuts between delays.
+*/
+class Lookahead
+{
+public:
+    /** Allocates for numChannels and lookahead times up to maxLookaheadSamples; changes
+        of the lookahead crossfade over fadeSamples. */
+    void prepare(int numChannels, int maxLookaheadSamples, int fadeSamples);
+
+    /** Clears the delay lines; the audio continues at the current lookahead without a fade. */
+    void reset();
+
+    /** Clamped to the prepared maximum. At 0 the detector is left alone and the audio
+        passes unchanged (but is still recorded); the detector windows restart empty
+        when the lookahead is turned back on. The audio fades over to the new delay. */
+    void setLookahead(int numSamples);
+    int getLookahead() const { return lookahead; }
+
+    /** Replaces each detector sample by the largest magnitude among it and the
+        previous lookahead samples of that channel. */
+    void processDetector(int channel, float* detector, int numSamples);
+
+    /** Delays a channel of audio by the lookahead, in place. SampleType is float or double.
+        Call it for every block, whatever the lookahead. */
+    template <typename SampleType>
+    void processAudio(int channel, SampleType* data, int numSamples);
+
+private:
+    struct PeakEntry
+    {
+        uint32_t index;
+        float magnitude;
+    };
+
+    struct ChannelState
+    {
+        uint32_t writePosition{ 0 };  // Delay line
+        uint32_t sampleIndex{ 0 };    // Running detector sample count (wraps)
+        uint32_t head{ 0 };           // Deque, front = oldest and largest
+        uint32_t tail{ 0 };           // One past the newest entry
+        uint32_t delay{ 0 };          // Delay the audio is read at (or fading to)
+        uint32_t fadeFrom{ 0 };       // Delay being faded out
+        int fadePosition{ 0 };        // Samples into the fade; fadeLength when none is running
+    };
+
+    int lookahead{ 0 };
+    int maxLookahead{ 0 };
+    int fadeLength{ 1 };
+    uint32_t delayMask{ 0 };
+    uint32_t dequeMask{ 0 };
+
+    std::vector<double> delayLines;     // numChannels * (delayMask + 1)
+    std::vector<PeakEntry> peakDeques;  // numChannels * (dequeMask + 1)
+    std::vector<ChannelState> channels;
+};
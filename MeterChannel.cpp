@@ -0,0 +1,126 @@
+#include "MeterChannel.h"
+
+MeterChannel::MeterChannel()
+{
+}
+
+void MeterChannel::push(const MeterFrame& frame)
+{
+    const auto scope = fifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        frames[static_cast<size_t>(scope.startIndex1)] = frame;
+}
+
+bool MeterChannel::drain(MeterFrame& result)
+{
+    const auto numReady = fifo.getNumReady();
+    if (numReady == 0)
+        return false;
+
+    result = {};
+    float inputPower = 0.0f;
+    float outputPower = 0.0f;
+
+    const auto scope = fifo.read(numReady);
+    scope.forEach([&](int index)
+        {
+            const auto& frame = frames[static_cast<size_t>(index)];
+            result.gainReductionDB = juce::jmax(result.gainReductionDB, frame.gainReductionDB);
+            result.inputPeak = juce::jmax(result.inputPeak, frame.inputPeak);
+            result.outputPeak = juce::jmax(result.outputPeak, frame.outputPeak);
+            inputPower += frame.inputRms * frame.inputRms;
+            outputPower += frame.outputRms * frame.outputRms;
+        });
+
+    result.inputRms = std::sqrt(inputPower / static_cast<float>(numReady));
+    result.outputRms = std::sqrt(outputPower / static_cast<float>(numReady));
+    return true;
+}
+
+//==============================================================================
+void HistoryColumn::merge(const HistoryColumn& other)
+{
+    minReductionDB = juce::jmin(minReductionDB, other.minReductionDB);
+    maxReductionDB = juce::jmax(maxReductionDB, other.maxReductionDB);
+    inputPeak = juce::jmax(inputPeak, other.inputPeak);
+    outputPeak = juce::jmax(outputPeak, other.outputPeak);
+}
+
+//==============================================================================
+void HistoryChannel::prepare(double sampleRate)
+{
+    samplesPerColumn = juce::jmax(1, juce::roundToInt(sampleRate * columnMs * 0.001));
+    currentSamples = 0;
+}
+
+void HistoryChannel::push(const MeterFrame& frame, int numSamples)
+{
+    const HistoryColumn block{ frame.gainReductionDB, frame.gainReductionDB, frame.inputPeak, frame.outputPeak };
+
+    if (currentSamples == 0)
+        current = block;
+    else
+        current.merge(block);
+
+    currentSamples += numSamples;
+
+    if (currentSamples < samplesPerColumn)
+        return;
+
+    // Every column the block completes gets its values; whatever is left starts the next one.
+    while (currentSamples >= samplesPerColumn)
+    {
+        const auto scope = fifo.write(1);
+
+        if (scope.blockSize1 > 0)
+            columns[static_cast<size_t>(scope.startIndex1)] = current;
+
+        currentSamples -= samplesPerColumn;
+        current = block;
+    }
+}
+
+int HistoryChannel::pop(HistoryColumn* destination, int maxColumns)
+{
+    const int numRead = juce::jmin(fifo.getNumReady(), maxColumns);
+    const auto scope = fifo.read(numRead);
+    int written = 0;
+
+    scope.forEach([&](int index) { destination[written++] = columns[static_cast<size_t>(index)]; });
+    return numRead;
+}
+
+void HistoryChannel::discardPending()
+{
+    fifo.read(fifo.getNumReady());
+}
+
+//==============================================================================
+void MeterBallistics::reset(float initialValue)
+{
+    value = peakHold = initialValue;
+    holdRemaining = 0.0f;
+}
+
+void MeterBallistics::update(float newValue, float elapsedSeconds)
+{
+    const float decay = decayRate * elapsedSeconds;
+
+    // Instant attack, linear fall.
+    value = juce::jmax(newValue, value - decay);
+
+    if (value >= peakHold)
+    {
+        peakHold = value;
+        holdRemaining = holdTime;
+    }
+    else if (holdRemaining > 0.0f)
+    {
+        holdRemaining -= elapsedSeconds;
+    }
+    else
+    {
+        peakHold = juce::jmax(value, peakHold - decay);
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Levels of one processed block, as pushed by the audio thread. */
+struct MeterFrame
+{
+    float gainReductionDB{ 0.0f }; // Largest reduction in the block (>= 0)
+    float inputPeak{ 0.0f };       // Linear peak over all input channels
+    float inputRms{ 0.0f };        // Linear RMS over all input channels
+    float outputPeak{ 0.0f };
+    float outputRms{ 0.0f };
+};
+
+//==============================================================================
+/**
+    Single-producer/single-consumer channel from the audio thread to the editor.
+
+    The audio thread pushes one MeterFrame per block into a fixed ring; the UI
+    drains every frame that arrived since its last tick and merges them, so
+    short peaks between two timer callbacks are never lost. Neither side locks
+    or allocates. If the UI stops draining (editor closed) new frames are
+    dropped until there is room again.
+*/
+class MeterChannel
+{
+public:
+    MeterChannel();
+
+    // Audio thread.
+    void push(const MeterFrame& frame);
+
+    /** UI thread. Merges every pending frame into result (peaks as maxima, RMS
+        as the power mean) and returns false if nothing arrived. */
+    bool drain(MeterFrame& result);
+
+private:
+    static constexpr int capacity = 512;
+
+    juce::AbstractFifo fifo{ capacity };
+    std::array<MeterFrame, capacity> frames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MeterChannel)
+};
+
+//==============================================================================
+/** One column of the history view: the range of gain reduction and the
+    largest input/output peaks over HistoryChannel::columnMs. */
+struct HistoryColumn
+{
+    float minReductionDB{ 0.0f };
+    float maxReductionDB{ 0.0f };
+    float inputPeak{ 0.0f };
+    float outputPeak{ 0.0f };
+
+    /** Widens this column to cover other as well. */
+    void merge(const HistoryColumn& other);
+};
+
+//==============================================================================
+/**
+    Single-producer/single-consumer channel of history columns.
+
+    The audio thread hands over each block's MeterFrame with its length; they
+    are min/max-decimated into fixed-length columns (at the block's resolution,
+    and a block longer than a column fills several), and only finished columns
+    cross the FIFO. Like MeterChannel, neither side locks or allocates, and
+    columns are dropped while the UI doesn't read them.
+*/
+class HistoryChannel
+{
+public:
+    static constexpr float columnMs = 10.0f;
+
+    // Audio thread (or before playback starts).
+    void prepare(double sampleRate);
+    void push(const MeterFrame& frame, int numSamples);
+
+    /** UI thread. Copies up to maxColumns finished columns, oldest first, and
+        returns how many. */
+    int pop(HistoryColumn* destination, int maxColumns);
+
+    /** UI thread. Drops every column that is waiting. */
+    void discardPending();
+
+private:
+    static constexpr int capacity = 512;
+
+    juce::AbstractFifo fifo{ capacity };
+    std::array<HistoryColumn, capacity> columns;
+
+    // The column being collected (audio thread only).
+    HistoryColumn current;
+    int currentSamples{ 0 };
+    int samplesPerColumn{ 480 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HistoryChannel)
+};
+
+//==============================================================================
+/**
+    UI-side meter ballistics: instant attack, linear decay in units per second
+    and a peak-hold marker that falls after holdTime.
+*/
+class MeterBallistics
+{
+public:
+    void setDecayRate(float unitsPerSecond) { decayRate = unitsPerSecond; }
+    void setHoldTime(float seconds) { holdTime = seconds; }
+    void reset(float initialValue);
+
+    /** Feeds the largest value since the last tick. */
+    void update(float newValue, float elapsedSeconds);
+
+    float getValue() const { return value; }
+    float getPeakHold() const { return peakHold; }
+
+private:
+    float value{ 0.0f };
+    float peakHold{ 0.0f };
+    float holdRemaining{ 0.0f };
+    float decayRate{ 20.0f };
+    float holdTime{ 1.5f };
+};
@@ -0,0 +1,528 @@
+#include "MultibandCompressor.h"
+#include "CompressorKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // One transposed direct form II step: y = b0 x + z1, z1 = b1 x - a1 y + z2, z2 = b2 x - a2 y.
+    template <typename Coefficients>
+    inline float tick(const Coefficients& c, float x, float& z1, float& z2)
+    {
+        const float y = c.b0 * x + z1;
+        z1 = c.b1 * x - c.a1 * y + z2;
+        z2 = c.b2 * x - c.a2 * y;
+        return y;
+    }
+
+    constexpr float defaultCrossovers[] = { 120.0f, 1000.0f, 4000.0f, 10000.0f };
+
+    // Closest crossovers may get to each other, and to Nyquist.
+    constexpr float minCrossoverSpacing = 1.1f;
+    constexpr double maxCrossoverFraction = 0.45;
+
+    // Filter state this small counts as rung out for the silence bypass (-120 dB).
+    constexpr float settledFilterState = 1.0e-6f;
+}
+
+//==============================================================================
+MultibandCompressor::MultibandCompressor()
+{
+    std::copy(std::begin(defaultCrossovers), std::end(defaultCrossovers), crossoverFrequency.begin());
+    makeupGain.fill(1.0f);
+    appliedMakeupGain.fill(1.0f);
+    smoothedGain.fill(1.0f);
+}
+
+void MultibandCompressor::prepare(int numChannels, int maxBlockSize, int maxRmsWindowSamples)
+{
+    numChannelsPrepared = std::min(std::max(numChannels, 0), maxChannels);
+    blockSize = std::max(maxBlockSize, 1);
+
+    const size_t bandSize = static_cast<size_t>(maxBands * numChannelsPrepared * blockSize);
+    bandAudio.assign(bandSize, 0.0f);
+    bandDetector.assign(bandSize, 0.0f);
+    envelopeScratch.assign(bandSize, 0.0f);
+    gainScratch.assign(bandSize, 0.0f);
+    levelDetector.prepare(maxBands * numChannelsPrepared, maxRmsWindowSamples);
+}
+
+void MultibandCompressor::reset()
+{
+    s1.fill(0.0f);
+    s2.fill(0.0f);
+    envelope.fill(0.0f);
+    levelDetector.reset();
+    smoothedGain.fill(1.0f);
+    appliedMakeupGain = makeupGain;
+}
+
+void MultibandCompressor::setSampleRate(double newSampleRate)
+{
+    if (newSampleRate == sampleRate)
+        return;
+
+    sampleRate = newSampleRate;
+    updateCrossovers();
+
+    for (int band = 0; band < maxBands; ++band)
+        updateTimeConstants(band);
+
+    reset();
+}
+
+void MultibandCompressor::setNumBands(int newNumBands)
+{
+    newNumBands = std::min(std::max(newNumBands, minBands), maxBands);
+    if (newNumBands == numBands)
+        return;
+
+    numBands = newNumBands;
+    updateCrossovers();
+    reset();
+}
+
+void MultibandCompressor::setCrossoverFrequencies(const float* frequencies)
+{
+    bool changed = false;
+
+    for (int k = 0; k < numBands - 1; ++k)
+    {
+        changed = changed || frequencies[k] != crossoverFrequency[static_cast<size_t>(k)];
+        crossoverFrequency[static_cast<size_t>(k)] = frequencies[k];
+    }
+
+    if (changed)
+        updateCrossovers();
+}
+
+void MultibandCompressor::setBandParameters(int band, const BandParameters& newParameters)
+{
+    auto& current = parameters[static_cast<size_t>(band)];
+
+    const bool curveChanged = newParameters.thresholdDB != current.thresholdDB
+                           || newParameters.ratio != current.ratio
+                           || newParameters.kneeDB != current.kneeDB;
+    const bool timesChanged = newParameters.attackMs != current.attackMs
+                           || newParameters.releaseMs != current.releaseMs;
+    const bool makeupChanged = newParameters.makeupDB != current.makeupDB;
+
+    if (!curveChanged && !timesChanged && !makeupChanged)
+        return;
+
+    current = newParameters;
+
+    if (curveChanged)
+        gainComputers[static_cast<size_t>(band)].setParameters(current.thresholdDB, current.ratio, current.kneeDB);
+
+    if (timesChanged)
+        updateTimeConstants(band);
+
+    if (makeupChanged)
+        makeupGain[static_cast<size_t>(band)] = std::pow(10.0f, current.makeupDB * 0.05f);
+
+    parametersChanged[static_cast<size_t>(band)] = true;
+}
+
+void MultibandCompressor::setStereoLink(float newLink, bool newUseMax)
+{
+    link = std::min(std::max(newLink, 0.0f), 1.0f);
+    useMax = newUseMax;
+}
+
+void MultibandCompressor::setIsa(GainComputer::Isa newIsa)
+{
+    for (auto& gainComputer : gainComputers)
+        gainComputer.setIsa(newIsa);
+}
+
+void MultibandCompressor::setDetector(LevelDetector::Mode newMode, int rmsWindowSamples)
+{
+    levelDetector.setMode(newMode);
+    levelDetector.setRmsWindow(rmsWindowSamples);
+}
+
+void MultibandCompressor::setPrecision(GainComputer::Precision newPrecision)
+{
+    for (auto& gainComputer : gainComputers)
+    {
+        gainComputer.setPrecision(newPrecision);
+        gainComputer.syncTable();
+    }
+}
+
+bool MultibandCompressor::buildTables()
+{
+    bool built = false;
+
+    for (auto& gainComputer : gainComputers)
+        built = gainComputer.buildTable() || built;
+
+    return built;
+}
+
+//==============================================================================
+float* MultibandCompressor::getBandAudio(int band, int channel)
+{
+    return bandAudio.data() + static_cast<size_t>((band * numChannelsPrepared + channel) * blockSize);
+}
+
+float* MultibandCompressor::getBandDetector(int band, int channel)
+{
+    return bandDetector.data() + static_cast<size_t>((band * numChannelsPrepared + channel) * blockSize);
+}
+
+float* MultibandCompressor::getBandEnvelope(int band, int channel)
+{
+    return envelopeScratch.data() + static_cast<size_t>((band * numChannelsPrepared + channel) * blockSize);
+}
+
+float* MultibandCompressor::getBandGain(int band, int channel)
+{
+    return gainScratch.data() + static_cast<size_t>((band * numChannelsPrepared + channel) * blockSize);
+}
+
+float* MultibandCompressor::getFilterState(std::array<float, maxCrossovers * numSections * maxChannels>& state,
+                                           int crossover, int section)
+{
+    return state.data() + (crossover * numSections + section) * maxChannels;
+}
+
+void MultibandCompressor::updateCrossovers()
+{
+    if (sampleRate <= 0.0)
+        return;
+
+    const double pi = 3.14159265358979323846;
+    const double q = 0.70710678118654752; // Butterworth halves of the LR4 split
+    double previous = 0.0;
+
+    for (int k = 0; k < numBands - 1; ++k)
+    {
+        double f = std::max(static_cast<double>(crossoverFrequency[static_cast<size_t>(k)]), previous * minCrossoverSpacing);
+        f = std::min(std::max(f, 10.0), sampleRate * maxCrossoverFraction);
+        previous = f;
+
+        // RBJ cookbook low pass and allpass at the same frequency and Q.
+        const double w0 = 2.0 * pi * f / sampleRate;
+        const double cosW0 = std::cos(w0);
+        const double alpha = std::sin(w0) / (2.0 * q);
+        const double a0 = 1.0 + alpha;
+        const float a1 = static_cast<float>(-2.0 * cosW0 / a0);
+        const float a2 = static_cast<float>((1.0 - alpha) / a0);
+
+        auto& lp = lowPass[static_cast<size_t>(k)];
+        lp.b0 = lp.b2 = static_cast<float>((1.0 - cosW0) * 0.5 / a0);
+        lp.b1 = static_cast<float>((1.0 - cosW0) / a0);
+        lp.a1 = a1;
+        lp.a2 = a2;
+
+        auto& ap = allPass[static_cast<size_t>(k)];
+        ap.b0 = a2;
+        ap.b1 = a1;
+        ap.b2 = 1.0f;
+        ap.a1 = a1;
+        ap.a2 = a2;
+    }
+}
+
+void MultibandCompressor::updateTimeConstants(int band)
+{
+    if (sampleRate <= 0.0)
+        return;
+
+    const auto& p = parameters[static_cast<size_t>(band)];
+    const float rate = static_cast<float>(sampleRate);
+    attackCoeff[static_cast<size_t>(band)] = std::exp(-1.0f / (p.attackMs * 0.001f * rate));
+    releaseCoeff[static_cast<size_t>(band)] = std::exp(-1.0f / (p.releaseMs * 0.001f * rate));
+}
+
+void MultibandCompressor::split(int channel, int numSamples, bool isDetector)
+{
+    const int firstSection = isDetector ? detectorLow1 : audioLow1;
+
+    // Stage k leaves band k in place and writes everything above it into band k + 1:
+    // low = LP(LP(x)), high = AP(x) - low, since the LR4 pair sums to the allpass.
+    for (int k = 0; k < numBands - 1; ++k)
+    {
+        float* low = isDetector ? getBandDetector(k, channel) : getBandAudio(k, channel);
+        float* high = isDetector ? getBandDetector(k + 1, channel) : getBandAudio(k + 1, channel);
+        const auto lp = lowPass[static_cast<size_t>(k)];
+        const auto ap = allPass[static_cast<size_t>(k)];
+
+        float* state1 = getFilterState(s1, k, firstSection) + channel;
+        float* state2 = getFilterState(s2, k, firstSection) + channel;
+        float l1a = state1[0], l1b = state2[0];
+        float l2a = state1[maxChannels], l2b = state2[maxChannels];
+        float apa = state1[2 * maxChannels], apb = state2[2 * maxChannels];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = low[i];
+            const float y = tick(lp, tick(lp, x, l1a, l1b), l2a, l2b);
+            low[i] = y;
+            high[i] = tick(ap, x, apa, apb) - y;
+        }
+
+        state1[0] = l1a; state2[0] = l1b;
+        state1[maxChannels] = l2a; state2[maxChannels] = l2b;
+        state1[2 * maxChannels] = apa; state2[2 * maxChannels] = apb;
+    }
+}
+
+float MultibandCompressor::compressBands(bool separateDetector, const int* channels, int numChannels, int numSamples)
+{
+    // Lane arrays, packed over the bands in use: lane = band * numChannels + group channel.
+    const float* laneDetector[maxLanes];
+    float* laneEnvelope[maxLanes];
+    float laneState[maxLanes];
+    float laneAttack[maxLanes];
+    float laneRelease[maxLanes];
+    int numLanes = 0;
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        for (int i = 0; i < numChannels; ++i, ++numLanes)
+        {
+            const int ch = channels[i];
+            laneDetector[numLanes] = separateDetector ? getBandDetector(band, ch) : getBandAudio(band, ch);
+            laneEnvelope[numLanes] = getBandEnvelope(band, ch);
+            laneState[numLanes] = envelope[static_cast<size_t>(band * maxChannels + ch)];
+            laneAttack[numLanes] = attackCoeff[static_cast<size_t>(band)];
+            laneRelease[numLanes] = releaseCoeff[static_cast<size_t>(band)];
+        }
+    }
+
+    // (1) Envelope followers of every band and channel in one pass, or lane by lane
+    // through the level detector in the other modes.
+    if (levelDetector.getMode() == LevelDetector::Mode::peak)
+    {
+        CompressorKernels::followEnvelopes(laneDetector, laneEnvelope, numLanes, numSamples,
+                                           laneState, laneAttack, laneRelease);
+    }
+    else
+    {
+        for (int lane = 0; lane < numLanes; ++lane)
+            levelDetector.process((lane / numChannels) * numChannelsPrepared + channels[lane % numChannels],
+                                  laneDetector[lane], laneEnvelope[lane], numSamples, laneAttack[lane], laneRelease[lane]);
+    }
+
+    // (2) Linking, the bypass check and the static curve, band by band. Bands that
+    // need it queue their channels for the gain pass.
+    float* gainData[maxLanes];
+    const float* gainTarget[maxLanes];
+    float gainState[maxLanes];
+    float gainMakeupStart[maxLanes];
+    float gainMakeupEnd[maxLanes];
+    int gainBand[maxLanes];
+    int numGainLanes = 0;
+
+    const bool linked = numChannels > 1 && link > 0.0f;
+    float maxReductionDB = 0.0f;
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        const auto b = static_cast<size_t>(band);
+        const int slot = band * maxChannels;
+        float* bandEnvelopes[maxChannels] = {};
+
+        for (int i = 0; i < numChannels; ++i)
+        {
+            envelope[static_cast<size_t>(slot + channels[i])] = laneState[band * numChannels + i];
+            bandEnvelopes[i] = getBandEnvelope(band, channels[i]);
+        }
+
+        if (linked)
+            CompressorKernels::linkEnvelopes(bandEnvelopes, numChannels, numSamples, link, useMax);
+
+        const auto& gainComputer = gainComputers[b];
+        bool idle = !parametersChanged[b];
+        for (int i = 0; i < numChannels && idle; ++i)
+            idle = smoothedGain[static_cast<size_t>(slot + channels[i])] >= CompressorKernels::recoveredGain
+                && CompressorKernels::findMaximum(bandEnvelopes[i], numSamples) < gainComputer.getOnsetLevel();
+
+        if (idle)
+        {
+            // Nothing to reduce, nothing left to recover and no parameter ramp.
+            for (int i = 0; i < numChannels; ++i)
+            {
+                smoothedGain[static_cast<size_t>(slot + channels[i])] = 1.0f;
+                CompressorKernels::applyGainRamp(getBandAudio(band, channels[i]), numSamples, makeupGain[b], makeupGain[b]);
+            }
+
+            continue;
+        }
+
+        // A full link leaves the same level in every channel: one curve pass serves the group.
+        const bool shared = linked && link >= 1.0f;
+        float reductionDB = 0.0f;
+
+        for (int i = 0; i < numChannels; ++i, ++numGainLanes)
+        {
+            const int ch = channels[i];
+
+            if (!shared || i == 0)
+                reductionDB = std::max(reductionDB,
+                    gainComputer.process(bandEnvelopes[i], getBandGain(band, ch), numSamples));
+
+            gainData[numGainLanes] = getBandAudio(band, ch);
+            gainTarget[numGainLanes] = getBandGain(band, shared ? channels[0] : ch);
+            gainState[numGainLanes] = smoothedGain[static_cast<size_t>(slot + ch)];
+            laneAttack[numGainLanes] = attackCoeff[b];
+            laneRelease[numGainLanes] = releaseCoeff[b];
+            gainMakeupStart[numGainLanes] = appliedMakeupGain[b];
+            gainMakeupEnd[numGainLanes] = makeupGain[b];
+            gainBand[numGainLanes] = slot + ch;
+        }
+
+        maxReductionDB = std::max(maxReductionDB, reductionDB);
+    }
+
+    // (3) Gain smoothing and the multiply for every active band and channel in one pass.
+    CompressorKernels::applyGains(gainData, gainTarget, numGainLanes, numSamples, gainState,
+                                  laneAttack, laneRelease, gainMakeupStart, gainMakeupEnd);
+
+    for (int lane = 0; lane < numGainLanes; ++lane)
+        smoothedGain[static_cast<size_t>(gainBand[lane])] = gainState[lane];
+
+    return maxReductionDB;
+}
+
+void MultibandCompressor::sumBands(float* output, int channel, int numSamples)
+{
+    // out = AP(...AP(AP(band 0) + band 1)...) + band n-1: every inner crossover's allpass
+    // goes over everything below it. All allpasses run in one loop so their recursions overlap.
+    const int numAllpasses = numBands - 2;
+    Coefficients ap[maxCrossovers];
+    float z1[maxCrossovers], z2[maxCrossovers];
+    const float* bands[maxBands] = {};
+
+    for (int k = 0; k < numAllpasses; ++k)
+    {
+        ap[k] = allPass[static_cast<size_t>(k + 1)];
+        z1[k] = getFilterState(s1, k + 1, sumAllpass)[channel];
+        z2[k] = getFilterState(s2, k + 1, sumAllpass)[channel];
+    }
+
+    for (int band = 0; band < numBands; ++band)
+        bands[band] = getBandAudio(band, channel);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float sum = bands[0][i];
+
+        for (int k = 0; k < numAllpasses; ++k)
+            sum = tick(ap[k], sum, z1[k], z2[k]) + bands[k + 1][i];
+
+        output[i] = sum + bands[numBands - 1][i];
+    }
+
+    for (int k = 0; k < numAllpasses; ++k)
+    {
+        getFilterState(s1, k + 1, sumAllpass)[channel] = z1[k];
+        getFilterState(s2, k + 1, sumAllpass)[channel] = z2[k];
+    }
+}
+
+float MultibandCompressor::process(float* const* audio, const float* const* detector, const ChannelGroups& groups,
+                                   int numSamples)
+{
+    float maxReductionDB = 0.0f;
+
+    for (int group = 0; group < groups.numGroups; ++group)
+        maxReductionDB = std::max(maxReductionDB, processGroup(audio, detector, groups, group, numSamples));
+
+    finishBlock();
+    return maxReductionDB;
+}
+
+float MultibandCompressor::processGroup(float* const* audio, const float* const* detector, const ChannelGroups& groups,
+                                        int group, int numSamples)
+{
+    // Only the group's own channels are touched (filter state, envelopes, gains and band
+    // buffers are all per channel), which is what lets groups run side by side.
+    int channels[maxChannels] = {};
+    int numChannels = 0;
+
+    for (int i = 0; i < groups.getGroupSize(group); ++i)
+        if (groups.getGroupChannels(group)[i] < numChannelsPrepared)
+            channels[numChannels++] = groups.getGroupChannels(group)[i];
+
+    // The makeup ramps run once per block, from the last block's makeup to the current one.
+    numSamples = std::min(numSamples, blockSize);
+
+    const bool separateDetector = detector != nullptr;
+    const size_t bytes = sizeof(float) * static_cast<size_t>(numSamples);
+
+    for (int i = 0; i < numChannels; ++i)
+    {
+        const int ch = channels[i];
+        std::memcpy(getBandAudio(0, ch), audio[ch], bytes);
+        split(ch, numSamples, false);
+
+        if (separateDetector)
+        {
+            std::memcpy(getBandDetector(0, ch), detector[ch], bytes);
+            split(ch, numSamples, true);
+        }
+    }
+
+    const float maxReductionDB = compressBands(separateDetector, channels, numChannels, numSamples);
+
+    for (int i = 0; i < numChannels; ++i)
+        sumBands(audio[channels[i]], channels[i], numSamples);
+
+    return maxReductionDB;
+}
+
+void MultibandCompressor::finishBlock()
+{
+    parametersChanged.fill(false);
+    appliedMakeupGain = makeupGain;
+}
+
+bool MultibandCompressor::isSettled() const
+{
+    const bool peakMode = levelDetector.getMode() == LevelDetector::Mode::peak;
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        const float onsetLevel = gainComputers[static_cast<size_t>(band)].getOnsetLevel();
+
+        for (int ch = 0; ch < numChannelsPrepared; ++ch)
+        {
+            const auto lane = static_cast<size_t>(band * maxChannels + ch);
+            const float level = peakMode ? envelope[lane] : levelDetector.getLevel(band * numChannelsPrepared + ch);
+
+            if (smoothedGain[lane] < CompressorKernels::recoveredGain || level >= onsetLevel)
+                return false;
+        }
+    }
+
+    // The crossovers ring on after the input stops; skipping them would cut that off.
+    auto isRungOut = [](float state) { return std::abs(state) <= settledFilterState; };
+    return std::all_of(s1.begin(), s1.end(), isRungOut) && std::all_of(s2.begin(), s2.end(), isRungOut);
+}
+
+void MultibandCompressor::skipSilence(int numSamples)
+{
+    for (int band = 0; band < numBands; ++band)
+    {
+        const auto b = static_cast<size_t>(band);
+        const float decay = std::pow(releaseCoeff[b], static_cast<float>(numSamples));
+
+        for (int ch = 0; ch < numChannelsPrepared; ++ch)
+        {
+            const auto lane = static_cast<size_t>(band * maxChannels + ch);
+            envelope[lane] *= decay;
+            smoothedGain[lane] = 1.0f;
+
+            if (levelDetector.getMode() != LevelDetector::Mode::peak)
+                levelDetector.skipSilence(band * numChannelsPrepared + ch, numSamples, releaseCoeff[b]);
+        }
+    }
+
+    finishBlock();
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "ChannelGroups.h"
+#include "GainComputer.h"
+#include "LevelDetector.h"
+
+#include <array>
+#include <vector>
+
+//==============================================================================
+/**
+    3-5 band compression on Linkwitz-Riley crossovers.
+
+    Each crossover is a 4th-order Linkwitz-Riley split. Its low and high pass
+    sum to a 2nd-order allpass, so the high side is taken as allpass minus low
+    pass (three biquads per crossover instead of four). The split is a tree:
+    stage k divides what is left above crossover k - 1 into band k and the rest.
+    The lower bands are lacking the allpass of every later crossover; the sum
+    adds those back (one allpass per inner crossover, Horner style) and comes
+    out flat in magnitude.
+
+    Every band runs the broadband compressor's passes (CompressorKernels plus a
+    GainComputer of its own) with its own parameters. Band state is kept as
+    structure of arrays: one array per quantity, indexed band * maxChannels +
+    channel, and one contiguous buffer per band and channel. The recursive
+    envelope and gain passes run all bands and channels as lanes of one loop.
+    A band whose envelopes stay below its knee, whose gain has fully recovered
+    and whose parameters didn't change skips the curve and the gain smoothing
+    and passes through (with its makeup, if any). In the non-peak detector
+    modes every band and channel has a LevelDetector lane of its own instead.
+
+    Channels are processed in link groups (see ChannelGroups): the envelopes of
+    a group are linked with each other, and different groups share no state, so
+    processGroup() may run the groups of one block on different threads.
+
+    All buffers are allocated in prepare(); nothing allocates while processing.
+*/
+class MultibandCompressor
+{
+public:
+    static constexpr int minBands = 3;
+    static constexpr int maxBands = 5;
+    static constexpr int maxChannels = 16;
+
+    struct BandParameters
+    {
+        float thresholdDB{ -24.0f };
+        float ratio{ 4.0f };
+        float kneeDB{ 0.0f };
+        float attackMs{ 10.0f };
+        float releaseMs{ 100.0f };
+        float makeupDB{ 0.0f };
+    };
+
+    MultibandCompressor();
+
+    /** maxBlockSize and maxRmsWindowSamples are at the processing rate (after any
+        oversampling); process() takes at most maxBlockSize samples at a time. */
+    void prepare(int numChannels, int maxBlockSize, int maxRmsWindowSamples);
+    void reset();
+
+    /** Recomputes the crossovers and the time constants when the rate changes. */
+    void setSampleRate(double newSampleRate);
+
+    /** 3 to 5 bands; the filters and band state restart when the count changes. */
+    void setNumBands(int newNumBands);
+    int getNumBands() const { return numBands; }
+
+    /** numBands - 1 ascending frequencies in Hz (each is kept above the previous one). */
+    void setCrossoverFrequencies(const float* frequencies);
+
+    void setBandParameters(int band, const BandParameters& newParameters);
+
+    /** How far each channel of a link group moves towards the group's level (0 = independent). */
+    void setStereoLink(float newLink, bool newUseMax);
+
+    void setIsa(GainComputer::Isa newIsa);
+
+    /** Detector mode of every band (see LevelDetector); rmsWindowSamples is at the processing
+        rate. Call it once per block: the window moves towards its length in bounded steps. */
+    void setDetector(LevelDetector::Mode newMode, int rmsWindowSamples);
+
+    /** Sets every band's curve precision and picks up their latest tables (see
+        GainComputer::syncTable: audio thread, once per block, outside process()). */
+    void setPrecision(GainComputer::Precision newPrecision);
+
+    /** GainComputer::buildTable for every band; background thread only. */
+    bool buildTables();
+
+    /** Splits, compresses and re-sums every group's channels of audio in place. detector
+        is a separate key signal to split alongside, or nullptr to detect on the audio.
+        Returns the largest gain reduction of any band in dB. */
+    float process(float* const* audio, const float* const* detector, const ChannelGroups& groups, int numSamples);
+
+    /** process() for one group of the block. Calls for different groups of the same
+        block may run concurrently; finishBlock() must follow once all have returned. */
+    float processGroup(float* const* audio, const float* const* detector, const ChannelGroups& groups,
+                       int group, int numSamples);
+    void finishBlock();
+
+    /** True when every band's envelopes are below its curve, its gains have recovered
+        and the crossover filters have rung out: silent input would come out silent. */
+    bool isSettled() const;
+
+    /** Accounts for numSamples of silent input without processing them (the envelopes
+        decay as they would have); only valid while isSettled(). */
+    void skipSilence(int numSamples);
+
+private:
+    static constexpr int maxCrossovers = maxBands - 1;
+    static constexpr int maxLanes = maxBands * maxChannels;
+
+    // Normalised biquad coefficients (a0 == 1), transposed direct form II.
+    struct Coefficients
+    {
+        float b0{ 1.0f }, b1{ 0.0f }, b2{ 0.0f }, a1{ 0.0f }, a2{ 0.0f };
+    };
+
+    // Filter sections per crossover: the two low-pass halves of the LR4 split and
+    // the allpass the high side is derived from, for the audio and for a separate
+    // detector, and the allpass of the sum.
+    enum Section
+    {
+        audioLow1, audioLow2, audioAllpass,
+        detectorLow1, detectorLow2, detectorAllpass,
+        sumAllpass,
+        numSections
+    };
+
+    int numBands{ minBands };
+    int numChannelsPrepared{ 0 };
+    int blockSize{ 0 };
+    double sampleRate{ 0.0 };
+
+    std::array<float, maxCrossovers> crossoverFrequency{};
+    std::array<Coefficients, maxCrossovers> lowPass{};
+    std::array<Coefficients, maxCrossovers> allPass{};
+
+    // Filter state: [(crossover * numSections + section) * maxChannels + channel].
+    std::array<float, maxCrossovers * numSections * maxChannels> s1{};
+    std::array<float, maxCrossovers * numSections * maxChannels> s2{};
+
+    // Band parameters and the values derived from them, one slot per band.
+    std::array<BandParameters, maxBands> parameters{};
+    std::array<GainComputer, maxBands> gainComputers;
+    std::array<float, maxBands> attackCoeff{};
+    std::array<float, maxBands> releaseCoeff{};
+    std::array<float, maxBands> makeupGain{};
+    std::array<float, maxBands> appliedMakeupGain{};
+    std::array<bool, maxBands> parametersChanged{};
+
+    // Per band and channel: [band * maxChannels + channel].
+    std::array<float, maxLanes> envelope{};
+    std::array<float, maxLanes> smoothedGain{};
+
+    // Every mode but peak: one lane per band and channel, [band * numChannelsPrepared + channel].
+    LevelDetector levelDetector;
+
+    float link{ 1.0f };
+    bool useMax{ true };
+
+    // [(band * numChannels + channel) * blockSize], audio then detector.
+    std::vector<float> bandAudio;
+    std::vector<float> bandDetector;
+    std::vector<float> envelopeScratch; // Same layout as the band buffers
+    std::vector<float> gainScratch;
+
+    float* getBandAudio(int band, int channel);
+    float* getBandDetector(int band, int channel);
+    float* getBandEnvelope(int band, int channel);
+    float* getBandGain(int band, int channel);
+    float* getFilterState(std::array<float, maxCrossovers * numSections * maxChannels>& state,
+                          int crossover, int section);
+
+    void updateCrossovers();
+    void updateTimeConstants(int band);
+    void split(int channel, int numSamples, bool isDetector);
+    float compressBands(bool separateDetector, const int* channels, int numChannels, int numSamples);
+    void sumBands(float* output, int channel, int numSamples);
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+
+//==============================================================================
+/**
+    One 2x up/down stage built on a linear-phase half-band FIR.
+
+    Every other tap of a half-band filter is zero and the centre tap is 0.5, so
+    the polyphase split leaves one short FIR branch (the even taps) and one
+    pure delay: the upsampler computes one output of each pair with a K-tap
+    FIR and copies the other, and the downsampler runs K taps per output.
+    The latency is the centre index at the higher rate, for up and down each.
+*/
+class HalfBandStage
+{
+public:
+    /** numTaps must be 4k + 3; beta is the Kaiser window shape. */
+    HalfBandStage(int numTaps, double beta);
+
+    void prepare(int numChannels, int maxInputSamples);
+    void reset();
+
+    /** numSamples in, 2 * numSamples out. */
+    void upsample(int channel, const float* input, float* output, int numSamples);
+
+    /** 2 * numSamples in, numSamples out. */
+    void downsample(int channel, const float* input, float* output, int numSamples);
+
+    /** Centre tap index: the delay of one pass in samples at the higher rate. */
+    int getCentre() const { return centre; }
+
+private:
+    int centre;
+    std::vector<float> branch;         // Even taps, reversed for the convolution loops
+
+    int branchHistory{ 0 };            // Inputs the FIR branch needs from earlier blocks
+    int delayHistory{ 0 };             // Inputs the delay branch needs from earlier blocks
+    std::vector<float> upState;        // numChannels * branchHistory
+    std::vector<float> downEvenState;  // numChannels * branchHistory
+    std::vector<float> downOddState;   // numChannels * delayHistory
+    std::vector<float> work;           // History + one block, shared by all channels
+    std::vector<float> oddWork;
+};
+
+//==============================================================================
+/**
+    2x/4x oversampling for the compressor, as a cascade of half-band stages
+    (a steep one next to the base rate and a short one for the 2x to 4x step).
+
+    All buffers are allocated in prepare(); the audio thread only switches the
+    factor. The up/down round trip has an integer latency at the base rate (the
+    4x path adds a one-sample delay at 2x to round it up), which the processor
+    reports to the host and uses to time-align signals that skip the filters.
+*/
+class Oversampler
+{
+public:
+    Oversampler();
+
+    static constexpr int maxFactor = 4;
+
+    void prepare(int numChannels, int maxBlockSize);
+    void reset();
+
+    /** 1, 2 or 4. Resets the filter state when it changes. */
+    void setFactor(int newFactor);
+    int getFactor() const { return factor; }
+
+    /** Round-trip latency (upsample + downsample) at the base rate. */
+    int getLatencySamples() const;
+
+    /** numSamples in, numSamples * factor out. */
+    void upsample(int channel, const float* input, float* output, int numSamples);
+
+    /** numSamples * factor in, numSamples out. */
+    void downsample(int channel, const float* input, float* output, int numSamples);
+
+    /** Delays a base-rate signal by getLatencySamples(), in place, to line it up
+        with one that made the round trip. SampleType is float or double; the
+        line stores doubles so either passes through unchanged. */
+    template <typename SampleType>
+    void compensate(int channel, SampleType* data, int numSamples);
+
+private:
+    HalfBandStage stage1; // base <-> 2x
+    HalfBandStage stage2; // 2x <-> 4x
+
+    int factor{ 1 };
+    std::vector<float> intermediate;   // One block at 2x
+    std::vector<float> alignState;     // 4x only: one 2x sample per channel
+
+    std::vector<double> compensationLines;
+    std::vector<int> compensationPositions;
+    int compensationSize{ 0 };
+};
@@ -0,0 +1,228 @@
+#include "ParameterState.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr char magic[4] = { 'S', 'G', 'R', 'C' };
+    constexpr size_t headerSize = 16;
+    constexpr size_t entrySize = 8;
+
+    void writeUint16(uint8_t* destination, uint16_t value)
+    {
+        destination[0] = static_cast<uint8_t>(value);
+        destination[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    void writeUint32(uint8_t* destination, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            destination[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint16_t readUint16(const uint8_t* source)
+    {
+        return static_cast<uint16_t>(source[0] | (source[1] << 8));
+    }
+
+    uint32_t readUint32(const uint8_t* source)
+    {
+        return static_cast<uint32_t>(source[0]) | (static_cast<uint32_t>(source[1]) << 8)
+             | (static_cast<uint32_t>(source[2]) << 16) | (static_cast<uint32_t>(source[3]) << 24);
+    }
+}
+
+//==============================================================================
+ParameterState::ParameterState(juce::AudioProcessorValueTreeState& state)
+    : valueTreeState(state)
+{
+    for (auto* parameter : state.processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            entries.push_back({ hashParameterID(ranged->getParameterID()), ranged });
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+
+    // Two IDs with the same hash would share one slot in the binary format.
+    jassert(std::adjacent_find(entries.begin(), entries.end(),
+                               [](const Entry& a, const Entry& b) { return a.hash == b.hash; }) == entries.end());
+
+    restored.assign(entries.size(), 0);
+}
+
+uint32_t ParameterState::hashParameterID(const juce::String& parameterID)
+{
+    // FNV-1a over the UTF-8 bytes.
+    uint32_t hash = 2166136261u;
+
+    for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+    {
+        hash ^= static_cast<uint8_t>(*c);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+const ParameterState::Entry* ParameterState::findEntry(uint32_t hash) const
+{
+    const auto found = std::lower_bound(entries.begin(), entries.end(), hash,
+                                        [](const Entry& entry, uint32_t value) { return entry.hash < value; });
+
+    return found != entries.end() && found->hash == hash ? &*found : nullptr;
+}
+
+//==============================================================================
+void ParameterState::write(juce::MemoryBlock& destData) const
+{
+    destData.setSize(headerSize + entries.size() * entrySize);
+    auto* data = static_cast<uint8_t*>(destData.getData());
+
+    std::memcpy(data, magic, sizeof(magic));
+    writeUint16(data + 4, currentVersion);
+    writeUint16(data + 6, static_cast<uint16_t>(headerSize));
+    writeUint16(data + 8, static_cast<uint16_t>(entrySize));
+    writeUint16(data + 10, 0);
+    writeUint32(data + 12, static_cast<uint32_t>(entries.size()));
+
+    auto* entryData = data + headerSize;
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const float value = getValue(i);
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        writeUint32(entryData, entries[i].hash);
+        writeUint32(entryData + 4, bits);
+        entryData += entrySize;
+    }
+}
+
+bool ParameterState::read(const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes <= 0)
+        return false;
+
+    if (readBinary(static_cast<const uint8_t*>(data), static_cast<size_t>(sizeInBytes)))
+        return true;
+
+    auto xml = juce::AudioProcessor::getXmlFromBinary(data, sizeInBytes);
+    if (xml == nullptr)
+        xml = juce::parseXML(juce::String::fromUTF8(static_cast<const char*>(data), sizeInBytes));
+
+    return xml != nullptr && readXml(*xml);
+}
+
+bool ParameterState::readBinary(const uint8_t* data, size_t size)
+{
+    if (size < headerSize || std::memcmp(data, magic, sizeof(magic)) != 0)
+        return false;
+
+    // Later versions may only grow the header and the entries; what version 1 knows stays put.
+    const uint16_t version = readUint16(data + 4);
+    const size_t stateHeaderSize = readUint16(data + 6);
+    const size_t stateEntrySize = readUint16(data + 8);
+    const size_t numEntries = readUint32(data + 12);
+
+    if (version == 0 || stateHeaderSize < headerSize || stateHeaderSize > size || stateEntrySize < entrySize
+        || numEntries > (size - stateHeaderSize) / stateEntrySize)
+        return false;
+
+    const uint8_t* entryData = data + stateHeaderSize;
+    applyEntries(entryData, stateEntrySize, entryData + 4, stateEntrySize, numEntries);
+    return true;
+}
+
+void ParameterState::applyEntries(const uint8_t* hashData, size_t hashStride, const uint8_t* valueData,
+                                  size_t valueStride, size_t count)
+{
+    std::fill(restored.begin(), restored.end(), static_cast<uint8_t>(0));
+
+    for (size_t i = 0; i < count; ++i, hashData += hashStride, valueData += valueStride)
+    {
+        const uint32_t bits = readUint32(valueData);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+
+        if (const auto* entry = findEntry(readUint32(hashData)); entry != nullptr && std::isfinite(value))
+            setValue(static_cast<size_t>(entry - entries.data()), value);
+    }
+
+    resetUnrestored();
+}
+
+bool ParameterState::readXml(const juce::XmlElement& xml)
+{
+    std::fill(restored.begin(), restored.end(), static_cast<uint8_t>(0));
+    bool recognised = false;
+
+    auto restore = [this, &recognised](const juce::String& parameterID, double value)
+        {
+            if (const auto* entry = findEntry(hashParameterID(parameterID)); entry != nullptr && std::isfinite(value))
+            {
+                setValue(static_cast<size_t>(entry - entries.data()), static_cast<float>(value));
+                recognised = true;
+            }
+        };
+
+    // The value tree's <PARAM id="..." value="..."/> children, or one attribute per parameter.
+    for (auto* child : xml.getChildWithTagNameIterator("PARAM"))
+        restore(child->getStringAttribute("id"), child->getDoubleAttribute("value"));
+
+    for (int i = 0; i < xml.getNumAttributes(); ++i)
+        restore(xml.getAttributeName(i), xml.getAttributeValue(i).getDoubleValue());
+
+    if (recognised)
+        resetUnrestored();
+
+    return recognised;
+}
+
+std::unique_ptr<juce::XmlElement> ParameterState::createXml() const
+{
+    auto xml = std::make_unique<juce::XmlElement>(valueTreeState.state.getType());
+
+    for (size_t i = 0; i < entries.size(); ++i)
+        xml->setAttribute(entries[i].parameter->getParameterID(), getValue(i));
+
+    return xml;
+}
+
+float ParameterState::getValue(size_t index) const
+{
+    const auto* parameter = entries[index].parameter;
+    return parameter->convertFrom0to1(parameter->getValue());
+}
+
+float ParameterState::getDefaultValue(size_t index) const
+{
+    const auto* parameter = entries[index].parameter;
+    return parameter->convertFrom0to1(parameter->getDefaultValue());
+}
+
+void ParameterState::setValue(size_t entryIndex, float value)
+{
+    auto* parameter = entries[entryIndex].parameter;
+    const float normalised = parameter->convertTo0to1(value);
+
+    // Unchanged parameters skip the host and listener notifications.
+    if (parameter->getValue() != normalised)
+        parameter->setValueNotifyingHost(normalised);
+
+    restored[entryIndex] = 1;
+}
+
+void ParameterState::resetUnrestored()
+{
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        if (restored[i] != 0)
+            continue;
+
+        auto* parameter = entries[i].parameter;
+        if (parameter->getValue() != parameter->getDefaultValue())
+            parameter->setValueNotifyingHost(parameter->getDefaultValue());
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <cstdint>
+#include <vector>
+
+//==============================================================================
+/**
+    Saves and restores the full parameter set of a processor in a compact,
+    versioned binary format:
+
+        "SGRC", version, header size, entry size, entry count (16 bytes, little endian)
+        entry count * { uint32 FNV-1a hash of the parameter ID, float value }
+
+    Values are stored in the parameter's own units (dB, ms, choice index), so
+    a state survives range changes. Entries are keyed by ID hash: a reader
+    skips IDs it doesn't know and resets the parameters a state doesn't
+    mention to their defaults, and the header and entry sizes let an older
+    reader step over fields a newer version appends.
+
+    Anything without the binary header is tried as XML (JUCE's
+    copyXmlToBinary wrapper or plain text) holding either the
+    AudioProcessorValueTreeState tree (<PARAM id value/> children) or the
+    parameters as attributes of the root element, which is what hand-written
+    templates and the usual JUCE state code produce.
+
+    A binary restore parses the data in place and allocates nothing; it only
+    stores into the parameters' atomics (skipping values that didn't change),
+    so the audio thread picks the new state up at its next block and never
+    waits on a lock.
+*/
+class ParameterState
+{
+public:
+    static constexpr uint16_t currentVersion = 1;
+
+    /** Indexes every parameter of the state's processor; call once all parameters exist. */
+    explicit ParameterState(juce::AudioProcessorValueTreeState& state);
+
+    void write(juce::MemoryBlock& destData) const;
+
+    /** Binary or XML; returns false (and changes nothing) if the data is neither. */
+    bool read(const void* data, int sizeInBytes);
+
+    /** The state as an XML element with one attribute per parameter, for the fallback format. */
+    std::unique_ptr<juce::XmlElement> createXml() const;
+
+    /** Restores count little-endian { ID hash, value } pairs laid out with the given
+        strides (interleaved as in a state, or as two arrays as in a PresetBank file)
+        and resets every parameter they don't mention. Allocates nothing. */
+    void applyEntries(const uint8_t* hashData, size_t hashStride, const uint8_t* valueData, size_t valueStride,
+                      size_t count);
+
+    /** The parameters in the order the binary formats store them (by ID hash),
+        with values in the parameters' own units. */
+    size_t getNumParameters() const { return entries.size(); }
+    uint32_t getHash(size_t index) const { return entries[index].hash; }
+    float getValue(size_t index) const;
+    float getDefaultValue(size_t index) const;
+
+    static uint32_t hashParameterID(const juce::String& parameterID);
+
+private:
+    struct Entry
+    {
+        uint32_t hash;
+        juce::RangedAudioParameter* parameter;
+    };
+
+    juce::AudioProcessorValueTreeState& valueTreeState;
+    std::vector<Entry> entries;  // Sorted by hash
+    std::vector<uint8_t> restored; // Per entry, reused by every read
+
+    const Entry* findEntry(uint32_t hash) const;
+    bool readBinary(const uint8_t* data, size_t size);
+    bool readXml(const juce::XmlElement& xml);
+    void setValue(size_t entryIndex, float value);
+    void resetUnrestored();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterState)
+};
@@ -6,18 +6,18 @@ JuceSimpleGainReductionAudioProcessorEditor::JuceSimpleGainReductionAudioProcess
     : AudioProcessorEditor(&p), audioProcessor(p)
 {
     // Set plugin window size.
-    setSize(600, 300);
+    setSize(600, 540);
 
-    // Lambda to initialize interactive sliders.
-    auto initSlider = [this](juce::Slider& s, juce::Label& label,
-        const juce::String& labelText, double minVal, double maxVal, double defaultVal)
+    auto& state = audioProcessor.getValueTreeState();
+
+    // Lambda to initialize interactive sliders; range and value come from the attached parameter.
+    auto initSlider = [this, &state](juce::Slider& s, juce::Label& label,
+        const juce::String& labelText, const char* parameterID)
         {
             s.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
             s.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
             s.setLookAndFeel(&knobLnf);
-            s.setRange(minVal, maxVal, 0.01);
-            s.setValue(defaultVal);
-            s.addListener(this);
+            sliderAttachments.push_back(std::make_unique<SliderAttachment>(state, parameterID, s));
             addAndMakeVisible(s);
 
             label.setText(labelText, juce::dontSendNotification);
@@ -38,18 +38,104 @@ JuceSimpleGainReductionAudioProcessorEditor::JuceSimpleGainReductionAudioProcess
     addAndMakeVisible(gainReductionLabel);
 
     // Initialize the other interactive sliders.
-    initSlider(thresholdDBSlider, thresholdDBLabel, "Threshold (dB)", -60.0, 0.0, -24.0);
-    initSlider(ratioSlider, ratioLabel, "Ratio", 1.0, 20.0, 4.0);
-    initSlider(attackMsSlider, attackMsLabel, "Attack (ms)", 1.0, 100.0, 10.0);
-    initSlider(releaseMsSlider, releaseMsLabel, "Release (ms)", 10.0, 500.0, 100.0);
-    initSlider(makeupGainSlider, makeupGainLabel, "Makeup Gain", 0.0, 24.0, 0.0);
-    initSlider(keyFilterFreqSlider, keyFilterFreqLabel, "KeyFilterFreq", 20.0, 20000.0, 1000.0);
-
-    // Add the vertical meter component.
+    initSlider(thresholdDBSlider, thresholdDBLabel, "Threshold (dB)", ParamIDs::threshold);
+    initSlider(ratioSlider, ratioLabel, "Ratio", ParamIDs::ratio);
+    initSlider(kneeDBSlider, kneeDBLabel, "Knee (dB)", ParamIDs::knee);
+    initSlider(attackMsSlider, attackMsLabel, "Attack (ms)", ParamIDs::attack);
+    initSlider(releaseMsSlider, releaseMsLabel, "Release (ms)", ParamIDs::release);
+    initSlider(makeupGainSlider, makeupGainLabel, "Makeup Gain", ParamIDs::makeup);
+    initSlider(keyFilterFreqSlider, keyFilterFreqLabel, "KeyFilterFreq", ParamIDs::keyFilterFreq);
+    initSlider(stereoLinkSlider, stereoLinkLabel, "Stereo Link (%)", ParamIDs::stereoLink);
+    initSlider(lookaheadSlider, lookaheadLabel, "Lookahead (ms)", ParamIDs::lookahead);
+
+    // Lambda to initialize the mode selectors from a choice parameter's item list.
+    auto initComboBox = [this, &state](juce::ComboBox& box, juce::Label& label,
+        const juce::String& labelText, const char* parameterID)
+        {
+            if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(state.getParameter(parameterID)))
+                box.addItemList(choice->choices, 1);
+
+            comboBoxAttachments.push_back(std::make_unique<ComboBoxAttachment>(state, parameterID, box));
+            addAndMakeVisible(box);
+
+            label.setText(labelText, juce::dontSendNotification);
+            label.setJustificationType(juce::Justification::centredRight);
+            addAndMakeVisible(label);
+        };
+
+    initComboBox(stereoLinkModeBox, stereoLinkModeLabel, "Stereo", ParamIDs::stereoLinkMode);
+    initComboBox(keyFilterModeBox, keyFilterModeLabel, "Key Filter", ParamIDs::keyFilterMode);
+    initComboBox(sidechainSourceBox, sidechainSourceLabel, "Detector", ParamIDs::sidechainSource);
+    initComboBox(oversamplingBox, oversamplingLabel, "Oversampling", ParamIDs::oversampling);
+    initComboBox(oversamplingModeBox, oversamplingModeLabel, "OS Mode", ParamIDs::oversamplingMode);
+    initComboBox(bandsBox, bandsLabel, "Multiband", ParamIDs::bands);
+    initComboBox(linkGroupsBox, linkGroupsLabel, "Link", ParamIDs::linkGroups);
+    initComboBox(curvePrecisionBox, curvePrecisionLabel, "Curve", ParamIDs::curvePrecision);
+    initComboBox(detectorModeBox, detectorModeLabel, "Level", ParamIDs::detectorMode);
+
+    // The RMS window sits in the detector strip as a small horizontal slider.
+    rmsWindowSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    rmsWindowSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 48, 20);
+    sliderAttachments.push_back(std::make_unique<SliderAttachment>(state, ParamIDs::rmsWindow, rmsWindowSlider));
+    addAndMakeVisible(rmsWindowSlider);
+    rmsWindowLabel.setText("RMS (ms)", juce::dontSendNotification);
+    rmsWindowLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(rmsWindowLabel);
+
+    // Programs: picking one recalls it; saving adds the current settings as a new user preset.
+    programBox.onChange = [this]
+        {
+            const int index = programBox.getSelectedItemIndex();
+            if (index < 0)
+                return;
+
+            audioProcessor.setCurrentProgram(index);
+            audioProcessor.updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+            shownProgram = index;
+        };
+    addAndMakeVisible(programBox);
+    programLabel.setText("Preset", juce::dontSendNotification);
+    programLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(programLabel);
+
+    savePresetButton.onClick = [this]
+        {
+            if (audioProcessor.saveUserPreset("Preset " + juce::String(audioProcessor.getNumPrograms() + 1)) < 0)
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Preset not saved",
+                                                       "The user preset bank couldn't be written:\n"
+                                                           + PresetBank::getDefaultUserBankFile().getFullPathName(),
+                                                       {}, this);
+            refreshPrograms();
+        };
+    addAndMakeVisible(savePresetButton);
+    refreshPrograms();
+
+    multithreadingAttachment = std::make_unique<ButtonAttachment>(state, ParamIDs::multithreading, multithreadingButton);
+    addAndMakeVisible(multithreadingButton);
+
+    controlRateGainAttachment = std::make_unique<ButtonAttachment>(state, ParamIDs::controlRateGain, controlRateGainButton);
+    controlRateGainButton.setTooltip("Curve and gain smoothing every 8-32 samples, interpolated in between");
+    addAndMakeVisible(controlRateGainButton);
+
+    // Add the vertical meter and the history view.
     addAndMakeVisible(verticalMeter);
+    addAndMakeVisible(historyView);
 
-    // Start the timer to update the meter (30 Hz).
-    startTimerHz(30);
+    if (RealtimeMonitor::isEnabled)
+    {
+        loadButton.setTooltip("Callback load of this instance; click to copy the full report");
+        loadButton.onClick = [this]
+            {
+                juce::SystemClipboard::copyTextToClipboard(audioProcessor.getRealtimeMonitor().createReportText());
+            };
+        addAndMakeVisible(loadButton);
+    }
+
+    // Discard frames queued while the editor was closed; meterRefresh takes over from the next frame.
+    MeterFrame staleFrames;
+    audioProcessor.getMeterChannel().drain(staleFrames);
+    audioProcessor.getHistoryChannel().discardPending();
+    lastMeterUpdateMs = juce::Time::getMillisecondCounterHiRes();
 }
 
 JuceSimpleGainReductionAudioProcessorEditor::~JuceSimpleGainReductionAudioProcessorEditor()
@@ -61,7 +147,10 @@ JuceSimpleGainReductionAudioProcessorEditor::~JuceSimpleGainReductionAudioProces
     attackMsSlider.setLookAndFeel(nullptr);
     releaseMsSlider.setLookAndFeel(nullptr);
     makeupGainSlider.setLookAndFeel(nullptr);
+    kneeDBSlider.setLookAndFeel(nullptr);
     keyFilterFreqSlider.setLookAndFeel(nullptr);
+    stereoLinkSlider.setLookAndFeel(nullptr);
+    lookaheadSlider.setLookAndFeel(nullptr);
     gainReductionSlider.setLookAndFeel(nullptr); // already cleared above
 }
 
@@ -72,17 +161,66 @@ void JuceSimpleGainReductionAudioProcessorEditor::paint(juce::Graphics& g)
 
 void JuceSimpleGainReductionAudioProcessorEditor::resized()
 {
-    // Layout: 2 rows of knobs and a meter on the right.
+    // Layout: 2 rows of knobs, a meter on the right, the history and five strips of selectors at the bottom.
     auto area = getLocalBounds().reduced(10);
 
+    // Bottom strips: label + combo box pairs, three slots per strip.
+    auto programStrip = area.removeFromBottom(24);
+    area.removeFromBottom(6);
+    auto detectorStrip = area.removeFromBottom(24);
+    area.removeFromBottom(6);
+    auto channelStrip = area.removeFromBottom(24);
+    area.removeFromBottom(6);
+    auto processingStrip = area.removeFromBottom(24);
+    area.removeFromBottom(6);
+    auto modeStrip = area.removeFromBottom(24);
+    area.removeFromBottom(6);
+    historyView.setBounds(area.removeFromBottom(84));
+    loadButton.setBounds(historyView.getBounds().removeFromTop(18).removeFromRight(340).reduced(2, 1));
+    area.removeFromBottom(6);
+    {
+        const int numCombos = 3;
+        const int slotWidth = modeStrip.getWidth() / numCombos;
+
+        auto placeCombo = [&](juce::Rectangle<int>& strip, juce::ComboBox& box, juce::Label& lbl)
+            {
+                auto slot = strip.removeFromLeft(slotWidth).reduced(4, 0);
+                lbl.setBounds(slot.removeFromLeft(slot.getWidth() * 2 / 5));
+                box.setBounds(slot);
+            };
+
+        placeCombo(modeStrip, stereoLinkModeBox, stereoLinkModeLabel);
+        placeCombo(modeStrip, keyFilterModeBox, keyFilterModeLabel);
+        placeCombo(modeStrip, sidechainSourceBox, sidechainSourceLabel);
+
+        placeCombo(processingStrip, oversamplingBox, oversamplingLabel);
+        placeCombo(processingStrip, oversamplingModeBox, oversamplingModeLabel);
+        placeCombo(processingStrip, bandsBox, bandsLabel);
+
+        placeCombo(channelStrip, linkGroupsBox, linkGroupsLabel);
+        multithreadingButton.setBounds(channelStrip.removeFromLeft(slotWidth).reduced(4, 0));
+        placeCombo(channelStrip, curvePrecisionBox, curvePrecisionLabel);
+
+        placeCombo(detectorStrip, detectorModeBox, detectorModeLabel);
+        auto windowSlot = detectorStrip.removeFromLeft(slotWidth).reduced(4, 0);
+        rmsWindowLabel.setBounds(windowSlot.removeFromLeft(slotWidth * 2 / 5));
+        rmsWindowSlider.setBounds(windowSlot);
+        controlRateGainButton.setBounds(detectorStrip.removeFromLeft(slotWidth).reduced(4, 0));
+
+        auto programSlot = programStrip.removeFromLeft(slotWidth * 2).reduced(4, 0);
+        programLabel.setBounds(programSlot.removeFromLeft(slotWidth * 2 / 5));
+        programBox.setBounds(programSlot);
+        savePresetButton.setBounds(programStrip.removeFromLeft(slotWidth).reduced(4, 0));
+    }
+
     // Reserve a vertical strip on the right for the meter.
     auto meterWidth = 60;
     auto meterArea = area.removeFromRight(meterWidth);
     verticalMeter.setBounds(meterArea);
 
-    // Top row: 4 knobs (GainReduction meter, Threshold, Ratio, Attack).
+    // Top row: 5 knobs (GainReduction meter, Threshold, Ratio, Knee, Attack).
     auto topRow = area.removeFromTop(area.getHeight() * 0.5f);
-    auto knobWidth = topRow.getWidth() / 4;
+    auto knobWidth = topRow.getWidth() / 5;
 
     auto placeKnob = [&](juce::Slider& s, juce::Label& lbl, juce::Rectangle<int> r)
         {
@@ -101,12 +239,15 @@ void JuceSimpleGainReductionAudioProcessorEditor::resized()
         auto r3 = topRow.removeFromLeft(knobWidth);
         placeKnob(ratioSlider, ratioLabel, r3);
 
-        auto r4 = topRow; // Remaining area.
-        placeKnob(attackMsSlider, attackMsLabel, r4);
+        auto r4 = topRow.removeFromLeft(knobWidth);
+        placeKnob(kneeDBSlider, kneeDBLabel, r4);
+
+        auto r5 = topRow; // Remaining area.
+        placeKnob(attackMsSlider, attackMsLabel, r5);
     }
 
-    // Bottom row: 3 knobs (Release, Makeup Gain, Key Filter).
-    auto knobWidthBottom = area.getWidth() / 3;
+    // Bottom row: 5 knobs (Release, Makeup Gain, Key Filter, Stereo Link, Lookahead).
+    auto knobWidthBottom = area.getWidth() / 5;
     {
         auto r1 = area.removeFromLeft(knobWidthBottom);
         placeKnob(releaseMsSlider, releaseMsLabel, r1);
@@ -114,31 +255,73 @@ void JuceSimpleGainReductionAudioProcessorEditor::resized()
         auto r2 = area.removeFromLeft(knobWidthBottom);
         placeKnob(makeupGainSlider, makeupGainLabel, r2);
 
-        auto r3 = area;  // Remaining area.
+        auto r3 = area.removeFromLeft(knobWidthBottom);
         placeKnob(keyFilterFreqSlider, keyFilterFreqLabel, r3);
+
+        auto r4 = area.removeFromLeft(knobWidthBottom);
+        placeKnob(stereoLinkSlider, stereoLinkLabel, r4);
+
+        auto r5 = area;  // Remaining area.
+        placeKnob(lookaheadSlider, lookaheadLabel, r5);
     }
 }
 
-void JuceSimpleGainReductionAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
+void JuceSimpleGainReductionAudioProcessorEditor::refreshMeters()
+{
+    // Drain every block the audio thread pushed since the last frame; no new frames means silence.
+    MeterFrame frame;
+    audioProcessor.getMeterChannel().drain(frame);
+
+    const double nowMs = juce::Time::getMillisecondCounterHiRes();
+    const float elapsedSeconds = static_cast<float>((nowMs - lastMeterUpdateMs) * 0.001);
+    lastMeterUpdateMs = nowMs;
+
+    verticalMeter.update(frame.gainReductionDB, elapsedSeconds);
+    historyView.update(audioProcessor.getHistoryChannel());
+}
+void JuceSimpleGainReductionAudioProcessorEditor::refreshLoad()
 {
-    // Only process changes from interactive sliders.
-    if (slider == &thresholdDBSlider)
-        audioProcessor.setThresholdDB((float)slider->getValue());
-    else if (slider == &ratioSlider)
-        audioProcessor.setRatio((float)slider->getValue());
-    else if (slider == &attackMsSlider)
-        audioProcessor.setAttackMs((float)slider->getValue());
-    else if (slider == &releaseMsSlider)
-        audioProcessor.setReleaseMs((float)slider->getValue());
-    else if (slider == &makeupGainSlider)
-        audioProcessor.setMakeupGain((float)slider->getValue());
-    else if (slider == &keyFilterFreqSlider)
-        audioProcessor.setKeyFilterFreq((float)slider->getValue());
+    // A few times a second is plenty for text, and keeps the report's bin scan off most frames.
+    if (!RealtimeMonitor::isEnabled || --loadRefreshCountdown > 0)
+        return;
+
+    loadRefreshCountdown = 15;
+
+    const auto report = audioProcessor.getRealtimeMonitor().getReport();
+    auto percent = [](float load) { return juce::String(load * 100.0f, 1); };
+
+    juce::String text;
+    text << "DSP " << percent(report.minLoad) << " / " << percent(report.averageLoad) << " / "
+         << percent(report.p99Load) << " / " << percent(report.maxLoad) << " %";
+
+    if (report.allocations > 0 || report.blockingLocks > 0)
+        text << "  alloc " << static_cast<juce::int64>(report.allocations)
+             << ", locks " << static_cast<juce::int64>(report.blockingLocks);
+
+    loadButton.setButtonText(text);
+    loadButton.setColour(juce::TextButton::textColourOffId,
+                         report.allocations > 0 || report.blockingLocks > 0 ? juce::Colours::red : juce::Colours::white);
 }
 
-void JuceSimpleGainReductionAudioProcessorEditor::timerCallback()
+void JuceSimpleGainReductionAudioProcessorEditor::refreshPrograms()
 {
-    // Update the meter based on the processors computed gain reduction (in dB).
-    float grDb = audioProcessor.getGainReduction();
-    verticalMeter.setGainReduction(grDb);
+    const int numPrograms = audioProcessor.getNumPrograms();
+    const int program = audioProcessor.getCurrentProgram();
+
+    if (numPrograms != shownNumPrograms)
+    {
+        programBox.clear(juce::dontSendNotification);
+
+        for (int i = 0; i < numPrograms; ++i)
+            programBox.addItem(audioProcessor.getProgramName(i), i + 1);
+
+        shownNumPrograms = numPrograms;
+        shownProgram = -1;
+    }
+
+    if (program != shownProgram)
+    {
+        programBox.setSelectedItemIndex(program, juce::dontSendNotification);
+        shownProgram = program;
+    }
 }
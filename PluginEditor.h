@@ -4,11 +4,10 @@
 #include "PluginProcessor.h"
 #include "KnobLookAndFeel.h"
 #include "VerticalMeter.h"
+#include "GainHistoryView.h"
 
 class JuceSimpleGainReductionAudioProcessorEditor
-    : public juce::AudioProcessorEditor,
-    private juce::Slider::Listener,
-    private juce::Timer
+    : public juce::AudioProcessorEditor
 {
 public:
     JuceSimpleGainReductionAudioProcessorEditor(JuceSimpleGainReductionAudioProcessor&);
@@ -23,20 +22,67 @@ private:
     // Sliders + Labels
     juce::Slider gainReductionSlider, thresholdDBSlider, ratioSlider;
     juce::Slider attackMsSlider, releaseMsSlider, makeupGainSlider;
-    juce::Slider keyFilterFreqSlider;
+    juce::Slider kneeDBSlider, keyFilterFreqSlider, stereoLinkSlider;
+    juce::Slider lookaheadSlider;
 
     juce::Label gainReductionLabel, thresholdDBLabel, ratioLabel;
     juce::Label attackMsLabel, releaseMsLabel, makeupGainLabel;
-    juce::Label keyFilterFreqLabel;
+    juce::Label kneeDBLabel, keyFilterFreqLabel, stereoLinkLabel;
+    juce::Label lookaheadLabel;
 
-    // The custom meter
+    // Mode selectors along the bottom strip
+    juce::ComboBox stereoLinkModeBox, keyFilterModeBox, sidechainSourceBox;
+    juce::Label stereoLinkModeLabel, keyFilterModeLabel, sidechainSourceLabel;
+    juce::ComboBox oversamplingBox, oversamplingModeBox, bandsBox;
+    juce::Label oversamplingLabel, oversamplingModeLabel, bandsLabel;
+    juce::ComboBox linkGroupsBox, curvePrecisionBox;
+    juce::Label linkGroupsLabel, curvePrecisionLabel;
+    juce::ToggleButton multithreadingButton{ "Multithreading" };
+    juce::ToggleButton controlRateGainButton{ "Control-Rate Gain" };
+    juce::ComboBox detectorModeBox;
+    juce::Label detectorModeLabel;
+    juce::Slider rmsWindowSlider;
+    juce::Label rmsWindowLabel;
+
+    // Program selector and its save button along the last strip
+    juce::ComboBox programBox;
+    juce::Label programLabel;
+    juce::TextButton savePresetButton{ "Save As New" };
+    int shownProgram = -1;
+    int shownNumPrograms = -1;
+
+    // Parameter attachments (declared after the controls so they're destroyed first)
+    using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+    using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
+    using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
+    std::vector<std::unique_ptr<SliderAttachment>> sliderAttachments;
+    std::vector<std::unique_ptr<ComboBoxAttachment>> comboBoxAttachments;
+    std::unique_ptr<ButtonAttachment> multithreadingAttachment;
+    std::unique_ptr<ButtonAttachment> controlRateGainAttachment;
+
+    // The custom meter and the scrolling history under the controls
     VerticalMeter verticalMeter;
+    GainHistoryView historyView;
+
+    // Callback load over the history view, in instrumented builds only; clicking copies the full report.
+    juce::TextButton loadButton;
+    int loadRefreshCountdown = 0;
+    void refreshLoad();
 
     // The custom knob look+feel
     KnobLookAndFeel knobLnf;
 
-    void sliderValueChanged(juce::Slider* slider) override;
-    void timerCallback() override;
+    // Drains the meter channel and feeds every meter; called once per display frame.
+    void refreshMeters();
+
+    // Follows program changes made by the host or by saving; called once per display frame.
+    void refreshPrograms();
+
+    // Time of the previous meter tick, for the ballistics
+    double lastMeterUpdateMs = 0.0;
+
+    // The single vblank-synced refresh for all meters (declared last so it detaches first).
+    juce::VBlankAttachment meterRefresh{ this, [this] { refreshMeters(); refreshPrograms(); refreshLoad(); } };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JuceSimpleGainReductionAudioProcessorEditor)
 };
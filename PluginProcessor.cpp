@@ -1,5 +1,102 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "CompressorKernels.h"
+
+namespace
+{
+    // Peak and RMS over the first numChannels channels of a block.
+    template <typename SampleType>
+    void measureLevels(const juce::AudioBuffer<SampleType>& buffer, int numChannels, float& peak, float& rms)
+    {
+        const int numSamples = buffer.getNumSamples();
+        float power = 0.0f;
+        peak = 0.0f;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            peak = juce::jmax(peak, static_cast<float>(buffer.getMagnitude(channel, 0, numSamples)));
+            const float channelRms = static_cast<float>(buffer.getRMSLevel(channel, 0, numSamples));
+            power += channelRms * channelRms;
+        }
+
+        rms = numChannels > 0 ? std::sqrt(power / static_cast<float>(numChannels)) : 0.0f;
+    }
+
+    // True if the first numChannels channels of a block are all exactly zero.
+    template <typename SampleType>
+    bool isSilent(const juce::AudioBuffer<SampleType>& buffer, int numChannels)
+    {
+        if (buffer.hasBeenCleared())
+            return true;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            if (buffer.getMagnitude(channel, 0, buffer.getNumSamples()) > SampleType(0))
+                return false;
+
+        return true;
+    }
+
+    // Copies a channel of float or double audio into a float detector channel.
+    template <typename SampleType>
+    void copyToDetector(juce::AudioBuffer<float>& detector, int channel, const juce::AudioBuffer<SampleType>& source,
+                        int sourceChannel, int start, int numSamples)
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            detector.copyFrom(channel, 0, source, sourceChannel, start, numSamples);
+        }
+        else
+        {
+            const auto* input = source.getReadPointer(sourceChannel, start);
+            std::transform(input, input + numSamples, detector.getWritePointer(channel),
+                           [](SampleType sample) { return static_cast<float>(sample); });
+        }
+    }
+
+    // Multiplies float or double audio by a float gain signal.
+    template <typename SampleType>
+    void multiplyByGain(SampleType* data, const float* gain, int numSamples)
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            juce::FloatVectorOperations::multiply(data, gain, numSamples);
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+                data[i] *= static_cast<SampleType>(gain[i]);
+        }
+    }
+
+    // The speaker mirrored across the median plane (Ls for Rs, ...), or unknown for
+    // centre, LFE, ambisonic and discrete channels, which have no partner.
+    juce::AudioChannelSet::ChannelType getMirroredChannel(juce::AudioChannelSet::ChannelType type)
+    {
+        using Set = juce::AudioChannelSet;
+
+        static constexpr Set::ChannelType pairs[][2] = {
+            { Set::left, Set::right },
+            { Set::leftSurround, Set::rightSurround },
+            { Set::leftCentre, Set::rightCentre },
+            { Set::leftSurroundSide, Set::rightSurroundSide },
+            { Set::leftSurroundRear, Set::rightSurroundRear },
+            { Set::wideLeft, Set::wideRight },
+            { Set::topFrontLeft, Set::topFrontRight },
+            { Set::topRearLeft, Set::topRearRight },
+            { Set::topSideLeft, Set::topSideRight }
+        };
+
+        for (const auto& pair : pairs)
+        {
+            if (type == pair[0])
+                return pair[1];
+            if (type == pair[1])
+                return pair[0];
+        }
+
+        return Set::unknown;
+    }
+}
 
 //==============================================================================
 JuceSimpleGainReductionAudioProcessor::JuceSimpleGainReductionAudioProcessor()
@@ -8,16 +105,147 @@ JuceSimpleGainReductionAudioProcessor::JuceSimpleGainReductionAudioProcessor()
 #if ! JucePlugin_IsMidiEffect
 #if ! JucePlugin_IsSynth
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
+        .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)
 #endif
         .withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
-    )
+    ),
+#else
+    :
 #endif
+      parameters(*this, nullptr, "Parameters", createParameterLayout())
 {
+    thresholdParam = parameters.getRawParameterValue(ParamIDs::threshold);
+    ratioParam = parameters.getRawParameterValue(ParamIDs::ratio);
+    attackParam = parameters.getRawParameterValue(ParamIDs::attack);
+    releaseParam = parameters.getRawParameterValue(ParamIDs::release);
+    makeupParam = parameters.getRawParameterValue(ParamIDs::makeup);
+    kneeParam = parameters.getRawParameterValue(ParamIDs::knee);
+    keyFilterFreqParam = parameters.getRawParameterValue(ParamIDs::keyFilterFreq);
+    keyFilterModeParam = parameters.getRawParameterValue(ParamIDs::keyFilterMode);
+    sidechainSourceParam = parameters.getRawParameterValue(ParamIDs::sidechainSource);
+    stereoLinkModeParam = parameters.getRawParameterValue(ParamIDs::stereoLinkMode);
+    stereoLinkParam = parameters.getRawParameterValue(ParamIDs::stereoLink);
+    linkGroupsParam = parameters.getRawParameterValue(ParamIDs::linkGroups);
+    multithreadingParam = parameters.getRawParameterValue(ParamIDs::multithreading);
+    curvePrecisionParam = parameters.getRawParameterValue(ParamIDs::curvePrecision);
+    controlRateGainParam = parameters.getRawParameterValue(ParamIDs::controlRateGain);
+    detectorModeParam = parameters.getRawParameterValue(ParamIDs::detectorMode);
+    rmsWindowParam = parameters.getRawParameterValue(ParamIDs::rmsWindow);
+    lookaheadParam = parameters.getRawParameterValue(ParamIDs::lookahead);
+    oversamplingParam = parameters.getRawParameterValue(ParamIDs::oversampling);
+    oversamplingModeParam = parameters.getRawParameterValue(ParamIDs::oversamplingMode);
+    bandsParam = parameters.getRawParameterValue(ParamIDs::bands);
+
+    for (size_t k = 0; k < crossoverParams.size(); ++k)
+        crossoverParams[k] = parameters.getRawParameterValue(ParamIDs::crossovers[k]);
+
+    for (int band = 0; band < MultibandCompressor::maxBands; ++band)
+    {
+        auto& pointers = bandParams[static_cast<size_t>(band)];
+        pointers.threshold = parameters.getRawParameterValue(ParamIDs::bandParameter(band, ParamIDs::threshold));
+        pointers.ratio = parameters.getRawParameterValue(ParamIDs::bandParameter(band, ParamIDs::ratio));
+        pointers.knee = parameters.getRawParameterValue(ParamIDs::bandParameter(band, ParamIDs::knee));
+        pointers.attack = parameters.getRawParameterValue(ParamIDs::bandParameter(band, ParamIDs::attack));
+        pointers.release = parameters.getRawParameterValue(ParamIDs::bandParameter(band, ParamIDs::release));
+        pointers.makeup = parameters.getRawParameterValue(ParamIDs::bandParameter(band, ParamIDs::makeup));
+    }
+
+    parameters.addParameterListener(ParamIDs::multithreading, this);
+    parameters.addParameterListener(ParamIDs::curvePrecision, this);
 }
 
 JuceSimpleGainReductionAudioProcessor::~JuceSimpleGainReductionAudioProcessor()
 {
+    parameters.removeParameterListener(ParamIDs::multithreading, this);
+    parameters.removeParameterListener(ParamIDs::curvePrecision, this);
+    cancelPendingUpdate();
+    tableThread->removeTimeSliceClient(this);
+    workerPool.stop();
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout JuceSimpleGainReductionAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    auto addFloat = [&layout](const juce::String& id, const juce::String& name, juce::NormalisableRange<float> range,
+                              float defaultValue, const juce::String& label)
+        {
+            layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{ id, 1 }, name, range, defaultValue,
+                juce::AudioParameterFloatAttributes().withLabel(label)));
+        };
+
+    juce::NormalisableRange<float> keyFilterRange(20.0f, 20000.0f, 0.01f);
+    keyFilterRange.setSkewForCentre(1000.0f);
+
+    addFloat(ParamIDs::threshold, "Threshold", { -60.0f, 0.0f, 0.01f }, -24.0f, "dB");
+    addFloat(ParamIDs::ratio, "Ratio", { 1.0f, 20.0f, 0.01f }, 4.0f, ":1");
+    addFloat(ParamIDs::attack, "Attack", { 1.0f, 100.0f, 0.01f }, 10.0f, "ms");
+    addFloat(ParamIDs::release, "Release", { 10.0f, 500.0f, 0.01f }, 100.0f, "ms");
+    addFloat(ParamIDs::makeup, "Makeup Gain", { 0.0f, 24.0f, 0.01f }, 0.0f, "dB");
+    addFloat(ParamIDs::knee, "Knee", { 0.0f, 24.0f, 0.01f }, 0.0f, "dB");
+    addFloat(ParamIDs::keyFilterFreq, "Key Filter Freq", keyFilterRange, 1000.0f, "Hz");
+    addFloat(ParamIDs::stereoLink, "Stereo Link", { 0.0f, 100.0f, 0.01f }, 100.0f, "%");
+    addFloat(ParamIDs::lookahead, "Lookahead", { 0.0f, maxLookaheadMs, 0.01f }, 0.0f, "ms");
+    addFloat(ParamIDs::rmsWindow, "RMS Window", { 1.0f, maxRmsWindowMs, 0.01f }, 10.0f, "ms");
+
+    // Item order matches StereoLinkMode.
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ ParamIDs::stereoLinkMode, 1 },
+        "Stereo Link Mode", juce::StringArray{ "Unlinked", "Link: Max", "Link: Average" }, 0));
+
+    // Item order matches LinkGroups.
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ ParamIDs::linkGroups, 1 },
+        "Link Groups", juce::StringArray{ "Whole Bus", "Speaker Pairs" }, 1));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ ParamIDs::multithreading, 1 },
+        "Multithreading", false));
+
+    // Item order matches GainComputer::Precision.
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ ParamIDs::curvePrecision, 1 },
+        "Curve Precision", juce::StringArray{ "Precise", "Fast" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ ParamIDs::controlRateGain, 1 },
+        "Control-Rate Gain", false));
+
+    // Item order matches LevelDetector::Mode.
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ ParamIDs::detectorMode, 1 },
+        "Detector Mode", juce::StringArray{ "Peak", "RMS", "True Peak", "Program Dependent" }, 0));
+
+    // Item order matches KeyFilter::Mode.
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ ParamIDs::keyFilterMode, 1 },
+        "Key Filter", juce::StringArray{ "Off", "High-Pass", "Band-Pass" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ ParamIDs::sidechainSource, 1 },
+        "Sidechain", juce::StringArray{ "Internal", "External" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ ParamIDs::oversampling, 1 },
+        "Oversampling", juce::StringArray{ "Off", "2x", "4x" }, 0));
+
+    // Item order matches OversamplingMode.
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ ParamIDs::oversamplingMode, 1 },
+        "Oversampling Mode", juce::StringArray{ "Full Signal", "Gain Only" }, 0));
+
+    // Multiband: the band count, the crossovers between adjacent bands (only the
+    // first bands - 1 are used) and a full set of compressor controls per band.
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ ParamIDs::bands, 1 },
+        "Bands", juce::StringArray{ "Off", "3 Bands", "4 Bands", "5 Bands" }, 0));
+
+    const float crossoverDefaults[] = { 120.0f, 1000.0f, 4000.0f, 10000.0f };
+    for (int k = 0; k < MultibandCompressor::maxBands - 1; ++k)
+        addFloat(ParamIDs::crossovers[k], "Crossover " + juce::String(k + 1), keyFilterRange, crossoverDefaults[k], "Hz");
+
+    for (int band = 0; band < MultibandCompressor::maxBands; ++band)
+    {
+        const auto prefix = "Band " + juce::String(band + 1) + " ";
+        addFloat(ParamIDs::bandParameter(band, ParamIDs::threshold), prefix + "Threshold", { -60.0f, 0.0f, 0.01f }, -24.0f, "dB");
+        addFloat(ParamIDs::bandParameter(band, ParamIDs::ratio), prefix + "Ratio", { 1.0f, 20.0f, 0.01f }, 4.0f, ":1");
+        addFloat(ParamIDs::bandParameter(band, ParamIDs::knee), prefix + "Knee", { 0.0f, 24.0f, 0.01f }, 0.0f, "dB");
+        addFloat(ParamIDs::bandParameter(band, ParamIDs::attack), prefix + "Attack", { 1.0f, 100.0f, 0.01f }, 10.0f, "ms");
+        addFloat(ParamIDs::bandParameter(band, ParamIDs::release), prefix + "Release", { 10.0f, 500.0f, 0.01f }, 100.0f, "ms");
+        addFloat(ParamIDs::bandParameter(band, ParamIDs::makeup), prefix + "Makeup Gain", { 0.0f, 24.0f, 0.01f }, 0.0f, "dB");
+    }
+
+    return layout;
 }
 
 //==============================================================================
@@ -55,47 +283,157 @@ bool JuceSimpleGainReductionAudioProcessor::isMidiEffect() const
 
 double JuceSimpleGainReductionAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // Delayed audio keeps coming out for the lookahead/oversampling latency after the input stops;
+    // after that, silence in is silence out. This is the only idle state a JUCE 8 processor can
+    // report: the wrappers own the per-buffer silence flags and give processBlock no way to set them.
+    return sampleRate > 0.0 ? getLatencySamples() / sampleRate : 0.0;
 }
 
 int JuceSimpleGainReductionAudioProcessor::getNumPrograms()
 {
-    return 1;
+    return presetBank.getNumPresets();
 }
 
 int JuceSimpleGainReductionAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load();
+}
+
+void JuceSimpleGainReductionAudioProcessor::setCurrentProgram(int index)
+{
+    if (index < 0 || index >= presetBank.getNumPresets())
+        return;
+
+    // Odd while the parameters hold part of the old program and part of the new one.
+    const uint32_t sequence = programSequence.load(std::memory_order_relaxed);
+    programSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    presetBank.recall(index);
+
+    {
+        const RealtimeMonitor::SpinLock::ScopedLockType lock(programLock);
+        readParameters(pendingParameters);
+        pendingProgram = true;
+    }
+
+    programSequence.store(sequence + 2, std::memory_order_release);
+    currentProgram = index;
 }
 
-void JuceSimpleGainReductionAudioProcessor::setCurrentProgram(int /*index*/)
+const juce::String JuceSimpleGainReductionAudioProcessor::getProgramName(int index)
 {
+    return presetBank.getName(index);
 }
 
-const juce::String JuceSimpleGainReductionAudioProcessor::getProgramName(int /*index*/)
+void JuceSimpleGainReductionAudioProcessor::changeProgramName(int index, const juce::String& newName)
 {
-    return {};
+    // Factory presets keep their names.
+    presetBank.renameUserPreset(index, newName);
 }
 
-void JuceSimpleGainReductionAudioProcessor::changeProgramName(int /*index*/, const juce::String& /*newName*/)
+int JuceSimpleGainReductionAudioProcessor::saveUserPreset(const juce::String& name)
 {
+    const int index = presetBank.addUserPreset(name);
+    if (index < 0)
+        return -1;
+
+    currentProgram = index;
+    updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+    return index;
 }
 
 //==============================================================================
-void JuceSimpleGainReductionAudioProcessor::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
+void JuceSimpleGainReductionAudioProcessor::prepareToPlay(double newSampleRate, int samplesPerBlock)
 {
     sampleRate = newSampleRate;
+    historyChannel.prepare(newSampleRate);
+    realtimeMonitor.prepare(newSampleRate);
+
+    // Start from the parameters as they are now, which include any program still pending.
+    {
+        const RealtimeMonitor::SpinLock::ScopedLockType lock(programLock);
+        pendingProgram = false;
+    }
+    readParameters(blockParameters);
+    const auto& params = blockParameters;
+    programFade = ProgramFade::idle;
+    programFadeGain = 1.0f;
+    silentSamples = 0;
+
+    auto numChannels = getMainBusNumInputChannels();
+
+    // Scratch for the block passes; larger host blocks are processed in chunks.
+    // The envelope/gain passes may run oversampled, so theirs hold the 4x length.
+    auto scratchSize = juce::jmax(samplesPerBlock, 1);
+    detectorScratch.setSize(juce::jmax(numChannels, 1), scratchSize);
+    keyFilter.reset();
+
+    // Every channel of the host's buffer, for double blocks run in float. Sized whatever the
+    // current precision: a host may send double blocks without preparing in double first.
+    floatCopy.setSize(juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels(), 1), scratchSize);
+
+    // Room for the longest lookahead at this rate; the current one is reported as latency.
+    // It starts at its time right away; later changes crossfade over a program fade's length.
+    lookahead.prepare(numChannels, static_cast<int>(std::ceil(maxLookaheadMs * 0.001 * newSampleRate)),
+                      juce::roundToInt(programFadeMs * 0.001 * newSampleRate));
+    updateLookahead(params.lookaheadMs);
+    lookahead.reset();
+
+    oversampledAudio.setSize(juce::jmax(numChannels, 1), scratchSize * Oversampler::maxFactor);
+    oversampledDetector.setSize(juce::jmax(numChannels, 1), scratchSize * Oversampler::maxFactor);
+    audioOversampler.prepare(numChannels, scratchSize);
+    detectorOversampler.prepare(numChannels, scratchSize);
+    audioOversampler.reset();
+    detectorOversampler.reset();
+    updateOversampling(params.oversamplingFactor);
+    updateLatency();
+    setLatencySamples(reportedLatency.load()); // Here rather than later: hosts read it after prepareToPlay
+
+    // The detectors run at the processing rate: RMS windows up to the longest at 4x.
+    const int maxRmsWindow = static_cast<int>(std::ceil(maxRmsWindowMs * 0.001 * newSampleRate * Oversampler::maxFactor));
+    broadband.prepare(numChannels, scratchSize * Oversampler::maxFactor, maxRmsWindow);
+
+    multiband.prepare(numChannels, scratchSize * Oversampler::maxFactor, maxRmsWindow);
+    multiband.setSampleRate(newSampleRate * audioOversampler.getFactor());
+    multiband.reset();
+
+    mainLayout = getChannelLayoutOfBus(true, 0);
+    independentGroups = ChannelGroups::independent(numChannels);
+    currentLinkGroups = -1;
+    updateChannelGroups(params.linkGroups);
+
+    // Only buses with more than a stereo pair have enough groups to be worth a pool.
+    preparedChannels.store(numChannels);
+    if (numChannels <= 2)
+        workerPool.stop();
+    updateWorkerPool();
+
+    updateTableThread();
+
+    // Parameter ramps: 20 ms, starting from the current values.
+    auto resetSmoother = [newSampleRate](auto& smoother, float value)
+        {
+            smoother.reset(newSampleRate, 0.02);
+            smoother.setCurrentAndTargetValue(value);
+        };
+
+    resetSmoother(thresholdSmoothed, params.thresholdDB);
+    resetSmoother(ratioSmoothed, params.ratio);
+    resetSmoother(kneeSmoothed, params.kneeDB);
+    resetSmoother(stereoLinkSmoothed, params.stereoLink);
+    resetSmoother(makeupGainSmoothed, juce::Decibels::decibelsToGain(params.makeupDB));
 
-    // Initialize per-channel state.
-    auto numChannels = getTotalNumInputChannels();
-    smoothedGain.clear();
-    smoothedGain.resize(numChannels, 1.0f);
-    envelope.clear();
-    envelope.resize(numChannels, 0.0f);
+    broadband.setSampleRate(newSampleRate * audioOversampler.getFactor());
+    broadband.setTimes(params.attackMs, params.releaseMs);
+    broadband.setCurve(params.thresholdDB, params.ratio, params.kneeDB);
 }
 
 void JuceSimpleGainReductionAudioProcessor::releaseResources()
 {
+    preparedChannels.store(0);
+    workerPool.stop();
+    updateTableThread();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -105,13 +443,22 @@ bool JuceSimpleGainReductionAudioProcessor::isBusesLayoutSupported(const BusesLa
     juce::ignoreUnused(layouts);
     return true;
 #else
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() &&
-        layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any main layout up to the channel limit of the link groups.
+    const auto mainSet = layouts.getMainOutputChannelSet();
+    if (mainSet.isDisabled() || mainSet.size() > ChannelGroups::maxChannels)
         return false;
 
 #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The sidechain is optional; its channels feed the detectors in turn (a mono one feeds all).
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechainSet = layouts.getChannelSet(true, 1);
+        if (sidechainSet.size() > ChannelGroups::maxChannels)
+            return false;
+    }
 #endif
 
     return true;
@@ -119,8 +466,337 @@ bool JuceSimpleGainReductionAudioProcessor::isBusesLayoutSupported(const BusesLa
 }
 #endif
 
+void JuceSimpleGainReductionAudioProcessor::updateWorkerPool()
+{
+    if (preparedChannels.load() > 2 && multithreadingParam->load() > 0.5f)
+        workerPool.start(WorkerPool::getDefaultNumWorkers());
+}
+
+void JuceSimpleGainReductionAudioProcessor::parameterChanged(const juce::String&, float)
+{
+    // May arrive on the audio thread (host automation): starting threads waits for the message thread.
+    triggerAsyncUpdate();
+}
+
+void JuceSimpleGainReductionAudioProcessor::handleAsyncUpdate()
+{
+    updateWorkerPool();
+    updateTableThread();
+
+    const int latency = reportedLatency.load();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+void JuceSimpleGainReductionAudioProcessor::updateTableThread()
+{
+    const bool fast = static_cast<GainComputer::Precision>(juce::roundToInt(curvePrecisionParam->load()))
+                   == GainComputer::Precision::fast;
+
+    if (preparedChannels.load() == 0 || !fast)
+    {
+        tableThread->removeTimeSliceClient(this);
+        return;
+    }
+
+    if (!tableThread->isThreadRunning())
+        tableThread->startThread(juce::Thread::Priority::low);
+
+    tableThread->addTimeSliceClient(this); // Wakes the thread; does nothing if already a client
+}
+
+void JuceSimpleGainReductionAudioProcessor::updateLookahead(float lookaheadMs)
+{
+    lookahead.setLookahead(juce::roundToInt(lookaheadMs * 0.001 * sampleRate));
+}
+
+void JuceSimpleGainReductionAudioProcessor::updateOversampling(int factor)
+{
+    if (factor == audioOversampler.getFactor())
+        return;
+
+    // Both paths switch together; the filters start from silence at the new rate.
+    audioOversampler.setFactor(factor);
+    detectorOversampler.setFactor(factor);
+}
+
+void JuceSimpleGainReductionAudioProcessor::updateLatency()
+{
+    // The host hears about it on the message thread (handleAsyncUpdate): setLatencySamples()
+    // notifies its listeners synchronously, and VST3 hosts expect that off the audio thread.
+    const int latency = lookahead.getLookahead() + audioOversampler.getLatencySamples();
+    if (reportedLatency.exchange(latency) != latency)
+        triggerAsyncUpdate();
+}
+
+void JuceSimpleGainReductionAudioProcessor::updateMultiband(float link)
+{
+    // Band controls are picked up once per block; the gain smoothing covers the steps.
+    const auto& params = blockParameters;
+    multiband.setSampleRate(sampleRate * audioOversampler.getFactor());
+    multiband.setNumBands(params.numBands);
+    multiband.setCrossoverFrequencies(params.crossovers.data());
+
+    for (int band = 0; band < params.numBands; ++band)
+        multiband.setBandParameters(band, params.bands[static_cast<size_t>(band)]);
+
+    const auto mode = params.stereoLinkMode;
+    multiband.setStereoLink(mode == StereoLinkMode::off ? 0.0f : link, mode == StereoLinkMode::max);
+}
+
+void JuceSimpleGainReductionAudioProcessor::readParameters(BlockParameters& destination) const
+{
+    auto& p = destination;
+    p.thresholdDB = thresholdParam->load();
+    p.ratio = ratioParam->load();
+    p.kneeDB = kneeParam->load();
+    p.attackMs = attackParam->load();
+    p.releaseMs = releaseParam->load();
+    p.makeupDB = makeupParam->load();
+    p.keyFilterFreq = keyFilterFreqParam->load();
+    p.stereoLink = stereoLinkParam->load() / 100.0f;
+    p.lookaheadMs = lookaheadParam->load();
+    p.rmsWindowMs = rmsWindowParam->load();
+    p.keyFilterMode = static_cast<KeyFilter::Mode>(juce::roundToInt(keyFilterModeParam->load()));
+    p.useSidechain = sidechainSourceParam->load() > 0.5f;
+    p.stereoLinkMode = static_cast<StereoLinkMode>(juce::roundToInt(stereoLinkModeParam->load()));
+    p.linkGroups = juce::roundToInt(linkGroupsParam->load());
+    p.multithreading = multithreadingParam->load() > 0.5f;
+    p.precision = static_cast<GainComputer::Precision>(juce::roundToInt(curvePrecisionParam->load()));
+    p.controlRateGain = controlRateGainParam->load() > 0.5f;
+    p.detectorMode = static_cast<LevelDetector::Mode>(juce::roundToInt(detectorModeParam->load()));
+    p.oversamplingFactor = 1 << juce::roundToInt(oversamplingParam->load());
+    p.oversamplingMode = static_cast<OversamplingMode>(juce::roundToInt(oversamplingModeParam->load()));
+
+    const int bandsIndex = juce::roundToInt(bandsParam->load());
+    p.numBands = bandsIndex > 0 ? bandsIndex + MultibandCompressor::minBands - 1 : 0;
+
+    for (size_t k = 0; k < crossoverParams.size(); ++k)
+        p.crossovers[k] = crossoverParams[k]->load();
+
+    for (size_t band = 0; band < bandParams.size(); ++band)
+    {
+        const auto& pointers = bandParams[band];
+        auto& bandParameters = p.bands[band];
+        bandParameters.thresholdDB = pointers.threshold->load();
+        bandParameters.ratio = pointers.ratio->load();
+        bandParameters.kneeDB = pointers.knee->load();
+        bandParameters.attackMs = pointers.attack->load();
+        bandParameters.releaseMs = pointers.release->load();
+        bandParameters.makeupDB = pointers.makeup->load();
+    }
+}
+
+void JuceSimpleGainReductionAudioProcessor::updateBlockParameters()
+{
+    // setCurrentProgram() holds the lock only while it copies a program in; try again next block.
+    const RealtimeMonitor::SpinLock::ScopedTryLockType lock(programLock);
+    if (!lock.isLocked())
+        return;
+
+    // The old program plays on to the bottom of its fade; then the latest program takes over.
+    if (programFade == ProgramFade::fadingOut)
+    {
+        if (programFadeGain > 0.0f)
+            return;
+
+        if (pendingProgram)
+        {
+            incomingParameters = pendingParameters;
+            pendingProgram = false;
+        }
+
+        blockParameters = incomingParameters;
+        resetDynamics();
+        programFade = ProgramFade::fadingIn;
+        return;
+    }
+
+    if (pendingProgram)
+    {
+        incomingParameters = pendingParameters;
+        pendingProgram = false;
+
+        if (needsProgramFade(blockParameters, incomingParameters))
+            programFade = ProgramFade::fadingOut;
+        else
+            blockParameters = incomingParameters;
+
+        return;
+    }
+
+    // Automation and the editor: keep the last set if a program is being stored meanwhile.
+    const uint32_t sequence = programSequence.load(std::memory_order_acquire);
+    if ((sequence & 1) != 0)
+        return;
+
+    readParameters(incomingParameters);
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (programSequence.load(std::memory_order_relaxed) == sequence)
+        blockParameters = incomingParameters;
+}
+
+bool JuceSimpleGainReductionAudioProcessor::needsProgramFade(const BlockParameters& from, const BlockParameters& to)
+{
+    // Changes that reset filters, move the delay or restart the detectors click when they
+    // land mid-signal; everything else ramps through the smoothers.
+    return from.oversamplingFactor != to.oversamplingFactor || from.oversamplingMode != to.oversamplingMode
+        || from.numBands != to.numBands || from.lookaheadMs != to.lookaheadMs
+        || from.detectorMode != to.detectorMode || from.useSidechain != to.useSidechain
+        || from.keyFilterMode != to.keyFilterMode;
+}
+
+void JuceSimpleGainReductionAudioProcessor::resetDynamics()
+{
+    // At the bottom of a program fade: the new program starts at its own values, from silence.
+    const auto& params = blockParameters;
+    thresholdSmoothed.setCurrentAndTargetValue(params.thresholdDB);
+    ratioSmoothed.setCurrentAndTargetValue(params.ratio);
+    kneeSmoothed.setCurrentAndTargetValue(params.kneeDB);
+    stereoLinkSmoothed.setCurrentAndTargetValue(params.stereoLink);
+    makeupGainSmoothed.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(params.makeupDB));
+
+    broadband.reset();
+    updateLookahead(params.lookaheadMs); // Straight to the new time: the output is silent here
+    lookahead.reset();
+    keyFilter.reset();
+    audioOversampler.reset();
+    detectorOversampler.reset();
+    multiband.reset();
+}
+
+template <typename SampleType>
+void JuceSimpleGainReductionAudioProcessor::applyProgramFade(juce::AudioBuffer<SampleType>& buffer, int numChannels)
+{
+    const float step = 1.0f / (programFadeMs * 0.001f * static_cast<float>(sampleRate));
+    const float slope = programFade == ProgramFade::fadingOut ? -step : step;
+    const int numSamples = buffer.getNumSamples();
+    const float startGain = programFadeGain;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* data = buffer.getWritePointer(channel);
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] *= juce::jlimit(0.0f, 1.0f, startGain + slope * static_cast<float>(i + 1));
+    }
+
+    programFadeGain = juce::jlimit(0.0f, 1.0f, startGain + slope * static_cast<float>(numSamples));
+
+    if (programFade == ProgramFade::fadingIn && programFadeGain >= 1.0f)
+        programFade = ProgramFade::idle;
+}
+
+void JuceSimpleGainReductionAudioProcessor::updateChannelGroups(int linkGroups)
+{
+    if (linkGroups == currentLinkGroups)
+        return;
+
+    // Rebuilt from the layout cached in prepareToPlay; nothing here allocates.
+    const int numChannels = juce::jmin(mainLayout.size(), ChannelGroups::maxChannels);
+    currentLinkGroups = linkGroups;
+
+    // A stereo pair stays linked whatever its channels are called.
+    if (static_cast<LinkGroups>(linkGroups) == LinkGroups::wholeBus || numChannels <= 2)
+    {
+        channelGroups = ChannelGroups::wholeBus(numChannels);
+        return;
+    }
+
+    bool grouped[ChannelGroups::maxChannels] = {};
+    channelGroups.clear();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if (grouped[channel])
+            continue;
+
+        channelGroups.beginGroup();
+        channelGroups.addChannel(channel);
+        grouped[channel] = true;
+
+        const auto mirrored = getMirroredChannel(mainLayout.getTypeOfChannel(channel));
+        const int partner = mirrored != juce::AudioChannelSet::unknown ? mainLayout.getChannelIndexForType(mirrored) : -1;
+
+        if (partner > channel && partner < numChannels && !grouped[partner])
+        {
+            channelGroups.addChannel(partner);
+            grouped[partner] = true;
+        }
+    }
+}
+
+int JuceSimpleGainReductionAudioProcessor::useTimeSlice()
+{
+    // Check back soon after a build, as a ramp may still be moving the curve.
+    const bool builtBroadband = broadband.buildTables();
+    const bool builtBands = multiband.buildTables();
+    return builtBroadband || builtBands ? 5 : 20;
+}
+
+bool JuceSimpleGainReductionAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 void JuceSimpleGainReductionAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
+    const RealtimeMonitor::ScopedCallback monitored(realtimeMonitor, buffer.getNumSamples());
+
+    // One atomic read per parameter per block, as one consistent set.
+    updateBlockParameters();
+    processSamples(buffer);
+}
+
+void JuceSimpleGainReductionAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& /*midiMessages*/)
+{
+    const RealtimeMonitor::ScopedCallback monitored(realtimeMonitor, buffer.getNumSamples());
+    updateBlockParameters();
+    const auto& params = blockParameters;
+
+    // Everything but the band split and full-signal oversampling keeps the audio in double.
+    const bool filtersAudio = params.numBands > 0
+                           || (params.oversamplingFactor > 1 && params.oversamplingMode == OversamplingMode::fullSignal);
+    if (!filtersAudio)
+    {
+        processSamples(buffer);
+        return;
+    }
+
+    const int numChannels = juce::jmin(buffer.getNumChannels(), floatCopy.getNumChannels());
+    const int numSamples = buffer.getNumSamples();
+
+    for (int start = 0; start < numSamples;)
+    {
+        const int length = juce::jmin(floatCopy.getNumSamples(), numSamples - start);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* input = buffer.getReadPointer(channel, start);
+            std::transform(input, input + length, floatCopy.getWritePointer(channel),
+                           [](double sample) { return static_cast<float>(sample); });
+        }
+
+        juce::AudioBuffer<float> piece(floatCopy.getArrayOfWritePointers(), numChannels, 0, length);
+        processSamples(piece);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* output = floatCopy.getReadPointer(channel);
+            std::copy(output, output + length, buffer.getWritePointer(channel, start));
+        }
+
+        start += length;
+    }
+}
+
+template <typename SampleType>
+void JuceSimpleGainReductionAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer)
+{
+    // The dynamics always run in float; double audio only ever meets a float gain curve.
+    constexpr bool floatAudio = std::is_same_v<SampleType, float>;
+
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -129,139 +805,330 @@ void JuceSimpleGainReductionAudioProcessor::processBlock(juce::AudioBuffer<float
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    float attackTimeSec = attackMs / 1000.0f;
-    float releaseTimeSec = releaseMs / 1000.0f;
+    // Only the main bus is compressed; the sidechain bus (if any) only feeds the detector.
+    auto numMainChannels = juce::jmin(getMainBusNumInputChannels(), detectorScratch.getNumChannels());
+    auto* sidechainBus = getBusCount(true) > 1 ? getBus(true, 1) : nullptr;
+    const bool hasSidechain = sidechainBus != nullptr && sidechainBus->isEnabled();
+    auto sidechainBuffer = getBusBuffer(buffer, true, hasSidechain ? 1 : 0); // Main bus stands in, unused, when absent
+
+    jassert(detectorScratch.getNumSamples() > 0); // prepareToPlay() must run first.
+    if (detectorScratch.getNumSamples() == 0)
+        return;
+
+    const auto& params = blockParameters;
+    const bool useSidechain = hasSidechain && params.useSidechain && sidechainBuffer.getNumChannels() > 0;
+
+    thresholdSmoothed.setTargetValue(params.thresholdDB);
+    ratioSmoothed.setTargetValue(params.ratio);
+    kneeSmoothed.setTargetValue(params.kneeDB);
+    stereoLinkSmoothed.setTargetValue(params.stereoLink);
+    makeupGainSmoothed.setTargetValue(juce::Decibels::decibelsToGain(params.makeupDB));
+    const auto linkMode = params.stereoLinkMode;
+    updateChannelGroups(params.linkGroups);
+    const bool multithreading = params.multithreading;
+    broadband.setPrecision(params.precision);
+    keyFilter.setParameters(params.keyFilterMode, params.keyFilterFreq, sampleRate);
+    updateLookahead(params.lookaheadMs);
+    updateOversampling(params.oversamplingFactor);
+    updateLatency();
+    const int factor = audioOversampler.getFactor();
+
+    // Envelope and gain smoothing run at the oversampled rate.
+    broadband.setSampleRate(sampleRate * factor);
+    broadband.setTimes(params.attackMs, params.releaseMs);
+    broadband.setControlRateGain(params.controlRateGain);
+
+    const auto detectorMode = params.detectorMode;
+    const int rmsWindow = juce::roundToInt(params.rmsWindowMs * 0.001 * sampleRate * factor);
+    broadband.setDetector(detectorMode, rmsWindow);
+
+    // Multiband splits the audio itself, so it always oversamples the full signal.
+    const int numBands = params.numBands;
+    const bool useMultiband = floatAudio && numBands > 0;
+    const auto oversamplingMode = !floatAudio ? OversamplingMode::gainOnly
+                                : useMultiband ? OversamplingMode::fullSignal : params.oversamplingMode;
+    if (useMultiband)
+    {
+        updateMultiband(stereoLinkSmoothed.getTargetValue());
+        multiband.setPrecision(params.precision);
+        multiband.setDetector(detectorMode, rmsWindow);
+    }
+
+    const int numSamples = buffer.getNumSamples();
+
+    // Silence: once the input has been silent long enough to flush every delay line, filter
+    // history and RMS window, and the dynamics have settled below the curve, the output is
+    // silent too. The block is left as it is; only the envelopes' decay is accounted for.
+    const bool silentInput = isSilent(buffer, numMainChannels)
+                          && (!useSidechain || isSilent(sidechainBuffer, sidechainBuffer.getNumChannels()));
+    const int flushSamples = juce::roundToInt((maxLookaheadMs + maxRmsWindowMs) * 0.001 * sampleRate)
+                           + audioOversampler.getLatencySamples() + silenceGuardSamples;
+    const bool settled = silentSamples >= flushSamples && programFade == ProgramFade::idle
+                      && !thresholdSmoothed.isSmoothing() && !ratioSmoothed.isSmoothing()
+                      && !kneeSmoothed.isSmoothing() && !stereoLinkSmoothed.isSmoothing()
+                      && !makeupGainSmoothed.isSmoothing();
 
-    float envAttackCoeff = std::exp(-1.0f / (attackTimeSec * static_cast<float>(sampleRate)));
-    float envReleaseCoeff = std::exp(-1.0f / (releaseTimeSec * static_cast<float>(sampleRate)));
+    silentSamples = silentInput ? juce::jmin(silentSamples + numSamples, maxSilentSamples) : 0;
+
+    if (silentInput && settled && isSettled(useMultiband))
+    {
+        skipSilence(numSamples * factor, useMultiband);
+        meterChannel.push(MeterFrame{});
+        historyChannel.push(MeterFrame{}, numSamples);
+        return;
+    }
+
+    MeterFrame meterFrame;
+    measureLevels(buffer, numMainChannels, meterFrame.inputPeak, meterFrame.inputRms);
 
-    float makeupGainLinear = juce::Decibels::decibelsToGain(makeupGain);
     float maxReductionDB = 0.0f;
+    const int maxChunk = detectorScratch.getNumSamples();
 
-    if (smoothedGain.size() < static_cast<size_t>(totalNumInputChannels))
-        smoothedGain.resize(totalNumInputChannels, 1.0f);
-    if (envelope.size() < static_cast<size_t>(totalNumInputChannels))
-        envelope.resize(totalNumInputChannels, 0.0f);
+    // Unlinked, every channel is a group of its own.
+    const auto& groups = linkMode == StereoLinkMode::off ? independentGroups : channelGroups;
+    float groupReductionDB[ChannelGroups::maxChannels] = {};
 
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    // The detector reads the main input directly unless it has to be filtered, replaced by the
+    // sidechain or windowed for lookahead (the main input is delayed in place then). The
+    // multiband split needs the raw detector, and a peak window would skew the RMS mean,
+    // so there lookahead only delays the audio (the detector still runs ahead of it).
+    const bool useLookahead = lookahead.getLookahead() > 0;
+    const bool windowDetector = !useMultiband && detectorMode != LevelDetector::Mode::rms;
+    const bool useDetectorScratch = !floatAudio || useSidechain || useLookahead
+                                 || keyFilter.getMode() != KeyFilter::Mode::off;
+    const float* detector[KeyFilter::maxChannels] = {};
+
+    // Walk the block in scratch-sized chunks, or in short steps while a ramp is running.
+    for (int start = 0; start < numSamples;)
     {
-        auto* channelData = buffer.getWritePointer(channel);
+        const bool ramping = thresholdSmoothed.isSmoothing() || ratioSmoothed.isSmoothing()
+                          || kneeSmoothed.isSmoothing() || stereoLinkSmoothed.isSmoothing()
+                          || makeupGainSmoothed.isSmoothing();
+        const int chunk = juce::jmin(ramping ? juce::jmin(smoothingStepSamples, maxChunk) : maxChunk, numSamples - start);
+
+        broadband.setCurve(thresholdSmoothed.skip(chunk), ratioSmoothed.skip(chunk), kneeSmoothed.skip(chunk));
+        const float link = stereoLinkSmoothed.skip(chunk);
+        const float makeupStart = makeupGainSmoothed.getCurrentValue();
+        const float makeupEnd = makeupGainSmoothed.skip(chunk);
+        const auto groupKernel = BroadbandCompressor::getGroupKernel(linkMode,
+                                                                     CompressorKernels::getMakeup(makeupStart, makeupEnd));
 
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        for (int channel = 0; channel < numMainChannels; ++channel)
         {
-            float inSample = channelData[sample];
-            float inputAbs = std::abs(inSample);
+            if constexpr (floatAudio)
+            {
+                if (!useDetectorScratch)
+                {
+                    detector[channel] = buffer.getReadPointer(channel, start);
+                    continue;
+                }
+            }
 
-            if (inputAbs > envelope[channel])
-                envelope[channel] = envAttackCoeff * envelope[channel] + (1.0f - envAttackCoeff) * inputAbs;
+            // Sidechain channels feed the detectors in turn; a mono sidechain feeds every detector.
+            if (useSidechain)
+                copyToDetector(detectorScratch, channel, sidechainBuffer,
+                               channel % sidechainBuffer.getNumChannels(), start, chunk);
             else
-                envelope[channel] = envReleaseCoeff * envelope[channel] + (1.0f - envReleaseCoeff) * inputAbs;
+                copyToDetector(detectorScratch, channel, buffer, channel, start, chunk);
+
+            detector[channel] = detectorScratch.getReadPointer(channel);
+        }
+
+        if (useDetectorScratch)
+            keyFilter.process(detectorScratch.getArrayOfWritePointers(), numMainChannels, chunk);
+
+        // The delay lines record even without lookahead, so switching it on doesn't replay old audio.
+        for (int channel = 0; channel < numMainChannels; ++channel)
+        {
+            if (useLookahead && windowDetector)
+                lookahead.processDetector(channel, detectorScratch.getWritePointer(channel), chunk);
 
-            float levelDB = juce::Decibels::gainToDecibels(envelope[channel], -100.0f);
+            lookahead.processAudio(channel, buffer.getWritePointer(channel, start), chunk);
+        }
+
+        // The compressor works on `target` at `processed` samples: the main buffer itself,
+        // the upsampled audio, or (gain only, and always for double audio) a unity signal
+        // at the processing rate that comes out of the passes as the gain curve.
+        float* target[KeyFilter::maxChannels] = {};
+        const int processed = chunk * factor;
 
-            float desiredReductionDB = 0.0f;
-            if (kneeDB > 0.0f)
+        for (int channel = 0; channel < numMainChannels; ++channel)
+        {
+            if constexpr (floatAudio)
             {
-                if (levelDB < thresholdDB - kneeDB * 0.5f)
-                {
-                    desiredReductionDB = 0.0f;
-                }
-                else if (levelDB > thresholdDB + kneeDB * 0.5f)
+                if (factor == 1)
                 {
-                    desiredReductionDB = (levelDB - thresholdDB) * (1.0f - 1.0f / ratio);
+                    target[channel] = buffer.getWritePointer(channel, start);
+                    continue;
                 }
+            }
+
+            target[channel] = oversampledAudio.getWritePointer(channel);
+
+            if constexpr (floatAudio)
+            {
+                if (oversamplingMode == OversamplingMode::fullSignal)
+                    audioOversampler.upsample(channel, buffer.getReadPointer(channel, start), target[channel], chunk);
                 else
-                {
-                    float delta = levelDB - (thresholdDB - kneeDB * 0.5f);
-                    desiredReductionDB = (1.0f - 1.0f / ratio) * (delta * delta) / (2.0f * kneeDB);
-                }
+                    juce::FloatVectorOperations::fill(target[channel], 1.0f, processed);
             }
             else
             {
-                if (levelDB > thresholdDB)
-                    desiredReductionDB = (levelDB - thresholdDB) * (1.0f - 1.0f / ratio);
+                juce::FloatVectorOperations::fill(target[channel], 1.0f, processed);
             }
 
-            float desiredGainDB = -desiredReductionDB;
-            float desiredGain = juce::Decibels::decibelsToGain(desiredGainDB);
+            if (factor == 1)
+                continue;
+
+            // Without a detector scratch the detector is the (now upsampled) audio itself.
+            if (!useDetectorScratch && oversamplingMode == OversamplingMode::fullSignal)
+            {
+                detector[channel] = target[channel];
+                continue;
+            }
+
+            detectorOversampler.upsample(channel, detector[channel], oversampledDetector.getWritePointer(channel), chunk);
+            detector[channel] = oversampledDetector.getReadPointer(channel);
+        }
+
+        // Compress group by group: on the worker pool when the chunk is large enough to
+        // pay for the fork/join, on this thread otherwise.
+        auto compressGroup = [&](int group)
+            {
+                groupReductionDB[group] = useMultiband
+                    ? multiband.processGroup(target, useDetectorScratch ? detector : nullptr, groups, group, processed)
+                    : (broadband.*groupKernel)(target, detector, groups, group, processed, link, makeupStart, makeupEnd);
+            };
+
+        const int work = processed * numMainChannels * (useMultiband ? numBands : 1);
+        if (multithreading && groups.numGroups > 1 && work >= minParallelWork)
+            workerPool.run(groups.numGroups, compressGroup);
+        else
+            for (int group = 0; group < groups.numGroups; ++group)
+                compressGroup(group);
 
-            float gainCoeff = (desiredGain < smoothedGain[channel])
-                ? std::exp(-1.0f / (attackTimeSec * static_cast<float>(sampleRate)))
-                : std::exp(-1.0f / (releaseTimeSec * static_cast<float>(sampleRate)));
-            smoothedGain[channel] = desiredGain + (smoothedGain[channel] - desiredGain) * gainCoeff;
+        for (int group = 0; group < groups.numGroups; ++group)
+            maxReductionDB = juce::jmax(maxReductionDB, groupReductionDB[group]);
 
-            float outSample = inSample * smoothedGain[channel] * makeupGainLinear;
-            channelData[sample] = outSample;
+        if (useMultiband)
+        {
+            // The bands carry their own makeup; the main makeup trims the sum.
+            multiband.finishBlock();
 
-            if (desiredReductionDB > maxReductionDB)
-                maxReductionDB = desiredReductionDB;
+            for (int channel = 0; channel < numMainChannels; ++channel)
+                CompressorKernels::applyGainRamp(target[channel], processed, makeupStart, makeupEnd);
         }
+
+        if (factor > 1 || !floatAudio)
+        {
+            for (int channel = 0; channel < numMainChannels; ++channel)
+            {
+                auto* data = buffer.getWritePointer(channel, start);
+
+                if constexpr (floatAudio)
+                {
+                    if (oversamplingMode == OversamplingMode::fullSignal)
+                    {
+                        audioOversampler.downsample(channel, target[channel], data, chunk);
+                        continue;
+                    }
+                }
+
+                if (factor == 1)
+                {
+                    multiplyByGain(data, target[channel], chunk);
+                    continue;
+                }
+
+                // Band-limit the gain back to the base rate (the detector scratch is free
+                // again) and apply it to audio delayed by the same round trip.
+                auto* gain = detectorScratch.getWritePointer(channel);
+                detectorOversampler.downsample(channel, target[channel], gain, chunk);
+                detectorOversampler.compensate(channel, data, chunk);
+                multiplyByGain(data, gain, chunk);
+            }
+        }
+
+        start += chunk;
     }
 
-    gainReduction = maxReductionDB;
+    // Around a program change that restarts the dynamics.
+    if (programFade != ProgramFade::idle)
+        applyProgramFade(buffer, numMainChannels);
+
+    meterFrame.gainReductionDB = maxReductionDB;
+    measureLevels(buffer, numMainChannels, meterFrame.outputPeak, meterFrame.outputRms);
+    meterChannel.push(meterFrame);
+    historyChannel.push(meterFrame, numSamples);
 }
 
-//==============================================================================
-bool JuceSimpleGainReductionAudioProcessor::hasEditor() const
+bool JuceSimpleGainReductionAudioProcessor::isSettled(bool useMultiband) const
 {
-    return true;
+    return useMultiband ? multiband.isSettled() : broadband.isSettled();
 }
 
-juce::AudioProcessorEditor* JuceSimpleGainReductionAudioProcessor::createEditor()
+void JuceSimpleGainReductionAudioProcessor::skipSilence(int numProcessedSamples, bool useMultiband)
 {
-    return new JuceSimpleGainReductionAudioProcessorEditor(*this);
+    // Zero in, zero out: the delays, filters and gains stay as they are; the envelopes decay.
+    if (useMultiband)
+        multiband.skipSilence(numProcessedSamples);
+    else
+        broadband.skipSilence(numProcessedSamples);
 }
 
 //==============================================================================
-void JuceSimpleGainReductionAudioProcessor::getStateInformation(juce::MemoryBlock& /*destData*/)
+bool JuceSimpleGainReductionAudioProcessor::hasEditor() const
 {
-    // Save the plugin's state (parameters) here.
+    return true;
 }
 
-void JuceSimpleGainReductionAudioProcessor::setStateInformation(const void* /*data*/, int /*sizeInBytes*/)
+juce::AudioProcessorEditor* JuceSimpleGainReductionAudioProcessor::createEditor()
 {
-    // Restore the plugin's state (parameters) here.
+    return new JuceSimpleGainReductionAudioProcessorEditor(*this);
 }
 
 //==============================================================================
-void JuceSimpleGainReductionAudioProcessor::setThresholdDB(float newThresholdDB)
+void JuceSimpleGainReductionAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    thresholdDB = newThresholdDB;
+    parameterState.write(destData);
 }
 
-void JuceSimpleGainReductionAudioProcessor::setRatio(float newRatio)
+void JuceSimpleGainReductionAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    ratio = newRatio;
+    // Only the parameters' atomics change; processBlock picks them up (and ramps them) at its next block.
+    parameterState.read(data, sizeInBytes);
 }
 
-void JuceSimpleGainReductionAudioProcessor::setAttackMs(float newAttackMs)
+//==============================================================================
+juce::AudioProcessorValueTreeState& JuceSimpleGainReductionAudioProcessor::getValueTreeState()
 {
-    attackMs = newAttackMs;
+    return parameters;
 }
 
-void JuceSimpleGainReductionAudioProcessor::setReleaseMs(float newReleaseMs)
+MeterChannel& JuceSimpleGainReductionAudioProcessor::getMeterChannel()
 {
-    releaseMs = newReleaseMs;
+    return meterChannel;
 }
 
-void JuceSimpleGainReductionAudioProcessor::setMakeupGain(float newMakeupGain)
+HistoryChannel& JuceSimpleGainReductionAudioProcessor::getHistoryChannel()
 {
-    makeupGain = newMakeupGain;
+    return historyChannel;
 }
 
-void JuceSimpleGainReductionAudioProcessor::setKneeDB(float newKneeDB)
+RealtimeMonitor& JuceSimpleGainReductionAudioProcessor::getRealtimeMonitor()
 {
-    kneeDB = newKneeDB;
+    return realtimeMonitor;
 }
 
-void JuceSimpleGainReductionAudioProcessor::setKeyFilterFreq(float newKeyFilterFreq)
+void JuceSimpleGainReductionAudioProcessor::setGainComputerIsa(GainComputer::Isa isa)
 {
-    keyFilterFreq = newKeyFilterFreq;
+    broadband.setIsa(isa);
+    multiband.setIsa(isa);
 }
 
-double& JuceSimpleGainReductionAudioProcessor::getGainReduction()
+GainComputer::Isa JuceSimpleGainReductionAudioProcessor::getGainComputerIsa() const
 {
-    return gainReduction;
+    return broadband.getIsa();
 }
 
 //==============================================================================
@@ -1,15 +1,133 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BroadbandCompressor.h"
+#include "GainComputer.h"
+#include "MeterChannel.h"
+#include "KeyFilter.h"
+#include "LevelDetector.h"
+#include "Lookahead.h"
+#include "Oversampler.h"
+#include "MultibandCompressor.h"
+#include "ParameterState.h"
+#include "PresetBank.h"
+#include "ChannelGroups.h"
+#include "WorkerPool.h"
+#include "RealtimeMonitor.h"
+
+// Parameter IDs shared by the processor and the editor attachments.
+namespace ParamIDs
+{
+    inline constexpr const char* threshold = "threshold";
+    inline constexpr const char* ratio = "ratio";
+    inline constexpr const char* attack = "attack";
+    inline constexpr const char* release = "release";
+    inline constexpr const char* makeup = "makeup";
+    inline constexpr const char* knee = "knee";
+    inline constexpr const char* keyFilterFreq = "keyFilterFreq";
+    inline constexpr const char* keyFilterMode = "keyFilterMode";
+    inline constexpr const char* sidechainSource = "sidechainSource";
+    inline constexpr const char* stereoLinkMode = "stereoLinkMode";
+    inline constexpr const char* stereoLink = "stereoLink";
+    inline constexpr const char* lookahead = "lookahead";
+    inline constexpr const char* oversampling = "oversampling";
+    inline constexpr const char* oversamplingMode = "oversamplingMode";
+    inline constexpr const char* bands = "bands";
+    inline constexpr const char* crossovers[] = { "crossover1", "crossover2", "crossover3", "crossover4" };
+    inline constexpr const char* linkGroups = "linkGroups";
+    inline constexpr const char* multithreading = "multithreading";
+    inline constexpr const char* curvePrecision = "curvePrecision";
+    inline constexpr const char* controlRateGain = "controlRateGain";
+    inline constexpr const char* detectorMode = "detectorMode";
+    inline constexpr const char* rmsWindow = "rmsWindow";
+
+    // Per-band copies of the compressor controls: bandParameter(0, threshold) == "band1_threshold".
+    inline juce::String bandParameter(int band, const char* id) { return "band" + juce::String(band + 1) + "_" + id; }
+}
 
 //==============================================================================
 /**
     This processor implements an industry?standard gain reduction (compressor)
     with envelope detection, soft knee, and separate attack/release smoothing.
+
+    Each block runs in three passes per channel: the envelope follower, the
+    vectorised static curve (GainComputer), then gain smoothing and the output
+    multiply (CompressorKernels), all in the JUCE-free BroadbandCompressor that
+    the C API (JsgrCompressor) runs as well. The detector can listen to an
+    optional external sidechain bus instead of the main input, through a
+    high-/band-pass key filter, and measures peak, RMS or true-peak level, or
+    peak level with a program-dependent release (LevelDetector).
+    With lookahead on, the audio is delayed and the detector sees the peak of
+    the window ahead of it; the delay is reported to the host as latency (from
+    the message thread), and a new lookahead time crossfades between delays.
+    Optional 2x/4x oversampling runs either the whole compressor or only the
+    gain computation at the higher rate (the latter filters the gain signal
+    back down and applies it to the time-aligned base-rate audio).
+    In multiband mode the same passes run per band of a 3-5 way Linkwitz-Riley
+    split (MultibandCompressor), each band with its own set of controls.
+
+    Any main bus of up to 16 channels is accepted. Its channels are linked in
+    groups (the whole bus, or mirrored speaker pairs such as L/R and Ls/Rs with
+    the rest independent); groups share nothing, so with multithreading on a
+    large block's groups are compressed in parallel on a small WorkerPool.
+
+    Digital silence that has flushed every delay and filter, with the dynamics
+    settled, skips whole blocks, with the envelope decay done in closed form
+    (LevelDetector::skipSilence). The host learns about it through the tail
+    length only: JUCE 8's wrappers set the VST3 output silence flags and the
+    AU OutputIsSilence render flag themselves, and AudioProcessor has no call
+    to set them from processBlock.
+
+    Hosts with a 64-bit mix engine get a double-precision processBlock, so
+    they don't convert every buffer. Both precisions run one templated block
+    (processSamples): the detector, curve and gains stay in float, and a
+    double block keeps its audio in double through the lookahead and latency
+    delays and the fade, with the gain computed as a float curve (as in
+    gain-only oversampling) and multiplied in. Multiband and full-signal
+    oversampling filter the audio itself in float, so in double they run on a
+    float copy of the block.
+
+    In fast curve mode the gain computers read their curve from lookup tables,
+    which a low-priority background thread rebuilds whenever the curve changes
+    (through this processor's TimeSliceClient). One such thread serves every
+    instance in the process, and an instance only joins it while fast mode is
+    selected.
+
+    Parameters live in an AudioProcessorValueTreeState. The audio thread only
+    reads their atomics (through cached raw pointers) once per block, and ramps
+    the continuous ones with SmoothedValue, stepping the curve in short
+    sub-blocks while a ramp is running. The session state is the parameter set
+    in ParameterState's versioned binary format (XML is accepted on restore).
+
+    The programs are PresetBank's factory and user presets. A block runs with
+    one complete set of parameter values (BlockParameters), never half of a
+    program being recalled; a program that changes the processing structure
+    (oversampling, bands, lookahead, detector, key path) fades the output out
+    for a few milliseconds, swaps with the dynamics restarted, and fades in.
 */
-class JuceSimpleGainReductionAudioProcessor : public juce::AudioProcessor
+class JuceSimpleGainReductionAudioProcessor : public juce::AudioProcessor,
+                                              private juce::TimeSliceClient,
+                                              private juce::AudioProcessorValueTreeState::Listener,
+                                              private juce::AsyncUpdater
 {
 public:
+    // How the two detectors of a stereo bus are combined: off, max or average.
+    using StereoLinkMode = BroadbandCompressor::LinkMode;
+
+    // Which channels of the main bus are linked with each other.
+    enum class LinkGroups
+    {
+        wholeBus,    // Every channel in one group
+        speakerPairs // Mirrored left/right speakers in pairs, all other channels on their own
+    };
+
+    // What runs at the oversampled rate.
+    enum class OversamplingMode
+    {
+        fullSignal, // Audio and detector go up, the compressed audio comes back down
+        gainOnly    // Only the detector goes up; the gain comes back down
+    };
+
     //==============================================================================
     JuceSimpleGainReductionAudioProcessor();
     ~JuceSimpleGainReductionAudioProcessor() override;
@@ -23,6 +141,8 @@ public:
 #endif
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -47,40 +167,241 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
-    // Parameter setters (for GUI control)
-    void setThresholdDB(float newThresholdDB);
-    void setRatio(float newRatio);
-    void setAttackMs(float newAttackMs);
-    void setReleaseMs(float newReleaseMs);
-    void setMakeupGain(float newMakeupGain);
-    void setKneeDB(float newKneeDB); // 0 = hard knee, > 0 = soft knee width in dB
-    void setKeyFilterFreq(float newKeyFilterFreq);
+    // Host-automatable parameters (the editor attaches its controls here)
+    juce::AudioProcessorValueTreeState& getValueTreeState();
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    // Getter for meter display (gain reduction in dB)
-    double& getGainReduction();
+    // Per-block levels for the editor's meters (drained on the message thread)
+    MeterChannel& getMeterChannel();
+
+    // Decimated gain reduction and levels for the editor's history view (message thread)
+    HistoryChannel& getHistoryChannel();
+
+    // Callback load and realtime violations (reports are empty unless JSGR_REALTIME_MONITOR is on)
+    RealtimeMonitor& getRealtimeMonitor();
+
+    // Adds the current settings to the user presets and makes them the current program;
+    // returns the new program index, or -1 if the bank couldn't be written. Message thread.
+    int saveUserPreset(const juce::String& name);
+
+    // Forces a gain computer kernel, e.g. the scalar reference for regression runs.
+    // Call before prepareToPlay, never while processing.
+    void setGainComputerIsa(GainComputer::Isa isa);
+    GainComputer::Isa getGainComputerIsa() const;
 
 private:
     //==============================================================================
     // Compressor parameters
-    float thresholdDB{ -24.0f };   // dB threshold for compression
-    float ratio{ 4.0f };      // Compression ratio
-    float attackMs{ 10.0f };     // Attack time in milliseconds
-    float releaseMs{ 100.0f };    // Release time in milliseconds
-    float makeupGain{ 0.0f };      // Makeup gain in dB
-    float kneeDB{ 0.0f };      // Knee width in dB (0 = hard knee)
-    float keyFilterFreq{ 1000.0f }; // (Optional) key filter frequency for sidechain
-
-    // Computed gain reduction for display (in dB)
-    double gainReduction{ 0.0 };
-
-    // Per?channel state:
-    //  smoothedGain: stores the currently applied linear gain factor (after compression/smoothing)
-    //  envelope: tracks the signals amplitude (with attack and release smoothing)
-    std::vector<float> smoothedGain;
-    std::vector<float> envelope;
+    juce::AudioProcessorValueTreeState parameters;
+
+    // Binary save/restore of every parameter (built once the parameters exist).
+    ParameterState parameterState{ parameters };
+
+    // Factory and user presets, exposed as the programs.
+    PresetBank presetBank{ parameterState, PresetBank::getDefaultUserBankFile() };
+    std::atomic<int> currentProgram{ 0 };
+
+    // Raw parameter values, cached once so the audio thread never looks them up.
+    std::atomic<float>* thresholdParam{ nullptr };    // dB threshold for compression
+    std::atomic<float>* ratioParam{ nullptr };        // Compression ratio
+    std::atomic<float>* attackParam{ nullptr };       // Attack time in milliseconds
+    std::atomic<float>* releaseParam{ nullptr };      // Release time in milliseconds
+    std::atomic<float>* makeupParam{ nullptr };       // Makeup gain in dB
+    std::atomic<float>* kneeParam{ nullptr };         // Knee width in dB (0 = hard knee)
+    std::atomic<float>* keyFilterFreqParam{ nullptr }; // (Optional) key filter frequency for sidechain
+    std::atomic<float>* keyFilterModeParam{ nullptr }; // KeyFilter::Mode index
+    std::atomic<float>* sidechainSourceParam{ nullptr }; // 0 = main input, 1 = external sidechain bus
+    std::atomic<float>* stereoLinkModeParam{ nullptr }; // StereoLinkMode index
+    std::atomic<float>* stereoLinkParam{ nullptr };   // How far each side moves towards the linked level (%)
+    std::atomic<float>* linkGroupsParam{ nullptr };   // LinkGroups index
+    std::atomic<float>* multithreadingParam{ nullptr }; // 1 = compress channel groups in parallel
+    std::atomic<float>* curvePrecisionParam{ nullptr }; // GainComputer::Precision index
+    std::atomic<float>* controlRateGainParam{ nullptr }; // 1 = curve and smoothing once per segment
+    std::atomic<float>* detectorModeParam{ nullptr }; // LevelDetector::Mode index
+    std::atomic<float>* rmsWindowParam{ nullptr };    // RMS window length in milliseconds
+    std::atomic<float>* lookaheadParam{ nullptr };    // Lookahead time in milliseconds (0 = off)
+    std::atomic<float>* oversamplingParam{ nullptr }; // 0 = off, 1 = 2x, 2 = 4x
+    std::atomic<float>* oversamplingModeParam{ nullptr }; // OversamplingMode index
+    std::atomic<float>* bandsParam{ nullptr };        // 0 = broadband, 1..3 = 3..5 bands
+    std::array<std::atomic<float>*, MultibandCompressor::maxBands - 1> crossoverParams{}; // Crossover frequencies in Hz
+
+    struct BandParameterPointers
+    {
+        std::atomic<float>* threshold{ nullptr };
+        std::atomic<float>* ratio{ nullptr };
+        std::atomic<float>* knee{ nullptr };
+        std::atomic<float>* attack{ nullptr };
+        std::atomic<float>* release{ nullptr };
+        std::atomic<float>* makeup{ nullptr };
+    };
+    std::array<BandParameterPointers, MultibandCompressor::maxBands> bandParams;
+
+    // Every parameter value one block runs with, read from the atomics in one go.
+    struct BlockParameters
+    {
+        float thresholdDB{ -24.0f };
+        float ratio{ 4.0f };
+        float kneeDB{ 0.0f };
+        float attackMs{ 10.0f };
+        float releaseMs{ 100.0f };
+        float makeupDB{ 0.0f };
+        float keyFilterFreq{ 1000.0f };
+        float stereoLink{ 1.0f };      // 0..1
+        float lookaheadMs{ 0.0f };
+        float rmsWindowMs{ 10.0f };
+        KeyFilter::Mode keyFilterMode{ KeyFilter::Mode::off };
+        bool useSidechain{ false };
+        StereoLinkMode stereoLinkMode{ StereoLinkMode::max };
+        int linkGroups{ 0 };           // LinkGroups index
+        bool multithreading{ false };
+        GainComputer::Precision precision{ GainComputer::Precision::precise };
+        bool controlRateGain{ false };
+        LevelDetector::Mode detectorMode{ LevelDetector::Mode::peak };
+        int oversamplingFactor{ 1 };
+        OversamplingMode oversamplingMode{ OversamplingMode::fullSignal };
+        int numBands{ 0 };             // 0 = broadband
+        std::array<float, MultibandCompressor::maxBands - 1> crossovers{};
+        std::array<MultibandCompressor::BandParameters, MultibandCompressor::maxBands> bands{};
+    };
+
+    void readParameters(BlockParameters& destination) const;
+
+    // Program changes. setCurrentProgram() makes programSequence odd while it stores a
+    // program into the parameters, and then hands the complete set over in pendingParameters;
+    // the audio thread keeps its last set while the sequence is odd or moves under it.
+    BlockParameters blockParameters;
+    BlockParameters incomingParameters;
+    BlockParameters pendingParameters; // Guarded by programLock
+    bool pendingProgram{ false };      // Guarded by programLock
+    RealtimeMonitor::SpinLock programLock; // Counted by the realtime monitor on the audio thread
+    std::atomic<uint32_t> programSequence{ 0 };
+
+    // Output fade around a program change that restarts the dynamics.
+    enum class ProgramFade
+    {
+        idle,
+        fadingOut, // Old program, down to silence, then the swap
+        fadingIn   // New program, back up to unity
+    };
+    ProgramFade programFade{ ProgramFade::idle };
+    float programFadeGain{ 1.0f };
+    static constexpr float programFadeMs = 5.0f;
+
+    void updateBlockParameters();
+    static bool needsProgramFade(const BlockParameters& from, const BlockParameters& to);
+    void resetDynamics();
+    template <typename SampleType>
+    void applyProgramFade(juce::AudioBuffer<SampleType>& buffer, int numChannels);
+
+    // Per-sample ramps towards the latest parameter values.
+    juce::SmoothedValue<float> thresholdSmoothed;
+    juce::SmoothedValue<float> ratioSmoothed;
+    juce::SmoothedValue<float> kneeSmoothed;
+    juce::SmoothedValue<float> stereoLinkSmoothed;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> makeupGainSmoothed;
+
+    // Gain reduction and input/output levels for display, per block and as history columns
+    MeterChannel meterChannel;
+    HistoryChannel historyChannel;
+
+    // Times every processBlock and counts allocations and blocking locks inside it.
+    RealtimeMonitor realtimeMonitor;
+
+    // Detector, curve, gain smoothing and per-channel gain state of the broadband
+    // compressor (sized for the main bus at 4x in prepareToPlay).
+    BroadbandCompressor broadband;
+    static constexpr float maxRmsWindowMs = 50.0f;
 
     // Sample rate (set in prepareToPlay)
     double sampleRate{ 44100.0 };
 
+    // Sub-block length used while a parameter ramp is in progress.
+    static constexpr int smoothingStepSamples = 32;
+
+    // Detector input when it differs from the main input (key filter on or external sidechain).
+    KeyFilter keyFilter;
+    juce::AudioBuffer<float> detectorScratch;
+
+    // Audio delay and windowed detector peak (allocated in prepareToPlay).
+    static constexpr float maxLookaheadMs = 20.0f;
+    Lookahead lookahead;
+
+    // Half-band oversampling of the main audio and of the detector/gain signal,
+    // and their buffers at the higher rate (allocated for 4x in prepareToPlay).
+    Oversampler audioOversampler;
+    Oversampler detectorOversampler;
+    juce::AudioBuffer<float> oversampledAudio;
+    juce::AudioBuffer<float> oversampledDetector;
+
+    // Band split, per-band compression and phase-coherent sum (sized for 4x in prepareToPlay).
+    MultibandCompressor multiband;
+
+    // Link groups of the main bus: per the LinkGroups setting, and one per channel
+    // for unlinked processing (both rebuilt without allocating).
+    juce::AudioChannelSet mainLayout;
+    ChannelGroups channelGroups;
+    ChannelGroups independentGroups;
+    int currentLinkGroups{ -1 };
+
+    // Groups go to the workers only with this much work (channel-samples, times the
+    // band count in multiband mode) in a chunk; smaller chunks stay on the audio thread.
+    static constexpr int minParallelWork = 8192;
+    WorkerPool workerPool;
+
+    // Main bus width while prepared (0 otherwise), for starting the pool from the message thread.
+    std::atomic<int> preparedChannels{ 0 };
+
+    // Starts the pool once multithreading is on for a bus wider than a stereo pair;
+    // message thread or prepareToPlay(). Switched off, the workers stay parked.
+    void updateWorkerPool();
+
+    // Multithreading and curve precision changes, and latency changes from the audio thread,
+    // reach the message thread through the async update.
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+
+    // Runs useTimeSlice(), which builds the fast-mode curve tables off the audio thread,
+    // for every instance in fast mode; started by the first of them, stopped with the last.
+    struct TableThread : juce::TimeSliceThread
+    {
+        TableThread() : juce::TimeSliceThread("Gain curve tables") {}
+        ~TableThread() override { stopThread(1000); }
+    };
+
+    juce::SharedResourcePointer<TableThread> tableThread;
+    int useTimeSlice() override;
+
+    // Joins the table thread while prepared in fast mode and leaves it otherwise;
+    // message thread or prepareToPlay().
+    void updateTableThread();
+
+    void updateLookahead(float lookaheadMs);
+    void updateOversampling(int factor);
+
+    // Lookahead plus oversampling latency, as last computed on the audio thread; reported
+    // to the host from prepareToPlay() and handleAsyncUpdate() only.
+    std::atomic<int> reportedLatency{ 0 };
+    void updateLatency();
+    void updateMultiband(float link);
+    void updateChannelGroups(int linkGroups);
+
+    // The block for either precision; the parameters must be read (updateBlockParameters) first.
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+
+    // Double blocks whose settings filter the audio are processed in float, in pieces
+    // of this buffer's length (allocated in every prepareToPlay, whatever the precision).
+    juce::AudioBuffer<float> floatCopy;
+
+    // The silence bypass: consecutive exactly-zero input samples (saturating), and the
+    // extra samples beyond the longest lookahead, RMS window and oversampling latency
+    // that the filter histories get to flush before a block may be skipped.
+    int silentSamples{ 0 };
+    static constexpr int maxSilentSamples = 1 << 30;
+    static constexpr int silenceGuardSamples = 64;
+
+    bool isSettled(bool useMultiband) const;
+    void skipSilence(int numProcessedSamples, bool useMultiband);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JuceSimpleGainReductionAudioProcessor)
 };
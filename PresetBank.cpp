@@ -0,0 +1,299 @@
+#include "PresetBank.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+    constexpr char magic[4] = { 'S', 'G', 'R', 'B' };
+    constexpr size_t headerSize = 16;
+
+    // Parameters not listed keep their defaults.
+    struct FactorySetting
+    {
+        const char* parameterID;
+        float value; // In the parameter's own units (choice index for choices)
+    };
+
+    struct FactoryPreset
+    {
+        const char* name;
+        FactorySetting settings[12];
+    };
+
+    const FactoryPreset factoryPresets[] = {
+        { "Default", {} },
+        { "Bus Glue", { { "threshold", -18.0f }, { "ratio", 2.0f }, { "knee", 6.0f }, { "attack", 30.0f },
+                        { "release", 200.0f }, { "makeup", 2.0f }, { "stereoLinkMode", 2.0f },
+                        { "detectorMode", 3.0f } } },
+        { "Vocal Leveler", { { "threshold", -26.0f }, { "ratio", 3.0f }, { "knee", 9.0f }, { "attack", 5.0f },
+                             { "release", 120.0f }, { "makeup", 5.0f }, { "detectorMode", 1.0f },
+                             { "rmsWindow", 20.0f } } },
+        { "Drum Smash", { { "threshold", -32.0f }, { "ratio", 8.0f }, { "attack", 1.0f }, { "release", 60.0f },
+                          { "makeup", 9.0f } } },
+        { "De-Esser", { { "threshold", -30.0f }, { "ratio", 6.0f }, { "knee", 3.0f }, { "attack", 1.0f },
+                        { "release", 60.0f }, { "keyFilterMode", 2.0f }, { "keyFilterFreq", 6500.0f } } },
+        { "Limiter", { { "threshold", -1.0f }, { "ratio", 20.0f }, { "attack", 1.0f }, { "release", 50.0f },
+                       { "lookahead", 5.0f }, { "detectorMode", 2.0f }, { "oversampling", 2.0f } } },
+        { "Multiband Master", { { "bands", 1.0f }, { "crossover1", 150.0f }, { "crossover2", 2500.0f },
+                                { "band1_threshold", -20.0f }, { "band1_ratio", 2.5f }, { "band1_knee", 6.0f },
+                                { "band2_threshold", -18.0f }, { "band2_ratio", 2.0f }, { "band2_knee", 6.0f },
+                                { "band3_threshold", -22.0f }, { "band3_ratio", 3.0f }, { "band3_knee", 6.0f } } }
+    };
+
+    float readFloat(const uint8_t* source)
+    {
+        const uint32_t bits = juce::ByteOrder::littleEndianInt(source);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void writeHeader(juce::OutputStream& out, const ParameterState& state, int numPresets)
+    {
+        out.write(magic, sizeof(magic));
+        out.writeShort(static_cast<short>(PresetBank::currentVersion));
+        out.writeShort(static_cast<short>(headerSize));
+        out.writeInt(static_cast<int>(state.getNumParameters()));
+        out.writeInt(numPresets);
+
+        for (size_t i = 0; i < state.getNumParameters(); ++i)
+            out.writeInt(static_cast<int>(state.getHash(i)));
+    }
+
+    void writeRecord(juce::OutputStream& out, const juce::String& name, const std::vector<float>& values)
+    {
+        // Cut at a character boundary, leaving room for the terminator.
+        auto trimmed = name;
+        while (trimmed.getNumBytesAsUTF8() >= static_cast<size_t>(PresetBank::maxNameBytes))
+            trimmed = trimmed.dropLastCharacters(1);
+
+        char nameBytes[PresetBank::maxNameBytes] = {};
+        std::memcpy(nameBytes, trimmed.toRawUTF8(), trimmed.getNumBytesAsUTF8());
+        out.write(nameBytes, sizeof(nameBytes));
+
+        for (const float value : values)
+            out.writeFloat(value);
+    }
+}
+
+//==============================================================================
+bool PresetBank::View::parse(const void* data, size_t size)
+{
+    *this = {};
+    const auto* bytes = static_cast<const uint8_t*>(data);
+
+    if (bytes == nullptr || size < headerSize || std::memcmp(bytes, magic, sizeof(magic)) != 0)
+        return false;
+
+    // Later versions may only grow the header; the table and the records stay as they are.
+    const uint16_t version = juce::ByteOrder::littleEndianShort(bytes + 4);
+    const size_t bankHeaderSize = juce::ByteOrder::littleEndianShort(bytes + 6);
+    const size_t bankParameters = juce::ByteOrder::littleEndianInt(bytes + 8);
+    const size_t bankPresets = juce::ByteOrder::littleEndianInt(bytes + 12);
+
+    if (version == 0 || bankHeaderSize < headerSize || bankHeaderSize > size
+        || bankParameters > (size - bankHeaderSize) / sizeof(uint32_t))
+        return false;
+
+    const size_t tableEnd = bankHeaderSize + bankParameters * sizeof(uint32_t);
+    const size_t bankRecordSize = static_cast<size_t>(maxNameBytes) + bankParameters * sizeof(float);
+
+    if (bankPresets > (size - tableEnd) / bankRecordSize || bankPresets > 0x7fffffff)
+        return false;
+
+    hashes = bytes + bankHeaderSize;
+    records = bytes + tableEnd;
+    numParameters = bankParameters;
+    recordSize = bankRecordSize;
+    numPresets = static_cast<int>(bankPresets);
+    return true;
+}
+
+juce::String PresetBank::View::getName(int index) const
+{
+    const auto* name = reinterpret_cast<const char*>(getRecord(index));
+    size_t length = 0;
+
+    while (length < static_cast<size_t>(maxNameBytes) && name[length] != 0)
+        ++length;
+
+    return juce::String::fromUTF8(name, static_cast<int>(length));
+}
+
+//==============================================================================
+PresetBank::PresetBank(ParameterState& state, const juce::File& userBankFile)
+    : parameterState(state), userFile(userBankFile)
+{
+    buildFactoryImage();
+    loadUserFile();
+}
+
+juce::File PresetBank::getDefaultUserBankFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("JuceSimpleGainReduction")
+        .getChildFile("UserPresets.sgrb");
+}
+
+void PresetBank::buildFactoryImage()
+{
+    const size_t numParameters = parameterState.getNumParameters();
+    const int numFactoryPresets = static_cast<int>(std::size(factoryPresets));
+
+    juce::MemoryOutputStream out(factoryImage, false);
+    writeHeader(out, parameterState, numFactoryPresets);
+
+    std::vector<float> values(numParameters);
+
+    for (const auto& preset : factoryPresets)
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+            values[i] = parameterState.getDefaultValue(i);
+
+        for (const auto& setting : preset.settings)
+        {
+            if (setting.parameterID == nullptr)
+                break;
+
+            const uint32_t hash = ParameterState::hashParameterID(setting.parameterID);
+            bool found = false;
+
+            for (size_t i = 0; i < numParameters && !found; ++i)
+            {
+                if (parameterState.getHash(i) == hash)
+                {
+                    values[i] = setting.value;
+                    found = true;
+                }
+            }
+
+            jassert(found); // A factory preset names a parameter that doesn't exist.
+        }
+
+        writeRecord(out, preset.name, values);
+    }
+
+    out.flush();
+    const bool parsed = factory.parse(factoryImage.getData(), factoryImage.getSize());
+    jassert(parsed);
+    juce::ignoreUnused(parsed);
+}
+
+void PresetBank::loadUserFile()
+{
+    user = {};
+    userImage.reset();
+
+    if (!userFile.existsAsFile() || !userFile.loadFileAsData(userImage))
+        return;
+
+    // A damaged or foreign file is left alone (and replaced by the next save).
+    if (!user.parse(userImage.getData(), userImage.getSize()))
+        userImage.reset();
+}
+
+//==============================================================================
+int PresetBank::getNumPresets() const
+{
+    return factory.numPresets + user.numPresets;
+}
+
+juce::String PresetBank::getName(int index) const
+{
+    if (index >= 0 && index < factory.numPresets)
+        return factory.getName(index);
+
+    return isUserPreset(index) ? user.getName(index - factory.numPresets) : juce::String();
+}
+
+bool PresetBank::recall(int index)
+{
+    const bool isFactory = index >= 0 && index < factory.numPresets;
+    if (!isFactory && !isUserPreset(index))
+        return false;
+
+    const auto& view = isFactory ? factory : user;
+    const auto* record = view.getRecord(isFactory ? index : index - factory.numPresets);
+
+    // The hash table and the record's values are two arrays of the same length.
+    parameterState.applyEntries(view.hashes, sizeof(uint32_t), record + maxNameBytes, sizeof(float),
+                                view.numParameters);
+    return true;
+}
+
+int PresetBank::addUserPreset(const juce::String& name)
+{
+    return writeUserBank(-1, name, true) ? getNumPresets() - 1 : -1;
+}
+
+bool PresetBank::renameUserPreset(int index, const juce::String& name)
+{
+    return isUserPreset(index) && writeUserBank(index - factory.numPresets, name, false);
+}
+
+bool PresetBank::writeUserBank(int renamedIndex, const juce::String& newName, bool appendCurrent)
+{
+    // Start from the bank on disk, which other instances may have added to.
+    loadUserFile();
+    if (renamedIndex >= user.numPresets)
+        return false;
+
+    const size_t numParameters = parameterState.getNumParameters();
+
+    juce::MemoryOutputStream out;
+    writeHeader(out, parameterState, user.numPresets + (appendCurrent ? 1 : 0));
+
+    // Where each of the file's parameters sits now (-1 if it's gone); the ones
+    // it doesn't know yet get their defaults.
+    std::vector<int> currentIndex(user.numParameters, -1);
+    for (size_t k = 0; k < user.numParameters; ++k)
+    {
+        const uint32_t hash = juce::ByteOrder::littleEndianInt(user.hashes + k * sizeof(uint32_t));
+
+        for (size_t i = 0; i < numParameters; ++i)
+            if (parameterState.getHash(i) == hash)
+                currentIndex[k] = static_cast<int>(i);
+    }
+
+    std::vector<float> defaults(numParameters);
+    for (size_t i = 0; i < numParameters; ++i)
+        defaults[i] = parameterState.getDefaultValue(i);
+
+    std::vector<float> values(numParameters);
+
+    for (int preset = 0; preset < user.numPresets; ++preset)
+    {
+        const auto* stored = user.getRecord(preset) + maxNameBytes;
+        values = defaults;
+
+        for (size_t k = 0; k < user.numParameters; ++k)
+            if (currentIndex[k] >= 0)
+                values[static_cast<size_t>(currentIndex[k])] = readFloat(stored + k * sizeof(float));
+
+        writeRecord(out, preset == renamedIndex ? newName : user.getName(preset), values);
+    }
+
+    if (appendCurrent)
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+            values[i] = parameterState.getValue(i);
+
+        writeRecord(out, newName, values);
+    }
+
+    out.flush();
+
+    if (!userFile.getParentDirectory().createDirectory())
+        return false;
+
+    juce::TemporaryFile temporary(userFile);
+    if (!temporary.getFile().replaceWithData(out.getData(), out.getDataSize()))
+        return false;
+
+    const bool replaced = temporary.overwriteTargetFileWithTemporary();
+    loadUserFile();
+    return replaced;
+}
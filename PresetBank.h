@@ -0,0 +1,94 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterState.h"
+
+#include <cstdint>
+
+//==============================================================================
+/**
+    The processor's programs: a fixed set of factory presets followed by the
+    user's own, which live in one bank file:
+
+        "SGRB", version, header size, parameter count, preset count (16 bytes, little endian)
+        parameter count * uint32 ID hash (FNV-1a, see ParameterState)
+        preset count * { char name[32] (UTF-8, zero padded), parameter count * float value }
+
+    Every preset stores every parameter in the order of the hash table, so a
+    preset is one fixed-size record and finding one is a multiplication. The
+    file is read into memory with one read and parsed in place: opening a bank
+    of thousands of presets parses one header and decodes no records. Nothing
+    keeps the file open or mapped, so other instances (and other processes)
+    can replace it at any time, which Windows refuses for a mapped file. Every
+    save reloads the file first, so presets other instances have added since
+    are kept. Records written before parameters were added or removed still
+    load (by hash, like a session state); saving re-encodes them to the
+    current parameter set.
+
+    The factory presets are built into an image of the same layout at
+    construction, so both halves of the list recall through the same code.
+    Recalling a preset stores its values into the parameters' atomics
+    (ParameterState::applyEntries), and the processor picks them up at its
+    next block. Message thread only.
+*/
+class PresetBank
+{
+public:
+    static constexpr uint16_t currentVersion = 1;
+    static constexpr int maxNameBytes = 32;
+
+    /** Loads userBankFile, if it exists and is a valid bank. */
+    PresetBank(ParameterState& state, const juce::File& userBankFile);
+
+    /** <user application data>/JuceSimpleGainReduction/UserPresets.sgrb */
+    static juce::File getDefaultUserBankFile();
+
+    int getNumPresets() const;
+    int getNumFactoryPresets() const { return factory.numPresets; }
+    bool isUserPreset(int index) const { return index >= factory.numPresets && index < getNumPresets(); }
+
+    juce::String getName(int index) const;
+
+    /** Sets every parameter to the preset's value; false for an index out of range. */
+    bool recall(int index);
+
+    /** Appends the current parameter values as a user preset and returns its index, or -1
+        if the bank file couldn't be written. Names are cut to maxNameBytes - 1 bytes. */
+    int addUserPreset(const juce::String& name);
+
+    /** Factory presets keep their names; false for those and on write errors. */
+    bool renameUserPreset(int index, const juce::String& name);
+
+private:
+    // A parsed bank, pointing into the factory or the user image.
+    struct View
+    {
+        const uint8_t* hashes{ nullptr };
+        const uint8_t* records{ nullptr };
+        size_t numParameters{ 0 };
+        size_t recordSize{ 0 };
+        int numPresets{ 0 };
+
+        bool parse(const void* data, size_t size);
+        const uint8_t* getRecord(int index) const { return records + static_cast<size_t>(index) * recordSize; }
+        juce::String getName(int index) const;
+    };
+
+    ParameterState& parameterState;
+    juce::File userFile;
+
+    juce::MemoryBlock factoryImage;
+    View factory;
+
+    juce::MemoryBlock userImage;
+    View user;
+
+    void buildFactoryImage();
+    void loadUserFile();
+
+    // Writes the whole user bank (the records on disk, re-encoded if the parameters changed,
+    // with one name replaced or one record appended) to a temporary file and swaps it in.
+    bool writeUserBank(int renamedIndex, const juce::String& newName, bool appendCurrent);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBank)
+};
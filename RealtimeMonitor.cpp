@@ -0,0 +1,326 @@
+#include "RealtimeMonitor.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#if JSGR_REALTIME_MONITOR && defined(_MSC_VER)
+ #include <malloc.h>
+#endif
+
+#if JSGR_REALTIME_MONITOR
+
+namespace
+{
+    // The monitor of the callback running on (or attached to) this thread.
+    thread_local RealtimeMonitor* currentMonitor = nullptr;
+
+    template <typename Type>
+    void storeIf(std::atomic<Type>& target, Type value, bool condition)
+    {
+        if (condition)
+            target.store(value, std::memory_order_relaxed);
+    }
+
+    void* allocateAligned(std::size_t size, std::size_t alignment) noexcept
+    {
+        size = size == 0 ? 1 : size;
+
+       #if defined(_MSC_VER)
+        return _aligned_malloc(size, alignment);
+       #else
+        void* memory = nullptr;
+        return posix_memalign(&memory, std::max(alignment, sizeof(void*)), size) == 0 ? memory : nullptr;
+       #endif
+    }
+
+    void freeAligned(void* memory) noexcept
+    {
+       #if defined(_MSC_VER)
+        _aligned_free(memory);
+       #else
+        std::free(memory);
+       #endif
+    }
+}
+
+//==============================================================================
+// Every new/delete of the plugin goes through these while instrumented (JUCE builds
+// plugins with hidden visibility, so the host's allocations are untouched).
+void* operator new(std::size_t size)
+{
+    RealtimeMonitor::noteAllocation();
+
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeMonitor::noteAllocation();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept
+{
+    if (memory != nullptr)
+        RealtimeMonitor::noteAllocation();
+
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+// Over-aligned types (alignas beyond the default) come through these instead.
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    RealtimeMonitor::noteAllocation();
+
+    if (void* memory = allocateAligned(size, static_cast<std::size_t>(alignment)))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    RealtimeMonitor::noteAllocation();
+    return allocateAligned(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    if (memory != nullptr)
+        RealtimeMonitor::noteAllocation();
+
+    freeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept
+{
+    operator delete(memory, alignment);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(memory, alignment);
+}
+
+//==============================================================================
+RealtimeMonitor::ScopedCallback::ScopedCallback(RealtimeMonitor& monitor, int numSamplesToTime)
+    : owner(monitor), previous(currentMonitor), numSamples(numSamplesToTime)
+{
+    currentMonitor = &owner;
+    startTicks = juce::Time::getHighResolutionTicks();
+}
+
+RealtimeMonitor::ScopedCallback::~ScopedCallback()
+{
+    const int64_t elapsed = juce::Time::getHighResolutionTicks() - startTicks;
+    currentMonitor = previous;
+    owner.record(static_cast<double>(elapsed) * owner.secondsPerTick, numSamples);
+}
+
+RealtimeMonitor* RealtimeMonitor::getCurrent()
+{
+    return currentMonitor;
+}
+
+RealtimeMonitor::ScopedAttachment::ScopedAttachment(RealtimeMonitor* monitor)
+    : previous(currentMonitor)
+{
+    currentMonitor = monitor;
+}
+
+RealtimeMonitor::ScopedAttachment::~ScopedAttachment()
+{
+    currentMonitor = previous;
+}
+
+//==============================================================================
+void RealtimeMonitor::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    secondsPerTick = 1.0 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+    clear();
+}
+
+void RealtimeMonitor::reset()
+{
+    resetPending.store(true, std::memory_order_release);
+}
+
+void RealtimeMonitor::clear()
+{
+    for (auto& bin : bins)
+        bin.store(0, std::memory_order_relaxed);
+
+    numCallbacks.store(0, std::memory_order_relaxed);
+    totalLoad.store(0.0, std::memory_order_relaxed);
+    minLoad.store(0.0f, std::memory_order_relaxed);
+    maxLoad.store(0.0f, std::memory_order_relaxed);
+    allocations.store(0, std::memory_order_relaxed);
+    blockingLocks.store(0, std::memory_order_relaxed);
+    contendedLocks.store(0, std::memory_order_relaxed);
+}
+
+void RealtimeMonitor::record(double seconds, int numSamples)
+{
+    if (resetPending.exchange(false, std::memory_order_acquire))
+        clear();
+
+    if (numSamples <= 0)
+        return;
+
+    const float load = static_cast<float>(seconds * sampleRate / numSamples);
+    const int bin = juce::jmin(static_cast<int>(load / binWidth), numBins - 1);
+    const int64_t count = numCallbacks.load(std::memory_order_relaxed);
+
+    // Single writer: plain read-modify-store, no locked instructions.
+    bins[static_cast<size_t>(bin)].store(bins[static_cast<size_t>(bin)].load(std::memory_order_relaxed) + 1,
+                                         std::memory_order_relaxed);
+    totalLoad.store(totalLoad.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+    storeIf(minLoad, load, count == 0 || load < minLoad.load(std::memory_order_relaxed));
+    storeIf(maxLoad, load, load > maxLoad.load(std::memory_order_relaxed));
+    numCallbacks.store(count + 1, std::memory_order_release);
+}
+
+void RealtimeMonitor::noteAllocation()
+{
+    if (auto* monitor = currentMonitor)
+        monitor->allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RealtimeMonitor::noteBlockingLock()
+{
+    if (auto* monitor = currentMonitor)
+        monitor->blockingLocks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RealtimeMonitor::noteContendedLock()
+{
+    if (auto* monitor = currentMonitor)
+        monitor->contendedLocks.fetch_add(1, std::memory_order_relaxed);
+}
+
+RealtimeMonitor::Report RealtimeMonitor::getReport() const
+{
+    Report report;
+    report.numCallbacks = numCallbacks.load(std::memory_order_acquire);
+    report.allocations = allocations.load(std::memory_order_relaxed);
+    report.blockingLocks = blockingLocks.load(std::memory_order_relaxed);
+    report.contendedLocks = contendedLocks.load(std::memory_order_relaxed);
+
+    if (report.numCallbacks == 0)
+        return report;
+
+    report.minLoad = minLoad.load(std::memory_order_relaxed);
+    report.maxLoad = maxLoad.load(std::memory_order_relaxed);
+    report.averageLoad = static_cast<float>(totalLoad.load(std::memory_order_relaxed) / report.numCallbacks);
+
+    // The upper edge of the bin holding the 99th percentile (the max if that's the overflow bin).
+    const int64_t rank = (report.numCallbacks * 99 + 99) / 100;
+    int64_t seen = 0;
+    report.p99Load = report.maxLoad;
+
+    for (int bin = 0; bin < numBins - 1; ++bin)
+    {
+        seen += bins[static_cast<size_t>(bin)].load(std::memory_order_relaxed);
+
+        if (seen >= rank)
+        {
+            report.p99Load = juce::jmin(static_cast<float>(bin + 1) * binWidth, report.maxLoad);
+            break;
+        }
+    }
+
+    return report;
+}
+
+juce::String RealtimeMonitor::createReportText() const
+{
+    const auto report = getReport();
+    auto percent = [](float load) { return juce::String(load * 100.0f, 2) + " %"; };
+
+    juce::String text;
+    text << "callbacks: " << static_cast<juce::int64>(report.numCallbacks) << "\n"
+         << "load min/avg/p99/max: " << percent(report.minLoad) << " / " << percent(report.averageLoad) << " / "
+         << percent(report.p99Load) << " / " << percent(report.maxLoad) << "\n"
+         << "allocations in callbacks: " << static_cast<juce::int64>(report.allocations) << "\n"
+         << "blocking locks in callbacks: " << static_cast<juce::int64>(report.blockingLocks) << "\n"
+         << "contended try-locks in callbacks: " << static_cast<juce::int64>(report.contendedLocks) << "\n"
+         << "histogram (load from, callbacks):\n";
+
+    for (int bin = 0; bin < numBins; ++bin)
+        if (const auto count = bins[static_cast<size_t>(bin)].load(std::memory_order_relaxed); count > 0)
+            text << "  " << percent(static_cast<float>(bin) * binWidth) << (bin == numBins - 1 ? "+" : "")
+                 << ", " << static_cast<juce::int64>(count) << "\n";
+
+    return text;
+}
+
+#else
+
+//==============================================================================
+void RealtimeMonitor::prepare(double) {}
+void RealtimeMonitor::reset() {}
+void RealtimeMonitor::noteAllocation() {}
+void RealtimeMonitor::noteBlockingLock() {}
+void RealtimeMonitor::noteContendedLock() {}
+
+RealtimeMonitor* RealtimeMonitor::getCurrent()
+{
+    return nullptr;
+}
+
+RealtimeMonitor::Report RealtimeMonitor::getReport() const
+{
+    return {};
+}
+
+juce::String RealtimeMonitor::createReportText() const
+{
+    return "Realtime monitoring is not compiled in (build with JSGR_REALTIME_MONITOR=1).\n";
+}
+
+#endif
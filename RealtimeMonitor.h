@@ -0,0 +1,171 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// 1 compiles the instrumentation in. It replaces the global operator new and delete,
+// which anyone debugging a host with the plugin loaded would run into, so it is off
+// unless the build asks for it: JSGR_REALTIME_MONITOR=1 in the project's preprocessor
+// definitions, or -DJSGR_REALTIME_MONITOR=ON for the CMake tools.
+#ifndef JSGR_REALTIME_MONITOR
+ #define JSGR_REALTIME_MONITOR 0
+#endif
+
+//==============================================================================
+/**
+    Realtime-safety and load instrumentation of one processor's audio callback.
+
+    Each processBlock is timed with the high-resolution clock and its load
+    (time taken / the block's duration at the sample rate) counted into a
+    histogram of fixed bins, from which getReport() derives min, average,
+    99th percentile and max. While a callback runs, this build's global
+    operator new and delete count every call made on that thread against
+    the processor, and so does every acquisition of a RealtimeMonitor::SpinLock
+    on that thread, so a realtime violation shows up as a non-zero count
+    instead of as a rare dropout. Threads doing a callback's work (the worker
+    pool) attach themselves to its monitor for the duration, so their
+    allocations and locks count against the callback too. Try-locks that find the lock held are
+    counted too: they don't block, but each one is a block that ran without
+    what it was trying to pick up.
+
+    The audio thread only stores into atomics it alone writes; any other
+    thread may read a report or ask for a reset (done at the next callback).
+    With JSGR_REALTIME_MONITOR 0 everything here compiles to nothing and the
+    report says it is disabled.
+*/
+class RealtimeMonitor
+{
+public:
+    static constexpr bool isEnabled = JSGR_REALTIME_MONITOR != 0;
+
+    struct Report
+    {
+        bool enabled{ isEnabled };
+        int64_t numCallbacks{ 0 };
+
+        // Fractions of the callback budget (1 = the block's duration).
+        float minLoad{ 0.0f };
+        float averageLoad{ 0.0f };
+        float p99Load{ 0.0f };
+        float maxLoad{ 0.0f };
+
+        int64_t allocations{ 0 };    // operator new/delete calls inside callbacks
+        int64_t blockingLocks{ 0 };  // Blocking lock acquisitions inside callbacks
+        int64_t contendedLocks{ 0 }; // Try-locks inside callbacks that found the lock held
+    };
+
+    /** Not realtime safe; call from prepareToPlay(). */
+    void prepare(double sampleRate);
+
+    /** Any thread. */
+    Report getReport() const;
+    void reset();
+
+    /** The report plus every non-empty histogram bin, as text for a log or the clipboard. */
+    juce::String createReportText() const;
+
+    /** Times one callback of numSamples and attributes what happens on this thread
+        meanwhile to the monitor. Put it at the top of processBlock. */
+    class ScopedCallback
+    {
+    public:
+#if JSGR_REALTIME_MONITOR
+        ScopedCallback(RealtimeMonitor& monitor, int numSamples);
+        ~ScopedCallback();
+
+    private:
+        RealtimeMonitor& owner;
+        RealtimeMonitor* previous;
+        int64_t startTicks;
+        int numSamples;
+#else
+        ScopedCallback(RealtimeMonitor&, int) {}
+#endif
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedCallback)
+    };
+
+    /** The monitor of the callback running on this thread (or attached to it), if any. */
+    static RealtimeMonitor* getCurrent();
+
+    /** Attributes what happens on this thread to monitor (which may be null) while in
+        scope, for threads that run part of a callback on its behalf. */
+    class ScopedAttachment
+    {
+    public:
+#if JSGR_REALTIME_MONITOR
+        explicit ScopedAttachment(RealtimeMonitor* monitor);
+        ~ScopedAttachment();
+
+    private:
+        RealtimeMonitor* previous;
+#else
+        explicit ScopedAttachment(RealtimeMonitor*) {}
+#endif
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedAttachment)
+    };
+
+    /** Called from anywhere that allocates or locks: counts against the monitor of
+        the callback running on this thread, if any. */
+    static void noteAllocation();
+    static void noteBlockingLock();
+    static void noteContendedLock();
+
+    /** A juce::SpinLock whose acquisitions inside a callback are counted: blocking
+        ones as violations, try-locks that fail as contention. Use it for every lock
+        the audio thread touches; on other threads it is a plain SpinLock. */
+    class SpinLock
+    {
+    public:
+        void enter() const noexcept
+        {
+            noteBlockingLock();
+            lock.enter();
+        }
+
+        bool tryEnter() const noexcept
+        {
+            const bool entered = lock.tryEnter();
+
+            if (!entered)
+                noteContendedLock();
+
+            return entered;
+        }
+
+        void exit() const noexcept { lock.exit(); }
+
+        using ScopedLockType = juce::GenericScopedLock<SpinLock>;
+        using ScopedTryLockType = juce::GenericScopedTryLock<SpinLock>;
+
+    private:
+        juce::SpinLock lock;
+    };
+
+private:
+#if JSGR_REALTIME_MONITOR
+    // Loads from 0 to 100 % in 0.05 % steps; the last bin takes everything above.
+    static constexpr int numBins = 2001;
+    static constexpr float binWidth = 0.0005f;
+
+    std::array<std::atomic<uint32_t>, numBins> bins{};
+    std::atomic<int64_t> numCallbacks{ 0 };
+    std::atomic<double> totalLoad{ 0.0 };
+    std::atomic<float> minLoad{ 0.0f };
+    std::atomic<float> maxLoad{ 0.0f };
+    std::atomic<int64_t> allocations{ 0 };
+    std::atomic<int64_t> blockingLocks{ 0 };
+    std::atomic<int64_t> contendedLocks{ 0 };
+    std::atomic<bool> resetPending{ false };
+
+    double secondsPerTick{ 0.0 };
+    double sampleRate{ 44100.0 };
+
+    void record(double seconds, int numSamples);
+    void clear();
+#endif
+};
@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    CompressorBank checks: banks of 1, 4, 8 and 16 compressors (every group
+    width) against one BroadbandCompressor per compressor, unlinked with the
+    peak detector, on the same input. Each compressor has settings and a
+    signal of its own, so a lane that reads another's constants or state
+    shows up, and the makeup changes halfway through to cover its ramp. Fails
+    when a gain differs by more than the 0.001 dB CompressorBank.h documents.
+
+    JUCE-free; built and registered with CTest by the top-level CMakeLists.txt.
+
+  ==============================================================================
+*/
+
+#include "../BroadbandCompressor.h"
+#include "../CompressorBank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr float toleranceDB = 0.001f;
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int numBlocks = 200;
+    constexpr int numSamples = blockSize * numBlocks;
+
+    // Gains are compared where the input is above this, so rounding near zero doesn't count.
+    constexpr float minLevel = 1.0e-3f;
+
+    CompressorBank::Parameters makeParameters(int index)
+    {
+        CompressorBank::Parameters p;
+        p.thresholdDB = -6.0f - 3.0f * static_cast<float>(index % 7);
+        p.ratio = 2.0f + static_cast<float>(index % 5) * 2.5f;
+        p.kneeDB = static_cast<float>(index % 3) * 6.0f;
+        p.attackMs = 1.0f + static_cast<float>(index % 4) * 7.0f;
+        p.releaseMs = 30.0f + static_cast<float>(index) * 20.0f;
+        p.makeupDB = static_cast<float>(index % 4) * 2.0f;
+        return p;
+    }
+
+    // A sine whose level steps between quiet and loud (across the threshold) at a
+    // rate and pitch of the compressor's own.
+    std::vector<float> makeSignal(int index)
+    {
+        std::vector<float> signal(static_cast<size_t>(numSamples));
+        const double frequency = 110.0 * (1.0 + 0.37 * index);
+        const int stepLength = 3000 + 700 * index;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float level = (i / stepLength) % 2 == 0 ? 0.05f : 0.9f;
+            signal[static_cast<size_t>(i)]
+                = level * static_cast<float>(std::sin(2.0 * 3.14159265358979 * frequency * i / sampleRate));
+        }
+
+        return signal;
+    }
+
+    float toDB(float gain)
+    {
+        return 20.0f * std::log10(std::max(gain, 1.0e-30f));
+    }
+
+    // Runs numCompressors through a bank and through as many broadband compressors,
+    // block by block, and returns the largest gain difference in dB.
+    float compareBank(int numCompressors, int& groupWidth)
+    {
+        CompressorBank bank;
+        bank.prepare(numCompressors, sampleRate, blockSize);
+
+        std::vector<std::unique_ptr<BroadbandCompressor>> references;
+        const auto groups = ChannelGroups::independent(1);
+
+        std::vector<std::vector<float>> inputs, bankAudio, referenceAudio;
+
+        for (int i = 0; i < numCompressors; ++i)
+        {
+            const auto p = makeParameters(i);
+            bank.setParameters(i, p);
+
+            auto reference = std::make_unique<BroadbandCompressor>();
+            reference->prepare(1, blockSize, 1);
+            reference->setSampleRate(sampleRate);
+            reference->setTimes(p.attackMs, p.releaseMs);
+            reference->setCurve(p.thresholdDB, p.ratio, p.kneeDB);
+            reference->setControlRateGain(false);
+            references.push_back(std::move(reference));
+
+            inputs.push_back(makeSignal(i));
+        }
+
+        bank.reset();
+        bankAudio = inputs;
+        referenceAudio = inputs;
+        groupWidth = bank.getGroupWidth();
+
+        std::vector<float> makeup(static_cast<size_t>(numCompressors));
+        for (int i = 0; i < numCompressors; ++i)
+            makeup[static_cast<size_t>(i)] = std::pow(10.0f, makeParameters(i).makeupDB * 0.05f);
+
+        std::vector<float*> channels(static_cast<size_t>(numCompressors));
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const int offset = block * blockSize;
+
+            // Halfway through, every compressor's makeup moves by 3 dB: both ramp over the next block.
+            if (block == numBlocks / 2)
+            {
+                for (int i = 0; i < numCompressors; ++i)
+                {
+                    auto p = makeParameters(i);
+                    p.makeupDB += 3.0f;
+                    bank.setParameters(i, p);
+                }
+            }
+
+            for (int i = 0; i < numCompressors; ++i)
+                channels[static_cast<size_t>(i)] = bankAudio[static_cast<size_t>(i)].data() + offset;
+
+            bank.process(channels.data(), blockSize);
+
+            for (int i = 0; i < numCompressors; ++i)
+            {
+                auto& previousMakeup = makeup[static_cast<size_t>(i)];
+                const float targetMakeup = std::pow(10.0f,
+                    (makeParameters(i).makeupDB + (block >= numBlocks / 2 ? 3.0f : 0.0f)) * 0.05f);
+
+                float* audio[] = { referenceAudio[static_cast<size_t>(i)].data() + offset };
+                references[static_cast<size_t>(i)]->processGroup(BroadbandCompressor::LinkMode::off, audio, audio,
+                                                                  groups, 0, blockSize, 0.0f,
+                                                                  previousMakeup, targetMakeup);
+                previousMakeup = targetMakeup;
+            }
+        }
+
+        float worstDB = 0.0f;
+
+        for (int i = 0; i < numCompressors; ++i)
+        {
+            const auto& input = inputs[static_cast<size_t>(i)];
+
+            for (size_t n = 0; n < input.size(); ++n)
+            {
+                if (std::abs(input[n]) < minLevel)
+                    continue;
+
+                const float bankGain = bankAudio[static_cast<size_t>(i)][n] / input[n];
+                const float referenceGain = referenceAudio[static_cast<size_t>(i)][n] / input[n];
+                worstDB = std::max(worstDB, std::abs(toDB(bankGain) - toDB(referenceGain)));
+            }
+        }
+
+        return worstDB;
+    }
+}
+
+int main()
+{
+    int failures = 0;
+
+    for (int numCompressors : { 1, 4, 8, 16 })
+    {
+        int groupWidth = 0;
+        const float errorDB = compareBank(numCompressors, groupWidth);
+        const bool passed = errorDB <= toleranceDB;
+
+        std::printf("%s %2d compressors (groups of %2d)  max error %.6f dB\n", passed ? "ok  " : "FAIL",
+                    numCompressors, groupWidth, static_cast<double>(errorDB));
+        failures += passed ? 0 : 1;
+    }
+
+    if (failures > 0)
+    {
+        std::printf("%d failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all passed\n");
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    GainComputer accuracy checks: every SIMD kernel this CPU runs, and the fast
+    mode's table, against the scalar reference kernel over a sweep of envelope
+    levels, for hard and soft knees across the parameter ranges. Fails when a
+    kernel leaves the bounds GainComputer.h documents.
+
+    JUCE-free; built and registered with CTest by the top-level CMakeLists.txt.
+
+  ==============================================================================
+*/
+
+#include "../GainComputer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Documented bounds: 0.001 dB for the SIMD kernels from -100 dB to +24 dB,
+    // maxTableErrorDB for the table from -100 dB to +48 dB, down to 80 dB of reduction.
+    constexpr float simdToleranceDB = 0.001f;
+    constexpr float simdMaxLevelDB = 24.0f;
+    constexpr float tableMaxLevelDB = 48.0f;
+    constexpr float tableMaxReductionDB = 80.0f;
+    constexpr float minLevelDB = -100.0f;
+
+    struct Curve
+    {
+        float thresholdDB, ratio, kneeDB;
+    };
+
+    // Envelope levels from minLevelDB to maxLevelDB in steps of 0.01 dB, plus the
+    // curve's corners and their float neighbours, where the kernels disagree the most.
+    std::vector<float> makeSweep(const Curve& curve, float maxLevelDB)
+    {
+        std::vector<float> levels;
+
+        const int numSteps = static_cast<int>((maxLevelDB - minLevelDB) * 100.0f);
+
+        for (int i = 0; i <= numSteps; ++i)
+            levels.push_back(std::pow(10.0f, (minLevelDB + static_cast<float>(i) * 0.01f) * 0.05f));
+
+        for (float corner : { curve.thresholdDB - curve.kneeDB * 0.5f, curve.thresholdDB,
+                              curve.thresholdDB + curve.kneeDB * 0.5f })
+        {
+            const float level = std::pow(10.0f, corner * 0.05f);
+            levels.push_back(std::nextafter(level, 0.0f));
+            levels.push_back(level);
+            levels.push_back(std::nextafter(level, 1.0e9f));
+        }
+
+        return levels;
+    }
+
+    std::vector<float> process(GainComputer& computer, const std::vector<float>& levels)
+    {
+        std::vector<float> gains(levels.size());
+        computer.process(levels.data(), gains.data(), static_cast<int>(levels.size()));
+        return gains;
+    }
+
+    float toDB(float gain)
+    {
+        return 20.0f * std::log10(std::max(gain, 1.0e-30f));
+    }
+
+    // Largest difference in dB between two sets of gains where the reference reduces
+    // by at most maxReductionDB; prints the worst level found.
+    float compare(const std::vector<float>& levels, const std::vector<float>& reference,
+                  const std::vector<float>& gains, float maxReductionDB)
+    {
+        float worstDB = 0.0f;
+        float worstLevelDB = 0.0f;
+
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            if (-toDB(reference[i]) > maxReductionDB)
+                continue;
+
+            const float difference = std::abs(toDB(gains[i]) - toDB(reference[i]));
+            if (!(difference <= worstDB)) // NaN counts as worst
+            {
+                worstDB = difference;
+                worstLevelDB = toDB(levels[i]);
+            }
+        }
+
+        if (worstDB > 0.0f)
+            std::printf("    worst %.6f dB at %.3f dB\n", static_cast<double>(worstDB), static_cast<double>(worstLevelDB));
+
+        return worstDB;
+    }
+
+    bool check(const char* name, const Curve& curve, float errorDB, float toleranceDB)
+    {
+        const bool passed = errorDB <= toleranceDB;
+        std::printf("%s %-10s threshold %6.1f ratio %5.1f knee %5.1f: %.6f dB (limit %.4f)\n",
+                    passed ? "ok  " : "FAIL", name, static_cast<double>(curve.thresholdDB),
+                    static_cast<double>(curve.ratio), static_cast<double>(curve.kneeDB),
+                    static_cast<double>(errorDB), static_cast<double>(toleranceDB));
+        return passed;
+    }
+}
+
+int main()
+{
+    const Curve curves[] = {
+        { -24.0f, 4.0f, 0.0f },  // Plugin defaults
+        { -60.0f, 20.0f, 0.0f },
+        { -60.0f, 20.0f, 24.0f },
+        { -40.0f, 1.5f, 1.0f },
+        { -30.0f, 8.0f, 6.0f },
+        { -12.0f, 2.0f, 12.0f },
+        { 0.0f, 20.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f }     // Ratio 1: no reduction at all
+    };
+
+    const GainComputer::Isa simdIsas[] = { GainComputer::Isa::sse2, GainComputer::Isa::avx2, GainComputer::Isa::neon };
+    auto computer = std::make_unique<GainComputer>();
+    int failures = 0;
+
+    std::printf("best kernel: %s\n", GainComputer::getIsaName(GainComputer::getBestIsa()));
+
+    for (const auto& curve : curves)
+    {
+        computer->setPrecision(GainComputer::Precision::precise);
+        computer->setParameters(curve.thresholdDB, curve.ratio, curve.kneeDB);
+
+        // SIMD kernels, over the range their bound covers.
+        const auto simdLevels = makeSweep(curve, simdMaxLevelDB);
+        computer->setIsa(GainComputer::Isa::scalar);
+        const auto simdReference = process(*computer, simdLevels);
+
+        for (auto isa : simdIsas)
+        {
+            computer->setIsa(isa);
+            if (computer->getIsa() != isa)
+                continue; // Not available on this CPU
+
+            const float errorDB = compare(simdLevels, simdReference, process(*computer, simdLevels),
+                                          -minLevelDB + simdMaxLevelDB); // Every level
+            failures += check(GainComputer::getIsaName(isa), curve, errorDB, simdToleranceDB) ? 0 : 1;
+        }
+
+        // Fast mode: build and pick up the table, then read it with every kernel.
+        const auto tableLevels = makeSweep(curve, tableMaxLevelDB);
+        computer->setIsa(GainComputer::Isa::scalar);
+        const auto tableReference = process(*computer, tableLevels);
+
+        computer->setPrecision(GainComputer::Precision::fast);
+        computer->buildTable();
+        computer->syncTable();
+
+        if (!computer->isUsingTable())
+        {
+            std::printf("FAIL table not in use after buildTable()/syncTable()\n");
+            ++failures;
+            continue;
+        }
+
+        for (auto isa : { GainComputer::Isa::scalar, GainComputer::Isa::avx2 })
+        {
+            computer->setIsa(isa);
+            if (computer->getIsa() != isa)
+                continue;
+
+            const float errorDB = compare(tableLevels, tableReference, process(*computer, tableLevels),
+                                          tableMaxReductionDB);
+            const auto name = isa == GainComputer::Isa::avx2 ? "Table/AVX2" : "Table";
+            failures += check(name, curve, errorDB, GainComputer::maxTableErrorDB) ? 0 : 1;
+        }
+    }
+
+    if (failures > 0)
+    {
+        std::printf("%d failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all passed\n");
+    return 0;
+}
@@ -0,0 +1,298 @@
+/*
+  ==============================================================================
+
+    C API checks: every sample format, interleaved and planar, in place and out
+    of place, with calls shorter and longer than maxFrames, against planar
+    float32 processed a chunk at a time. The integer formats must match that
+    reference to within half a step (saturating at full scale), float32 must
+    match it exactly, and with unity gain every format must round-trip.
+
+    JUCE-free; built and registered with CTest by the top-level CMakeLists.txt.
+
+  ==============================================================================
+*/
+
+#include "../JsgrCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr int numChannels = 3;
+    constexpr int maxFrames = 64;
+    constexpr int numFrames = 1000;
+    constexpr double sampleRate = 48000.0;
+
+    // Planar audio, [channel * numFrames + frame].
+    using Audio = std::vector<float>;
+
+    struct Layout
+    {
+        JsgrSampleFormat format;
+        bool interleaved;
+        bool inPlace;
+        int callFrames; // Frames per jsgr_process_*() call
+    };
+
+    int getSampleSize(JsgrSampleFormat format)
+    {
+        return format == JSGR_FORMAT_INT16 ? 2 : (format == JSGR_FORMAT_INT24 ? 3 : 4);
+    }
+
+    // One step of the format at full scale 1 (0 for float32).
+    float getStep(JsgrSampleFormat format)
+    {
+        return format == JSGR_FORMAT_INT16 ? 1.0f / 32768.0f : (format == JSGR_FORMAT_INT24 ? 1.0f / 8388608.0f : 0.0f);
+    }
+
+    const char* getName(JsgrSampleFormat format)
+    {
+        return format == JSGR_FORMAT_INT16 ? "int16" : (format == JSGR_FORMAT_INT24 ? "int24" : "float32");
+    }
+
+    // The encodings, written independently of the library's.
+    void encode(float sample, JsgrSampleFormat format, unsigned char* bytes)
+    {
+        if (format == JSGR_FORMAT_FLOAT32)
+        {
+            std::memcpy(bytes, &sample, sizeof(sample));
+        }
+        else if (format == JSGR_FORMAT_INT16)
+        {
+            const auto value = static_cast<int16_t>(std::lrint(sample * 32768.0f));
+            std::memcpy(bytes, &value, sizeof(value));
+        }
+        else
+        {
+            const auto value = static_cast<uint32_t>(static_cast<int32_t>(std::lrint(sample * 8388608.0f)));
+            bytes[0] = static_cast<unsigned char>(value & 0xff);
+            bytes[1] = static_cast<unsigned char>((value >> 8) & 0xff);
+            bytes[2] = static_cast<unsigned char>((value >> 16) & 0xff);
+        }
+    }
+
+    float decode(const unsigned char* bytes, JsgrSampleFormat format)
+    {
+        if (format == JSGR_FORMAT_FLOAT32)
+        {
+            float sample;
+            std::memcpy(&sample, bytes, sizeof(sample));
+            return sample;
+        }
+
+        if (format == JSGR_FORMAT_INT16)
+        {
+            int16_t value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return static_cast<float>(value) / 32768.0f;
+        }
+
+        int32_t value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+        if (value & 0x800000)
+            value -= 0x1000000;
+
+        return static_cast<float>(value) / 8388608.0f;
+    }
+
+    // A sine under a slow swell with bursts up to and past full scale, quantized to
+    // format, so reading it back is exact. The first frames hold both full-scale
+    // extremes and the smallest negative step, where sign extension goes wrong.
+    Audio makeInput(JsgrSampleFormat format, float peak)
+    {
+        const float step = getStep(format);
+        Audio audio(static_cast<size_t>(numChannels * numFrames));
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            for (int frame = 0; frame < numFrames; ++frame)
+            {
+                const float swell = 0.2f + 0.8f * static_cast<float>(0.5 - 0.5 * std::cos(frame * 0.011));
+                const float burst = (frame / 100) % 3 == 1 ? 1.0f : 0.3f;
+                float sample = peak * swell * burst
+                             * static_cast<float>(std::sin(frame * (0.05 + 0.02 * channel) + channel));
+
+                if (step > 0.0f)
+                    sample = std::min(std::max(std::round(sample / step) * step, -1.0f), 1.0f - step);
+
+                audio[static_cast<size_t>(channel * numFrames + frame)] = sample;
+            }
+        }
+
+        if (step > 0.0f)
+        {
+            audio[0] = -1.0f;
+            audio[1] = 1.0f - step;
+            audio[2] = -step;
+        }
+
+        return audio;
+    }
+
+    // Runs input through a new compressor in the given layout and returns the output decoded.
+    Audio render(const JsgrParameters& parameters, const Audio& input, const Layout& layout)
+    {
+        const int sampleSize = getSampleSize(layout.format);
+        const auto bytesPerChannel = static_cast<size_t>(numFrames * sampleSize);
+        std::vector<unsigned char> inputBytes(static_cast<size_t>(numChannels) * bytesPerChannel);
+        std::vector<unsigned char> outputBytes(inputBytes.size());
+
+        auto offsetOf = [&](int channel, int frame)
+        {
+            return layout.interleaved ? static_cast<size_t>((frame * numChannels + channel) * sampleSize)
+                                      : static_cast<size_t>(channel) * bytesPerChannel
+                                            + static_cast<size_t>(frame * sampleSize);
+        };
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int frame = 0; frame < numFrames; ++frame)
+                encode(input[static_cast<size_t>(channel * numFrames + frame)], layout.format,
+                       inputBytes.data() + offsetOf(channel, frame));
+
+        auto& destination = layout.inPlace ? inputBytes : outputBytes;
+
+        JsgrCompressor* compressor = jsgr_create(numChannels, sampleRate, maxFrames);
+        jsgr_set_parameters(compressor, &parameters);
+        jsgr_reset(compressor);
+
+        for (int start = 0; start < numFrames; start += layout.callFrames)
+        {
+            const int frames = std::min(layout.callFrames, numFrames - start);
+
+            if (layout.interleaved)
+            {
+                jsgr_process_interleaved(compressor, inputBytes.data() + offsetOf(0, start),
+                                         destination.data() + offsetOf(0, start), frames, layout.format);
+            }
+            else
+            {
+                const void* inputs[numChannels];
+                void* outputs[numChannels];
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    inputs[channel] = inputBytes.data() + offsetOf(channel, start);
+                    outputs[channel] = destination.data() + offsetOf(channel, start);
+                }
+
+                jsgr_process_planar(compressor, inputs, outputs, frames, layout.format);
+            }
+        }
+
+        jsgr_destroy(compressor);
+
+        Audio output(input.size());
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int frame = 0; frame < numFrames; ++frame)
+                output[static_cast<size_t>(channel * numFrames + frame)]
+                    = decode(destination.data() + offsetOf(channel, frame), layout.format);
+
+        return output;
+    }
+
+    // Largest distance of output from the reference saturated to format's range, in steps
+    // (or absolute for float32); counts the reference samples beyond full scale.
+    float compare(const Audio& reference, const Audio& output, JsgrSampleFormat format, int& numSaturated)
+    {
+        const float step = getStep(format);
+        float worst = 0.0f;
+        numSaturated = 0;
+
+        for (size_t i = 0; i < reference.size(); ++i)
+        {
+            float expected = reference[i];
+
+            if (step > 0.0f && (expected < -1.0f || expected > 1.0f - step))
+            {
+                expected = std::min(std::max(expected, -1.0f), 1.0f - step);
+                ++numSaturated;
+            }
+
+            const float error = std::abs(output[i] - expected);
+            worst = std::max(worst, step > 0.0f ? error / step : error);
+        }
+
+        return worst;
+    }
+
+    bool check(const char* what, const Layout& layout, float error, float tolerance)
+    {
+        const bool passed = error <= tolerance;
+        std::printf("%s %-12s %-7s %-11s %-12s %4d frames/call  error %g\n", passed ? "ok  " : "FAIL", what,
+                    getName(layout.format), layout.interleaved ? "interleaved" : "planar",
+                    layout.inPlace ? "in place" : "out of place", layout.callFrames, static_cast<double>(error));
+        return passed;
+    }
+}
+
+int main()
+{
+    int failures = 0;
+
+    // Unity gain: ratio 1, no makeup. Whatever goes in must come out.
+    JsgrParameters unity;
+    jsgr_get_default_parameters(&unity);
+    unity.ratio = 1.0f;
+
+    // Compressing hard, linked, with makeup that pushes the bursts past full scale.
+    JsgrParameters compressing;
+    jsgr_get_default_parameters(&compressing);
+    compressing.thresholdDB = -20.0f;
+    compressing.ratio = 4.0f;
+    compressing.kneeDB = 6.0f;
+    compressing.attackMs = 1.0f;
+    compressing.makeupDB = 9.0f;
+    compressing.linkMode = JSGR_LINK_MAX;
+    compressing.link = 0.7f;
+
+    for (auto format : { JSGR_FORMAT_FLOAT32, JSGR_FORMAT_INT16, JSGR_FORMAT_INT24 })
+    {
+        const auto input = makeInput(format, 1.0f);
+
+        for (bool interleaved : { false, true })
+        {
+            for (bool inPlace : { false, true })
+            {
+                for (int callFrames : { 48, maxFrames, 333, numFrames })
+                {
+                    const Layout layout{ format, interleaved, inPlace, callFrames };
+                    int numSaturated = 0;
+
+                    const auto unityOutput = render(unity, input, layout);
+                    failures += check("round-trip", layout, compare(input, unityOutput, format, numSaturated), 0.0f)
+                        ? 0 : 1;
+
+                    // The reference chunks exactly as the compressor does internally (calls of
+                    // maxFrames), so float32 has to match it bit for bit whatever the call length.
+                    const Layout referenceLayout{ JSGR_FORMAT_FLOAT32, false, false, maxFrames };
+                    const auto reference = render(compressing, input, referenceLayout);
+                    const auto output = render(compressing, input, layout);
+                    const float tolerance = format == JSGR_FORMAT_FLOAT32 ? 0.0f : 0.5f;
+
+                    failures += check("compressing", layout, compare(reference, output, format, numSaturated),
+                                      tolerance) ? 0 : 1;
+
+                    if (format != JSGR_FORMAT_FLOAT32 && numSaturated == 0)
+                    {
+                        std::printf("FAIL nothing reached full scale, so saturation went untested\n");
+                        ++failures;
+                    }
+                }
+            }
+        }
+    }
+
+    if (failures > 0)
+    {
+        std::printf("%d failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all passed\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    ParameterState checks on a real processor: a binary state round-trips, and
+    truncated blobs, headers claiming more bytes than the blob holds and other
+    malformed states are rejected without reading past the data or changing a
+    parameter.
+
+    Needs JUCE; built and registered with CTest by CMakeLists.txt next to the
+    processor tools.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool condition, const char* what)
+    {
+        std::printf("%s %s\n", condition ? "ok  " : "FAIL", what);
+        failures += condition ? 0 : 1;
+    }
+
+    std::vector<float> getValues(juce::AudioProcessor& processor)
+    {
+        std::vector<float> values;
+
+        for (auto* parameter : processor.getParameters())
+            values.push_back(parameter->getValue());
+
+        return values;
+    }
+
+    void setLittleEndian16(juce::MemoryBlock& block, size_t offset, uint16_t value)
+    {
+        auto* bytes = static_cast<uint8_t*>(block.getData());
+        bytes[offset] = static_cast<uint8_t>(value);
+        bytes[offset + 1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    // Reads data (copied into a buffer of exactly its size, so an overrun reads
+    // past the allocation) and checks that nothing was restored.
+    void expectRejected(ParameterState& state, juce::AudioProcessor& processor, const juce::MemoryBlock& data,
+                        const char* what)
+    {
+        const auto before = getValues(processor);
+        std::vector<uint8_t> copy(static_cast<const uint8_t*>(data.getData()),
+                                  static_cast<const uint8_t*>(data.getData()) + data.getSize());
+
+        const bool accepted = state.read(copy.data(), static_cast<int>(copy.size()));
+        expect(!accepted && getValues(processor) == before, what);
+    }
+}
+
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    JuceSimpleGainReductionAudioProcessor processor;
+    ParameterState state(processor.getValueTreeState());
+
+    auto& valueTreeState = processor.getValueTreeState();
+    auto* threshold = valueTreeState.getParameter(ParamIDs::threshold);
+    auto* ratio = valueTreeState.getParameter(ParamIDs::ratio);
+
+    // Round trip.
+    threshold->setValueNotifyingHost(threshold->convertTo0to1(-40.0f));
+    ratio->setValueNotifyingHost(ratio->convertTo0to1(8.0f));
+
+    juce::MemoryBlock saved;
+    state.write(saved);
+    const auto savedValues = getValues(processor);
+
+    threshold->setValueNotifyingHost(threshold->getDefaultValue());
+    ratio->setValueNotifyingHost(ratio->getDefaultValue());
+
+    expect(state.read(saved.getData(), static_cast<int>(saved.getSize())) && getValues(processor) == savedValues,
+           "binary state round-trips");
+
+    // Every truncation of a valid state, header included.
+    bool allTruncationsRejected = true;
+
+    for (size_t size = 1; size < saved.getSize(); ++size)
+    {
+        const auto before = getValues(processor);
+        std::vector<uint8_t> truncated(static_cast<const uint8_t*>(saved.getData()),
+                                       static_cast<const uint8_t*>(saved.getData()) + size);
+
+        if (state.read(truncated.data(), static_cast<int>(size)) || getValues(processor) != before)
+            allTruncationsRejected = false;
+    }
+
+    expect(allTruncationsRejected, "truncated states are rejected");
+
+    // Header sizes larger than the blob, up to the field's maximum.
+    for (uint16_t headerSize : { static_cast<uint16_t>(saved.getSize() + 1), static_cast<uint16_t>(0xffff) })
+    {
+        auto oversized = saved;
+        setLittleEndian16(oversized, 6, headerSize);
+        expectRejected(state, processor, oversized, "header larger than the state is rejected");
+    }
+
+    // A bare 16-byte header claiming a larger header and one entry.
+    {
+        juce::MemoryBlock headerOnly(saved.getData(), 16);
+        setLittleEndian16(headerOnly, 6, 24);
+        expectRejected(state, processor, headerOnly, "header-only state with a larger header size is rejected");
+    }
+
+    // Entry sizes smaller than an entry, and version 0.
+    {
+        auto badEntrySize = saved;
+        setLittleEndian16(badEntrySize, 8, 4);
+        expectRejected(state, processor, badEntrySize, "entry size below 8 bytes is rejected");
+
+        auto badVersion = saved;
+        setLittleEndian16(badVersion, 4, 0);
+        expectRejected(state, processor, badVersion, "version 0 is rejected");
+    }
+
+    if (failures > 0)
+    {
+        std::printf("%d failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all passed\n");
+    return 0;
+}
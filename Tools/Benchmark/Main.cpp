@@ -0,0 +1,911 @@
+/*
+  ==============================================================================
+
+    processBlock microbenchmark: ns/sample of JuceSimpleGainReductionAudioProcessor
+    over block sizes, channel counts, knee modes, link modes, makeup gains, band counts,
+    single- or multithreaded processing, audio- or control-rate gain, sample types and
+    input signals, written as
+    CSV or JSON so results can be diffed across releases. With --paint it times
+    the editor's knob drawing instead, with --state the per-instance cost of
+    saving and restoring the plugin state, and with --bank a CompressorBank
+    against as many mono processors.
+
+    Built by the Benchmark target of CMakeLists.txt, the same way as
+    Tools/OfflineRender (see the README); time it in a Release build.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../PluginProcessor.h"
+#include "../../KnobLookAndFeel.h"
+#include "../../CompressorBank.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    //==============================================================================
+    enum class Signal
+    {
+        silence,    // all zeros
+        quiet,      // -60 dBFS noise, below threshold
+        compressed, // full-scale noise, well above threshold
+        denormal    // noise around 1e-39, inside the float denormal range
+    };
+
+    const char* getDetectorName(LevelDetector::Mode mode)
+    {
+        switch (mode)
+        {
+            case LevelDetector::Mode::peak:             return "peak";
+            case LevelDetector::Mode::rms:              return "rms";
+            case LevelDetector::Mode::truePeak:         return "truepeak";
+            case LevelDetector::Mode::programDependent: return "program";
+        }
+
+        return "";
+    }
+
+    using StereoLinkMode = JuceSimpleGainReductionAudioProcessor::StereoLinkMode;
+
+    const char* getLinkName(StereoLinkMode mode)
+    {
+        switch (mode)
+        {
+            case StereoLinkMode::off:     return "off";
+            case StereoLinkMode::max:     return "max";
+            case StereoLinkMode::average: return "average";
+        }
+
+        return "";
+    }
+
+    const char* getSignalName(Signal signal)
+    {
+        switch (signal)
+        {
+            case Signal::silence:    return "silence";
+            case Signal::quiet:      return "quiet";
+            case Signal::compressed: return "compressed";
+            case Signal::denormal:   return "denormal";
+        }
+
+        return "";
+    }
+
+    struct Case
+    {
+        int blockSize{ 512 };
+        int numChannels{ 2 };
+        float kneeDB{ 0.0f };
+        Signal signal{ Signal::compressed };
+        int numBands{ 0 }; // 0 = broadband
+        bool multithreading{ false };
+        bool fastCurve{ false };
+        LevelDetector::Mode detectorMode{ LevelDetector::Mode::peak };
+        bool doublePrecision{ false };
+        StereoLinkMode linkMode{ StereoLinkMode::off };
+        float makeupDB{ 0.0f };
+        bool controlRateGain{ false };
+    };
+
+    struct Result
+    {
+        Case benchmarkCase;
+        double nanosecondsPerSample{ 0.0 }; // median over the repetitions
+        double minNanosecondsPerSample{ 0.0 };
+        juce::String isa;
+    };
+
+    struct Options
+    {
+        juce::Array<int> blockSizes{ 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        juce::Array<int> channelCounts{ 1, 2, 8 };
+        juce::Array<float> kneeValues{ 0.0f, 12.0f };
+        juce::Array<int> bandCounts{ 0 };
+        juce::Array<int> multithreadingModes{ 0 };
+        juce::Array<int> precisionModes{ 0 };
+        juce::Array<LevelDetector::Mode> detectorModes{ LevelDetector::Mode::peak };
+        juce::Array<int> sampleTypes{ 0 };
+        juce::Array<StereoLinkMode> linkModes{ StereoLinkMode::off };
+        juce::Array<float> makeupValues{ 0.0f };
+        juce::Array<int> gainRates{ 0 };
+        juce::Array<Signal> signals{ Signal::silence, Signal::quiet, Signal::compressed, Signal::denormal };
+        double sampleRate{ 48000.0 };
+        double secondsPerRun{ 0.05 };
+        int repetitions{ 7 };
+        bool json{ false };
+        bool paint{ false };
+        bool state{ false };
+        bool bank{ false };
+        juce::Array<int> instanceCounts{ 1, 10, 100, 1000 };
+        juce::String filter;
+    };
+
+    void printUsage()
+    {
+        std::cout <<
+            "Usage: Benchmark [options]\n"
+            "\n"
+            "  --block-sizes <n,...>   Default 16,32,64,128,256,512,1024,2048,4096\n"
+            "  --channels <n,...>      Default 1,2,8 (layouts the processor rejects are skipped)\n"
+            "  --knee <db,...>         Default 0,12 (hard and soft knee)\n"
+            "  --bands <n,...>         0 (broadband, default) or 3-5 for the multiband mode\n"
+            "  --multithreading <n,...> 0 (default) or 1 to compress channel groups on the worker pool\n"
+            "  --precision <name,...>  precise (default), fast (table-driven gain curve)\n"
+            "  --detector <name,...>   peak (default), rms, truepeak, program\n"
+            "  --sample-type <name,...> float (default), double (the host's 64-bit processBlock)\n"
+            "  --link <name,...>       off (default), max, average (stereo link mode)\n"
+            "  --makeup <db,...>       Default 0 (no makeup multiply); e.g. 0,6\n"
+            "  --gain-rate <name,...>  audio (default), control (curve and smoothing every 8-32 samples)\n"
+            "  --signals <name,...>    silence, quiet, compressed, denormal (default all)\n"
+            "  --sample-rate <hz>      Default 48000\n"
+            "  --seconds <s>           Audio per repetition (default 0.05)\n"
+            "  --repetitions <n>       Default 7; the median is reported\n"
+            "  --filter <text>         Only run cases whose name contains text\n"
+            "  --json                  JSON instead of CSV\n"
+            "  --paint                 Time knob painting (cached vs uncached) instead of processBlock\n"
+            "  --state                 Time state save/restore (binary vs XML) instead of processBlock\n"
+            "  --bank                  Time a CompressorBank against as many mono processors\n"
+            "  --instances <n,...>     Instance counts for --state and --bank (default 1,10,100,1000)\n";
+    }
+
+    bool fail(const juce::String& message)
+    {
+        std::cerr << "error: " << message << std::endl;
+        return false;
+    }
+
+    template <typename Type, typename Parse>
+    bool parseList(const juce::String& text, juce::Array<Type>& list, Parse parse)
+    {
+        list.clear();
+
+        for (const auto& token : juce::StringArray::fromTokens(text, ",", ""))
+        {
+            Type value;
+            if (! parse(token.trim(), value))
+                return fail("invalid list entry '" + token + "'");
+
+            list.add(value);
+        }
+
+        return ! list.isEmpty();
+    }
+
+    bool parseArguments(const juce::StringArray& args, Options& options)
+    {
+        auto parseInt = [](const juce::String& s, int& v) { v = s.getIntValue(); return v > 0; };
+        auto parseFloat = [](const juce::String& s, float& v) { v = s.getFloatValue(); return s.isNotEmpty(); };
+        auto parseBands = [](const juce::String& s, int& v)
+        {
+            v = s.getIntValue();
+            return v == 0 || (v >= MultibandCompressor::minBands && v <= MultibandCompressor::maxBands);
+        };
+        auto parseSwitch = [](const juce::String& s, int& v) { v = s.getIntValue(); return s == "0" || s == "1"; };
+        auto parsePrecision = [](const juce::String& s, int& v)
+        {
+            v = s == "fast" ? 1 : 0;
+            return s == "fast" || s == "precise";
+        };
+        auto parseSampleType = [](const juce::String& s, int& v)
+        {
+            v = s == "double" ? 1 : 0;
+            return s == "double" || s == "float";
+        };
+        auto parseDetector = [](const juce::String& s, LevelDetector::Mode& v)
+        {
+            for (auto mode : { LevelDetector::Mode::peak, LevelDetector::Mode::rms,
+                               LevelDetector::Mode::truePeak, LevelDetector::Mode::programDependent })
+            {
+                if (s == getDetectorName(mode))
+                {
+                    v = mode;
+                    return true;
+                }
+            }
+
+            return false;
+        };
+        auto parseGainRate = [](const juce::String& s, int& v)
+        {
+            v = s == "control" ? 1 : 0;
+            return s == "control" || s == "audio";
+        };
+        auto parseLink = [](const juce::String& s, StereoLinkMode& v)
+        {
+            for (auto mode : { StereoLinkMode::off, StereoLinkMode::max, StereoLinkMode::average })
+            {
+                if (s == getLinkName(mode))
+                {
+                    v = mode;
+                    return true;
+                }
+            }
+
+            return false;
+        };
+        auto parseSignal = [](const juce::String& s, Signal& v)
+        {
+            for (auto signal : { Signal::silence, Signal::quiet, Signal::compressed, Signal::denormal })
+            {
+                if (s == getSignalName(signal))
+                {
+                    v = signal;
+                    return true;
+                }
+            }
+
+            return false;
+        };
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+
+            if (arg == "--json" || arg == "--paint" || arg == "--state" || arg == "--bank")
+            {
+                (arg == "--json" ? options.json : arg == "--paint" ? options.paint
+                                 : arg == "--state" ? options.state : options.bank) = true;
+                continue;
+            }
+
+            if (i + 1 >= args.size())
+                return fail(arg + " needs a value");
+
+            const auto value = args[++i];
+            bool ok = true;
+
+            if (arg == "--block-sizes")         ok = parseList(value, options.blockSizes, parseInt);
+            else if (arg == "--channels")       ok = parseList(value, options.channelCounts, parseInt);
+            else if (arg == "--knee")           ok = parseList(value, options.kneeValues, parseFloat);
+            else if (arg == "--bands")          ok = parseList(value, options.bandCounts, parseBands);
+            else if (arg == "--multithreading") ok = parseList(value, options.multithreadingModes, parseSwitch);
+            else if (arg == "--precision")      ok = parseList(value, options.precisionModes, parsePrecision);
+            else if (arg == "--detector")       ok = parseList(value, options.detectorModes, parseDetector);
+            else if (arg == "--sample-type")    ok = parseList(value, options.sampleTypes, parseSampleType);
+            else if (arg == "--link")           ok = parseList(value, options.linkModes, parseLink);
+            else if (arg == "--makeup")         ok = parseList(value, options.makeupValues, parseFloat);
+            else if (arg == "--gain-rate")      ok = parseList(value, options.gainRates, parseGainRate);
+            else if (arg == "--signals")        ok = parseList(value, options.signals, parseSignal);
+            else if (arg == "--sample-rate")    options.sampleRate = value.getDoubleValue();
+            else if (arg == "--seconds")        options.secondsPerRun = value.getDoubleValue();
+            else if (arg == "--repetitions")    options.repetitions = juce::jmax(1, value.getIntValue());
+            else if (arg == "--instances")      ok = parseList(value, options.instanceCounts, parseInt);
+            else if (arg == "--filter")         options.filter = value;
+            else                                return fail("unknown option '" + arg + "'");
+
+            if (! ok)
+                return fail("invalid value for " + arg);
+        }
+
+        if (options.sampleRate <= 0.0 || options.secondsPerRun <= 0.0)
+            return fail("sample rate and seconds must be positive");
+
+        return true;
+    }
+
+    juce::String getCaseName(const Case& c)
+    {
+        return juce::String(getSignalName(c.signal))
+            + "/ch" + juce::String(c.numChannels)
+            + "/bs" + juce::String(c.blockSize)
+            + (c.kneeDB > 0.0f ? "/soft" : "/hard")
+            + (c.linkMode != StereoLinkMode::off ? "/link-" + juce::String(getLinkName(c.linkMode)) : juce::String())
+            + (c.makeupDB != 0.0f ? "/makeup" + juce::String(c.makeupDB) : juce::String())
+            + (c.numBands > 0 ? "/mb" + juce::String(c.numBands) : juce::String())
+            + (c.multithreading ? "/mt" : "")
+            + (c.fastCurve ? "/fast" : "")
+            + (c.controlRateGain ? "/control" : "")
+            + (c.detectorMode != LevelDetector::Mode::peak ? "/" + juce::String(getDetectorName(c.detectorMode)) : juce::String())
+            + (c.doublePrecision ? "/double" : "");
+    }
+
+    //==============================================================================
+    template <typename SampleType>
+    void fillSignal(juce::AudioBuffer<SampleType>& buffer, Signal signal)
+    {
+        const float level = signal == Signal::quiet      ? 0.001f
+                          : signal == Signal::compressed ? 1.0f
+                          : signal == Signal::denormal   ? 1.0e-39f
+                                                         : 0.0f;
+        juce::Random random(1);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* data = buffer.getWritePointer(ch);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                data[i] = static_cast<SampleType>(level * (random.nextFloat() * 2.0f - 1.0f));
+        }
+    }
+
+    void setParameter(juce::AudioProcessorValueTreeState& state, const juce::String& id, float value)
+    {
+        if (auto* parameter = state.getParameter(id))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    /** Times processBlock for one sample type, returning ns/sample per repetition.
+        Every repetition processes the same pre-generated input (copied into the
+        work buffer outside the timed region once per pass). */
+    template <typename SampleType>
+    std::vector<double> timeProcessBlock(JuceSimpleGainReductionAudioProcessor& processor, const Case& c,
+                                         const Options& options)
+    {
+        const int numBlocks = juce::jmax(1, static_cast<int>(options.secondsPerRun * options.sampleRate) / c.blockSize);
+        const int numSamples = numBlocks * c.blockSize;
+
+        juce::AudioBuffer<SampleType> source(c.numChannels, numSamples);
+        juce::AudioBuffer<SampleType> work(c.numChannels, numSamples);
+        fillSignal(source, c.signal);
+
+        juce::MidiBuffer midi;
+        std::vector<double> runs;
+
+        // Fast mode's tables are built in the background once a block has asked for them.
+        if (c.fastCurve)
+        {
+            work.makeCopyOf(source, true);
+            juce::AudioBuffer<SampleType> view(work.getArrayOfWritePointers(), c.numChannels, 0, c.blockSize);
+            processor.processBlock(view, midi);
+            juce::Thread::sleep(100);
+        }
+
+        // One untimed pass settles the envelope and warms the caches.
+        for (int run = -1; run < options.repetitions; ++run)
+        {
+            work.makeCopyOf(source, true);
+            juce::int64 ticks = 0;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                juce::AudioBuffer<SampleType> view(work.getArrayOfWritePointers(), c.numChannels, block * c.blockSize,
+                                                   c.blockSize);
+
+                const auto before = juce::Time::getHighResolutionTicks();
+                processor.processBlock(view, midi);
+                ticks += juce::Time::getHighResolutionTicks() - before;
+            }
+
+            if (run >= 0)
+                runs.push_back(juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / numSamples);
+        }
+
+        return runs;
+    }
+
+    /** Runs one case on a fresh processor; only processBlock is measured. */
+    bool runCase(const Case& c, const Options& options, Result& result)
+    {
+        JuceSimpleGainReductionAudioProcessor processor;
+        auto& state = processor.getValueTreeState();
+
+        setParameter(state, ParamIDs::threshold, -20.0f);
+        setParameter(state, ParamIDs::ratio, 8.0f);
+        setParameter(state, ParamIDs::attack, 5.0f);
+        setParameter(state, ParamIDs::release, 80.0f);
+        setParameter(state, ParamIDs::knee, c.kneeDB);
+        setParameter(state, ParamIDs::stereoLinkMode, static_cast<float>(c.linkMode));
+        setParameter(state, ParamIDs::makeup, c.makeupDB);
+        setParameter(state, ParamIDs::multithreading, c.multithreading ? 1.0f : 0.0f);
+        setParameter(state, ParamIDs::curvePrecision, c.fastCurve ? 1.0f : 0.0f);
+        setParameter(state, ParamIDs::controlRateGain, c.controlRateGain ? 1.0f : 0.0f);
+        setParameter(state, ParamIDs::detectorMode, static_cast<float>(c.detectorMode));
+
+        // Every band gets the broadband settings, so the two modes do the same work per band.
+        if (c.numBands > 0)
+        {
+            setParameter(state, ParamIDs::bands, static_cast<float>(c.numBands - 2));
+
+            for (int band = 0; band < c.numBands; ++band)
+            {
+                setParameter(state, ParamIDs::bandParameter(band, ParamIDs::threshold), -20.0f);
+                setParameter(state, ParamIDs::bandParameter(band, ParamIDs::ratio), 8.0f);
+                setParameter(state, ParamIDs::bandParameter(band, ParamIDs::attack), 5.0f);
+                setParameter(state, ParamIDs::bandParameter(band, ParamIDs::release), 80.0f);
+                setParameter(state, ParamIDs::bandParameter(band, ParamIDs::knee), c.kneeDB);
+            }
+        }
+
+        processor.setPlayConfigDetails(c.numChannels, c.numChannels, options.sampleRate, c.blockSize);
+        if (processor.getTotalNumInputChannels() != c.numChannels)
+            return false;
+
+        // As a host does it: the precision is chosen before prepareToPlay.
+        processor.setProcessingPrecision(c.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                           : juce::AudioProcessor::singlePrecision);
+        processor.prepareToPlay(options.sampleRate, c.blockSize);
+
+        auto runs = c.doublePrecision ? timeProcessBlock<double>(processor, c, options)
+                                      : timeProcessBlock<float>(processor, c, options);
+
+        processor.releaseResources();
+
+        std::sort(runs.begin(), runs.end());
+        result.benchmarkCase = c;
+        result.nanosecondsPerSample = runs[runs.size() / 2];
+        result.minNanosecondsPerSample = runs.front();
+        result.isa = GainComputer::getIsaName(processor.getGainComputerIsa());
+        return true;
+    }
+
+    //==============================================================================
+    void writeCsv(const juce::Array<Result>& results)
+    {
+        std::cout << "name,signal,channels,block_size,knee_db,link,makeup_db,bands,multithreading,precision,gain_rate,"
+                     "detector,sample_type,isa,ns_per_sample,ns_per_sample_min" << std::endl;
+
+        for (const auto& r : results)
+        {
+            const auto& c = r.benchmarkCase;
+            std::cout << getCaseName(c) << ',' << getSignalName(c.signal) << ',' << c.numChannels << ','
+                      << c.blockSize << ',' << c.kneeDB << ',' << getLinkName(c.linkMode) << ',' << c.makeupDB << ','
+                      << c.numBands << ',' << (c.multithreading ? 1 : 0) << ','
+                      << (c.fastCurve ? "fast" : "precise") << ',' << (c.controlRateGain ? "control" : "audio") << ','
+                      << getDetectorName(c.detectorMode) << ','
+                      << (c.doublePrecision ? "double" : "float") << ',' << r.isa << ','
+                      << juce::String(r.nanosecondsPerSample, 3) << ',' << juce::String(r.minNanosecondsPerSample, 3)
+                      << std::endl;
+        }
+    }
+
+    void writeJson(const juce::Array<Result>& results, const Options& options)
+    {
+        juce::Array<juce::var> entries;
+
+        for (const auto& r : results)
+        {
+            const auto& c = r.benchmarkCase;
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("name", getCaseName(c));
+            entry->setProperty("signal", getSignalName(c.signal));
+            entry->setProperty("channels", c.numChannels);
+            entry->setProperty("block_size", c.blockSize);
+            entry->setProperty("knee_db", c.kneeDB);
+            entry->setProperty("link", getLinkName(c.linkMode));
+            entry->setProperty("makeup_db", c.makeupDB);
+            entry->setProperty("bands", c.numBands);
+            entry->setProperty("multithreading", c.multithreading);
+            entry->setProperty("precision", c.fastCurve ? "fast" : "precise");
+            entry->setProperty("gain_rate", c.controlRateGain ? "control" : "audio");
+            entry->setProperty("detector", getDetectorName(c.detectorMode));
+            entry->setProperty("sample_type", c.doublePrecision ? "double" : "float");
+            entry->setProperty("isa", r.isa);
+            entry->setProperty("ns_per_sample", r.nanosecondsPerSample);
+            entry->setProperty("ns_per_sample_min", r.minNanosecondsPerSample);
+            entries.add(juce::var(entry));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("sample_rate", options.sampleRate);
+        root->setProperty("repetitions", options.repetitions);
+        root->setProperty("results", entries);
+
+        std::cout << juce::JSON::toString(juce::var(root)) << std::endl;
+    }
+
+    //==============================================================================
+    struct PaintResult
+    {
+        int knobSize{ 0 };
+        bool cached{ false };
+        double microsecondsPerPaint{ 0.0 }; // median over the repetitions
+    };
+
+    /** Times KnobLookAndFeel::drawRotarySlider into a software image while the
+        value sweeps, as when a knob is dragged or automated. */
+    PaintResult runPaintCase(int knobSize, bool cached, int repetitions)
+    {
+        KnobLookAndFeel lookAndFeel;
+        lookAndFeel.setStaticLayerCaching(cached);
+
+        juce::Slider slider(juce::Slider::RotaryHorizontalVerticalDrag, juce::Slider::NoTextBox);
+        slider.setRange(-60.0, 0.0, 0.01);
+        slider.setBounds(0, 0, knobSize, knobSize);
+        const auto rotary = slider.getRotaryParameters();
+
+        juce::Image image(juce::Image::ARGB, knobSize, knobSize, true);
+        juce::Graphics g(image);
+
+        const int paintsPerRun = 200;
+        std::vector<double> runs;
+
+        // The untimed first pass also fills the cache.
+        for (int run = -1; run < repetitions; ++run)
+        {
+            juce::int64 ticks = 0;
+
+            for (int i = 0; i < paintsPerRun; ++i)
+            {
+                const float position = static_cast<float>(i) / static_cast<float>(paintsPerRun);
+                slider.setValue(slider.proportionOfLengthToValue(position), juce::dontSendNotification);
+
+                const auto before = juce::Time::getHighResolutionTicks();
+                lookAndFeel.drawRotarySlider(g, 0, 0, knobSize, knobSize, position,
+                                             rotary.startAngleRadians, rotary.endAngleRadians, slider);
+                ticks += juce::Time::getHighResolutionTicks() - before;
+            }
+
+            if (run >= 0)
+                runs.push_back(juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6 / paintsPerRun);
+        }
+
+        std::sort(runs.begin(), runs.end());
+        return { knobSize, cached, runs[runs.size() / 2] };
+    }
+
+    void runPaintSuite(const Options& options)
+    {
+        juce::Array<PaintResult> results;
+
+        for (int knobSize : { 60, 100, 160 })
+            for (bool cached : { false, true })
+                results.add(runPaintCase(knobSize, cached, options.repetitions));
+
+        auto getName = [](const PaintResult& r)
+        {
+            return "paint/s" + juce::String(r.knobSize) + (r.cached ? "/cached" : "/direct");
+        };
+
+        if (options.json)
+        {
+            juce::Array<juce::var> entries;
+
+            for (const auto& r : results)
+            {
+                auto* entry = new juce::DynamicObject();
+                entry->setProperty("name", getName(r));
+                entry->setProperty("knob_size", r.knobSize);
+                entry->setProperty("cached", r.cached);
+                entry->setProperty("us_per_paint", r.microsecondsPerPaint);
+                entries.add(juce::var(entry));
+            }
+
+            auto* root = new juce::DynamicObject();
+            root->setProperty("results", entries);
+            std::cout << juce::JSON::toString(juce::var(root)) << std::endl;
+            return;
+        }
+
+        std::cout << "name,knob_size,cached,us_per_paint" << std::endl;
+
+        for (const auto& r : results)
+            std::cout << getName(r) << ',' << r.knobSize << ',' << (r.cached ? 1 : 0) << ','
+                      << juce::String(r.microsecondsPerPaint, 3) << std::endl;
+    }
+
+    //==============================================================================
+    struct StateResult
+    {
+        int numInstances{ 0 };
+        bool xml{ false };
+        int bytes{ 0 };
+        double microsecondsPerRestore{ 0.0 }; // median over the repetitions
+        double microsecondsPerSave{ 0.0 };
+    };
+
+    /** Restores a state into numInstances fresh processors, as a host does when it
+        opens a project, and saves them all again. The restores alternate between
+        two different states so every parameter really changes each time. */
+    StateResult runStateCase(int numInstances, bool xml, int repetitions)
+    {
+        juce::OwnedArray<JuceSimpleGainReductionAudioProcessor> instances;
+        for (int i = 0; i < numInstances; ++i)
+            instances.add(new JuceSimpleGainReductionAudioProcessor());
+
+        auto makeState = [xml](float thresholdDB, float ratio, int numBands)
+        {
+            JuceSimpleGainReductionAudioProcessor source;
+            auto& state = source.getValueTreeState();
+            setParameter(state, ParamIDs::threshold, thresholdDB);
+            setParameter(state, ParamIDs::ratio, ratio);
+            setParameter(state, ParamIDs::bands, static_cast<float>(numBands - 2));
+
+            for (int band = 0; band < numBands; ++band)
+                setParameter(state, ParamIDs::bandParameter(band, ParamIDs::threshold), thresholdDB - 2.0f * band);
+
+            juce::MemoryBlock block;
+            if (xml)
+                juce::AudioProcessor::copyXmlToBinary(*state.copyState().createXml(), block);
+            else
+                source.getStateInformation(block);
+
+            return block;
+        };
+
+        const juce::MemoryBlock states[] = { makeState(-30.0f, 6.0f, 5), makeState(-12.0f, 2.0f, 3) };
+        std::vector<double> restoreRuns, saveRuns;
+
+        for (int run = -1; run < repetitions; ++run)
+        {
+            const auto& state = states[(run + 1) % 2];
+            const auto before = juce::Time::getHighResolutionTicks();
+
+            for (auto* instance : instances)
+                instance->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+            const auto restored = juce::Time::getHighResolutionTicks();
+            juce::MemoryBlock saved;
+
+            for (auto* instance : instances)
+                instance->getStateInformation(saved);
+
+            const auto after = juce::Time::getHighResolutionTicks();
+
+            if (run >= 0)
+            {
+                restoreRuns.push_back(juce::Time::highResolutionTicksToSeconds(restored - before) * 1.0e6 / numInstances);
+                saveRuns.push_back(juce::Time::highResolutionTicksToSeconds(after - restored) * 1.0e6 / numInstances);
+            }
+        }
+
+        std::sort(restoreRuns.begin(), restoreRuns.end());
+        std::sort(saveRuns.begin(), saveRuns.end());
+        return { numInstances, xml, static_cast<int>(states[0].getSize()),
+                 restoreRuns[restoreRuns.size() / 2], saveRuns[saveRuns.size() / 2] };
+    }
+
+    void runStateSuite(const Options& options)
+    {
+        juce::Array<StateResult> results;
+
+        for (int numInstances : options.instanceCounts)
+            for (bool xml : { false, true })
+                results.add(runStateCase(numInstances, xml, options.repetitions));
+
+        auto getName = [](const StateResult& r)
+        {
+            return "state/n" + juce::String(r.numInstances) + (r.xml ? "/xml" : "/binary");
+        };
+
+        if (options.json)
+        {
+            juce::Array<juce::var> entries;
+
+            for (const auto& r : results)
+            {
+                auto* entry = new juce::DynamicObject();
+                entry->setProperty("name", getName(r));
+                entry->setProperty("instances", r.numInstances);
+                entry->setProperty("format", r.xml ? "xml" : "binary");
+                entry->setProperty("bytes", r.bytes);
+                entry->setProperty("us_per_restore", r.microsecondsPerRestore);
+                entry->setProperty("us_per_save", r.microsecondsPerSave);
+                entries.add(juce::var(entry));
+            }
+
+            auto* root = new juce::DynamicObject();
+            root->setProperty("results", entries);
+            std::cout << juce::JSON::toString(juce::var(root)) << std::endl;
+            return;
+        }
+
+        std::cout << "name,instances,format,bytes,us_per_restore,us_per_save" << std::endl;
+
+        for (const auto& r : results)
+            std::cout << getName(r) << ',' << r.numInstances << ',' << (r.xml ? "xml" : "binary") << ','
+                      << r.bytes << ',' << juce::String(r.microsecondsPerRestore, 3) << ','
+                      << juce::String(r.microsecondsPerSave, 3) << std::endl;
+    }
+
+    //==============================================================================
+    struct BankResult
+    {
+        int numCompressors{ 0 };
+        int blockSize{ 0 };
+        int groupWidth{ 0 };
+        double bankNanoseconds{ 0.0 };      // per sample and compressor, median over the repetitions
+        double processorNanoseconds{ 0.0 };
+    };
+
+    /** The same full-scale noise through a CompressorBank of numCompressors and through
+        numCompressors mono processors with the same settings, one block at a time. */
+    BankResult runBankCase(int numCompressors, int blockSize, const Options& options)
+    {
+        const int numBlocks = juce::jmax(1, static_cast<int>(options.secondsPerRun * options.sampleRate) / blockSize);
+        const int numSamples = numBlocks * blockSize;
+
+        juce::AudioBuffer<float> source(numCompressors, numSamples);
+        juce::AudioBuffer<float> work(numCompressors, numSamples);
+        fillSignal(source, Signal::compressed);
+
+        CompressorBank bank;
+        bank.prepare(numCompressors, options.sampleRate, blockSize);
+
+        CompressorBank::Parameters parameters;
+        parameters.thresholdDB = -20.0f;
+        parameters.ratio = 8.0f;
+        parameters.attackMs = 5.0f;
+        parameters.releaseMs = 80.0f;
+
+        for (int i = 0; i < numCompressors; ++i)
+            bank.setParameters(i, parameters);
+
+        juce::OwnedArray<JuceSimpleGainReductionAudioProcessor> processors;
+
+        for (int i = 0; i < numCompressors; ++i)
+        {
+            auto* processor = processors.add(new JuceSimpleGainReductionAudioProcessor());
+            auto& state = processor->getValueTreeState();
+            setParameter(state, ParamIDs::threshold, parameters.thresholdDB);
+            setParameter(state, ParamIDs::ratio, parameters.ratio);
+            setParameter(state, ParamIDs::attack, parameters.attackMs);
+            setParameter(state, ParamIDs::release, parameters.releaseMs);
+            processor->setPlayConfigDetails(1, 1, options.sampleRate, blockSize);
+            processor->prepareToPlay(options.sampleRate, blockSize);
+        }
+
+        juce::MidiBuffer midi;
+        std::vector<float*> channels(static_cast<size_t>(numCompressors));
+        std::vector<double> bankRuns, processorRuns;
+
+        for (int run = -1; run < options.repetitions; ++run)
+        {
+            work.makeCopyOf(source, true);
+            juce::int64 bankTicks = 0;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int i = 0; i < numCompressors; ++i)
+                    channels[static_cast<size_t>(i)] = work.getWritePointer(i, block * blockSize);
+
+                const auto before = juce::Time::getHighResolutionTicks();
+                bank.process(channels.data(), blockSize);
+                bankTicks += juce::Time::getHighResolutionTicks() - before;
+            }
+
+            work.makeCopyOf(source, true);
+            juce::int64 processorTicks = 0;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                const auto before = juce::Time::getHighResolutionTicks();
+
+                for (int i = 0; i < numCompressors; ++i)
+                {
+                    float* channel = work.getWritePointer(i, block * blockSize);
+                    juce::AudioBuffer<float> view(&channel, 1, blockSize);
+                    processors[i]->processBlock(view, midi);
+                }
+
+                processorTicks += juce::Time::getHighResolutionTicks() - before;
+            }
+
+            if (run >= 0)
+            {
+                const double scale = 1.0e9 / (static_cast<double>(numSamples) * numCompressors);
+                bankRuns.push_back(juce::Time::highResolutionTicksToSeconds(bankTicks) * scale);
+                processorRuns.push_back(juce::Time::highResolutionTicksToSeconds(processorTicks) * scale);
+            }
+        }
+
+        for (auto* processor : processors)
+            processor->releaseResources();
+
+        std::sort(bankRuns.begin(), bankRuns.end());
+        std::sort(processorRuns.begin(), processorRuns.end());
+        return { numCompressors, blockSize, bank.getGroupWidth(),
+                 bankRuns[bankRuns.size() / 2], processorRuns[processorRuns.size() / 2] };
+    }
+
+    void runBankSuite(const Options& options)
+    {
+        juce::Array<BankResult> results;
+
+        auto getName = [](int numCompressors, int blockSize)
+        {
+            return "bank/n" + juce::String(numCompressors) + "/bs" + juce::String(blockSize);
+        };
+
+        for (int numCompressors : options.instanceCounts)
+            for (int blockSize : options.blockSizes)
+                if (options.filter.isEmpty() || getName(numCompressors, blockSize).contains(options.filter))
+                    results.add(runBankCase(numCompressors, blockSize, options));
+
+        if (options.json)
+        {
+            juce::Array<juce::var> entries;
+
+            for (const auto& r : results)
+            {
+                auto* entry = new juce::DynamicObject();
+                entry->setProperty("name", getName(r.numCompressors, r.blockSize));
+                entry->setProperty("compressors", r.numCompressors);
+                entry->setProperty("block_size", r.blockSize);
+                entry->setProperty("group_width", r.groupWidth);
+                entry->setProperty("bank_ns_per_sample", r.bankNanoseconds);
+                entry->setProperty("processors_ns_per_sample", r.processorNanoseconds);
+                entries.add(juce::var(entry));
+            }
+
+            auto* root = new juce::DynamicObject();
+            root->setProperty("results", entries);
+            std::cout << juce::JSON::toString(juce::var(root)) << std::endl;
+            return;
+        }
+
+        std::cout << "name,compressors,block_size,group_width,bank_ns_per_sample,processors_ns_per_sample" << std::endl;
+
+        for (const auto& r : results)
+            std::cout << getName(r.numCompressors, r.blockSize) << ',' << r.numCompressors << ',' << r.blockSize << ','
+                      << r.groupWidth << ',' << juce::String(r.bankNanoseconds, 3) << ','
+                      << juce::String(r.processorNanoseconds, 3) << std::endl;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::CharPointer_UTF8(argv[i]));
+
+    if (args.contains("--help") || args.contains("-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    Options options;
+    if (! parseArguments(args, options))
+        return 2;
+
+    if (options.paint)
+    {
+        runPaintSuite(options);
+        return 0;
+    }
+
+    if (options.state)
+    {
+        runStateSuite(options);
+        return 0;
+    }
+
+    if (options.bank)
+    {
+        runBankSuite(options);
+        return 0;
+    }
+
+    juce::Array<Result> results;
+
+    for (auto signal : options.signals)
+        for (int numChannels : options.channelCounts)
+            for (float kneeDB : options.kneeValues)
+                for (auto linkMode : options.linkModes)
+                    for (float makeupDB : options.makeupValues)
+                        for (int numBands : options.bandCounts)
+                            for (int multithreading : options.multithreadingModes)
+                                for (int fastCurve : options.precisionModes)
+                                    for (int gainRate : options.gainRates)
+                                        for (auto detectorMode : options.detectorModes)
+                                            for (int doublePrecision : options.sampleTypes)
+                                                for (int blockSize : options.blockSizes)
+                                                {
+                                                    const Case c{ blockSize, numChannels, kneeDB, signal, numBands, multithreading != 0,
+                                                                  fastCurve != 0, detectorMode, doublePrecision != 0, linkMode, makeupDB,
+                                                                  gainRate != 0 };
+
+                                                    if (options.filter.isNotEmpty() && ! getCaseName(c).contains(options.filter))
+                                                        continue;
+
+                                                    Result result;
+                                                    if (runCase(c, options, result))
+                                                        results.add(result);
+                                                    else
+                                                        std::cerr << "skipped " << getCaseName(c) << ": unsupported channel layout" << std::endl;
+                                                }
+
+    if (options.json)
+        writeJson(results, options);
+    else
+        writeCsv(results);
+
+    return 0;
+}
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""Compares two Benchmark CSV files and flags cases that got slower.
+
+    compare.py baseline.csv current.csv [--threshold 10]
+
+Exits with 1 if any case present in both files slowed down by more than
+--threshold percent (median ns/sample, or us/paint for --paint runs).
+"""
+
+import argparse
+import csv
+import sys
+
+
+METRICS = ("ns_per_sample", "us_per_paint")
+
+
+def load(path):
+    with open(path, newline="") as f:
+        reader = csv.DictReader(f)
+        metric = next(m for m in METRICS if m in reader.fieldnames)
+        return {row["name"]: float(row[metric]) for row in reader}
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0, help="allowed slowdown in percent")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = 0
+
+    print(f"{'case':<36} {'base':>9} {'now':>9} {'change':>8}")
+    for name in sorted(baseline.keys() & current.keys()):
+        before, after = baseline[name], current[name]
+        change = (after - before) / before * 100.0 if before > 0.0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  SLOWER"
+            regressions += 1
+        print(f"{name:<36} {before:>9.3f} {after:>9.3f} {change:>+7.1f}%{flag}")
+
+    for name in sorted(baseline.keys() - current.keys()):
+        print(f"{name:<36} missing from {args.current}")
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
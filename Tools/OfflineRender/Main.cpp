@@ -0,0 +1,490 @@
+/*
+  ==============================================================================
+
+    Offline render tool: runs JuceSimpleGainReductionAudioProcessor headless
+    over a WAV file (or a generated test signal) and optionally compares the
+    result against a stored golden render.
+
+    Built by the OfflineRender target of CMakeLists.txt with the plugin sources
+    (see the "Offline Rendering" section of the README).
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../PluginProcessor.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+    //==============================================================================
+    struct Options
+    {
+        juce::File inputFile;
+        juce::String generateSpec;              // "<signal>:<seconds>"
+        int generateChannels{ 2 };
+        double generateSampleRate{ 48000.0 };
+
+        juce::File outputFile;
+        juce::File goldenFile;
+        bool updateGolden{ false };
+        double toleranceDBFS{ -90.0 };
+
+        juce::Array<int> blockSizes{ 512 };
+        double sampleRate{ 0.0 };               // 0 = keep the source rate
+
+        juce::File paramsFile;
+        juce::StringPairArray parameterValues;  // id -> value, applied in order after paramsFile
+
+        juce::String isa;
+        bool loadReport{ false };
+    };
+
+    void printUsage()
+    {
+        std::cout <<
+            "Usage: OfflineRender (--input <file.wav> | --generate <signal>:<seconds>) [options]\n"
+            "\n"
+            "  --input <file.wav>          Source audio (any format JUCE can read)\n"
+            "  --generate <sig>:<seconds>  Deterministic test signal: sine, sweep, noise, bursts\n"
+            "  --channels <n>              Channel count of a generated signal (default 2)\n"
+            "  --source-rate <hz>          Sample rate of a generated signal (default 48000)\n"
+            "  --sample-rate <hz>          Resample the source to this rate before processing\n"
+            "  --block-size <n>[,<n>...]   Host block size(s); every size is rendered (default 512)\n"
+            "  --params <file.json>        Flat JSON object of parameter id -> value\n"
+            "  --set <id>=<value>          Single parameter, may be repeated; wins over --params\n"
+            "  --isa <name>                Force the gain computer kernel: scalar, sse2, avx2, neon\n"
+            "  --output <file.wav>         Write the render of the first block size (32-bit float)\n"
+            "  --golden <file.wav>         Compare every render against this file\n"
+            "  --tolerance-dbfs <db>       Largest allowed difference (default -90)\n"
+            "  --update-golden             Write the first render to --golden instead of comparing\n"
+            "  --load-report               Print the realtime monitor's report after each render\n"
+            "                              (needs a build with JSGR_REALTIME_MONITOR=1)\n"
+            "\n"
+            "Parameter values are in their displayed units (dB, ms, %); choice parameters take\n"
+            "either the index or the choice name. Exit code is 0 on success, 1 on a golden\n"
+            "mismatch and 2 on a usage or I/O error.\n";
+    }
+
+    bool fail(const juce::String& message)
+    {
+        std::cerr << "error: " << message << std::endl;
+        return false;
+    }
+
+    bool parseArguments(const juce::StringArray& args, Options& options)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+
+            if (arg == "--update-golden" || arg == "--load-report")
+            {
+                (arg == "--update-golden" ? options.updateGolden : options.loadReport) = true;
+                continue;
+            }
+
+            if (! arg.startsWith("--"))
+                return fail("unexpected argument '" + arg + "'");
+
+            if (i + 1 >= args.size())
+                return fail(arg + " needs a value");
+
+            const auto value = args[++i];
+
+            if (arg == "--input")                 options.inputFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (arg == "--generate")         options.generateSpec = value;
+            else if (arg == "--channels")         options.generateChannels = value.getIntValue();
+            else if (arg == "--source-rate")      options.generateSampleRate = value.getDoubleValue();
+            else if (arg == "--sample-rate")      options.sampleRate = value.getDoubleValue();
+            else if (arg == "--params")           options.paramsFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (arg == "--isa")              options.isa = value;
+            else if (arg == "--output")           options.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (arg == "--golden")           options.goldenFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (arg == "--tolerance-dbfs")   options.toleranceDBFS = value.getDoubleValue();
+            else if (arg == "--block-size")
+            {
+                options.blockSizes.clear();
+
+                for (const auto& size : juce::StringArray::fromTokens(value, ",", ""))
+                {
+                    const int blockSize = size.trim().getIntValue();
+                    if (blockSize <= 0)
+                        return fail("invalid block size '" + size + "'");
+
+                    options.blockSizes.add(blockSize);
+                }
+            }
+            else if (arg == "--set")
+            {
+                if (! value.containsChar('='))
+                    return fail("--set expects <id>=<value>");
+
+                options.parameterValues.set(value.upToFirstOccurrenceOf("=", false, false).trim(),
+                                            value.fromFirstOccurrenceOf("=", false, false).trim());
+            }
+            else
+            {
+                return fail("unknown option '" + arg + "'");
+            }
+        }
+
+        if (options.inputFile == juce::File() && options.generateSpec.isEmpty())
+            return fail("either --input or --generate is required");
+
+        if (options.generateChannels < 1)
+            return fail("--channels must be at least 1");
+
+        if (options.updateGolden && options.goldenFile == juce::File())
+            return fail("--update-golden needs --golden");
+
+        return true;
+    }
+
+    //==============================================================================
+    struct Audio
+    {
+        juce::AudioBuffer<float> buffer;
+        double sampleRate{ 0.0 };
+    };
+
+    bool readAudioFile(const juce::File& file, Audio& audio)
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+        if (reader == nullptr)
+            return fail("cannot read '" + file.getFullPathName() + "'");
+
+        if (reader->lengthInSamples > std::numeric_limits<int>::max())
+            return fail("'" + file.getFullPathName() + "' is too long");
+
+        const int numSamples = static_cast<int>(reader->lengthInSamples);
+        audio.buffer.setSize(static_cast<int>(reader->numChannels), numSamples);
+        audio.sampleRate = reader->sampleRate;
+        reader->read(&audio.buffer, 0, numSamples, 0, true, true);
+        return true;
+    }
+
+    bool writeAudioFile(const juce::File& file, const Audio& audio)
+    {
+        file.deleteFile();
+        file.getParentDirectory().createDirectory();
+
+        auto stream = std::make_unique<juce::FileOutputStream>(file);
+        if (! stream->openedOk())
+            return fail("cannot write '" + file.getFullPathName() + "'");
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), audio.sampleRate,
+                                                                            static_cast<unsigned int>(audio.buffer.getNumChannels()),
+                                                                            32, {}, 0));
+        if (writer == nullptr)
+            return fail("cannot create a WAV writer for '" + file.getFullPathName() + "'");
+
+        stream.release(); // now owned by the writer
+        return writer->writeFromAudioSampleBuffer(audio.buffer, 0, audio.buffer.getNumSamples());
+    }
+
+    /** Test signals are seeded and sample-rate aware, so a given spec always
+        renders the same input on every machine. */
+    bool generateSignal(const Options& options, Audio& audio)
+    {
+        const auto name = options.generateSpec.upToFirstOccurrenceOf(":", false, false).trim();
+        const double seconds = options.generateSpec.containsChar(':')
+            ? options.generateSpec.fromFirstOccurrenceOf(":", false, false).getDoubleValue()
+            : 5.0;
+
+        const double sr = options.generateSampleRate;
+        if (sr <= 0.0 || seconds <= 0.0)
+            return fail("invalid --generate / --source-rate");
+
+        const int numSamples = static_cast<int>(seconds * sr);
+        audio.buffer.setSize(options.generateChannels, numSamples);
+        audio.sampleRate = sr;
+
+        const double twoPi = juce::MathConstants<double>::twoPi;
+        juce::Random random(1);
+
+        for (int ch = 0; ch < options.generateChannels; ++ch)
+        {
+            auto* data = audio.buffer.getWritePointer(ch);
+            double phase = 0.0;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double t = i / sr;
+                double sample = 0.0;
+
+                if (name == "sine")
+                {
+                    // 1 kHz at -6 dBFS, each channel slightly detuned so linking has work to do.
+                    sample = 0.5 * std::sin(twoPi * (1000.0 + 3.0 * ch) * t);
+                }
+                else if (name == "sweep")
+                {
+                    // Exponential 20 Hz - 20 kHz sweep at -3 dBFS.
+                    const double f = 20.0 * std::pow(1000.0, t / seconds);
+                    phase += twoPi * f / sr;
+                    sample = 0.7 * std::sin(phase);
+                }
+                else if (name == "noise")
+                {
+                    sample = 0.5 * (random.nextDouble() * 2.0 - 1.0);
+                }
+                else if (name == "bursts")
+                {
+                    // 250 ms loud / 250 ms quiet, exercising attack and release in turn.
+                    const bool loud = static_cast<int>(t * 4.0) % 2 == 0;
+                    sample = (loud ? 0.9 : 0.05) * std::sin(twoPi * 220.0 * t + ch);
+                }
+                else
+                {
+                    return fail("unknown signal '" + name + "'");
+                }
+
+                data[i] = static_cast<float>(sample);
+            }
+        }
+
+        return true;
+    }
+
+    void resample(Audio& audio, double targetRate)
+    {
+        if (targetRate <= 0.0 || targetRate == audio.sampleRate)
+            return;
+
+        const double ratio = audio.sampleRate / targetRate;
+        const int numOut = static_cast<int>(audio.buffer.getNumSamples() / ratio);
+        juce::AudioBuffer<float> resampled(audio.buffer.getNumChannels(), numOut);
+
+        for (int ch = 0; ch < audio.buffer.getNumChannels(); ++ch)
+        {
+            juce::LagrangeInterpolator interpolator;
+            interpolator.process(ratio, audio.buffer.getReadPointer(ch), resampled.getWritePointer(ch),
+                                 numOut, audio.buffer.getNumSamples(), 0);
+        }
+
+        audio.buffer = std::move(resampled);
+        audio.sampleRate = targetRate;
+    }
+
+    //==============================================================================
+    bool setParameter(juce::AudioProcessorValueTreeState& state, const juce::String& id, const juce::var& value)
+    {
+        auto* parameter = state.getParameter(id);
+        if (parameter == nullptr)
+            return fail("unknown parameter '" + id + "'");
+
+        float normalised = 0.0f;
+        const auto text = value.toString().trim();
+
+        if (value.isDouble() || value.isInt() || value.isInt64() || text.containsOnly("-+.0123456789eE"))
+            normalised = parameter->convertTo0to1(static_cast<float>(text.getDoubleValue()));
+        else
+            normalised = parameter->getValueForText(text);
+
+        parameter->setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, normalised));
+        return true;
+    }
+
+    bool applyParameters(JuceSimpleGainReductionAudioProcessor& processor, const Options& options)
+    {
+        auto& state = processor.getValueTreeState();
+
+        if (options.paramsFile != juce::File())
+        {
+            const auto json = juce::JSON::parse(options.paramsFile);
+            auto* object = json.getDynamicObject();
+            if (object == nullptr)
+                return fail("'" + options.paramsFile.getFullPathName() + "' is not a JSON object");
+
+            for (const auto& property : object->getProperties())
+                if (! setParameter(state, property.name.toString(), property.value))
+                    return false;
+        }
+
+        for (const auto& id : options.parameterValues.getAllKeys())
+            if (! setParameter(state, id, options.parameterValues[id]))
+                return false;
+
+        return true;
+    }
+
+    bool applyIsa(JuceSimpleGainReductionAudioProcessor& processor, const juce::String& name)
+    {
+        if (name.isEmpty())
+            return true;
+
+        for (auto isa : { GainComputer::Isa::scalar, GainComputer::Isa::sse2,
+                          GainComputer::Isa::avx2, GainComputer::Isa::neon })
+        {
+            if (name.equalsIgnoreCase(GainComputer::getIsaName(isa)))
+            {
+                processor.setGainComputerIsa(isa);
+
+                if (processor.getGainComputerIsa() != isa)
+                    return fail(name + " is not available on this CPU");
+
+                return true;
+            }
+        }
+
+        return fail("unknown ISA '" + name + "'");
+    }
+
+    //==============================================================================
+    struct RenderResult
+    {
+        Audio audio;
+        double nanosecondsPerSample{ 0.0 };
+        juce::String loadReport;
+    };
+
+    /** Renders the whole source through a fresh processor instance, so every
+        block size starts from the same state. */
+    bool render(const Audio& source, int blockSize, const Options& options, RenderResult& result)
+    {
+        JuceSimpleGainReductionAudioProcessor processor;
+        const int numChannels = source.buffer.getNumChannels();
+        const int numSamples = source.buffer.getNumSamples();
+
+        if (! applyParameters(processor, options) || ! applyIsa(processor, options.isa))
+            return false;
+
+        processor.setPlayConfigDetails(numChannels, numChannels, source.sampleRate, blockSize);
+        if (processor.getTotalNumInputChannels() != numChannels)
+            return fail(juce::String(numChannels) + " channels are not supported by the processor");
+
+        processor.prepareToPlay(source.sampleRate, blockSize);
+
+        result.audio.sampleRate = source.sampleRate;
+        result.audio.buffer.makeCopyOf(source.buffer);
+
+        juce::MidiBuffer midi;
+        juce::int64 ticks = 0;
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            const int length = juce::jmin(blockSize, numSamples - start);
+            juce::AudioBuffer<float> block(result.audio.buffer.getArrayOfWritePointers(), numChannels, start, length);
+
+            const auto before = juce::Time::getHighResolutionTicks();
+            processor.processBlock(block, midi);
+            ticks += juce::Time::getHighResolutionTicks() - before;
+        }
+
+        result.loadReport = processor.getRealtimeMonitor().createReportText();
+        processor.releaseResources();
+
+        result.nanosecondsPerSample = numSamples > 0
+            ? juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / numSamples
+            : 0.0;
+
+        return true;
+    }
+
+    /** Largest absolute sample difference in dBFS, or +inf if the shapes differ. */
+    double compare(const Audio& a, const Audio& b)
+    {
+        if (a.buffer.getNumChannels() != b.buffer.getNumChannels()
+            || a.buffer.getNumSamples() != b.buffer.getNumSamples())
+            return std::numeric_limits<double>::infinity();
+
+        float maxDifference = 0.0f;
+
+        for (int ch = 0; ch < a.buffer.getNumChannels(); ++ch)
+        {
+            const auto* x = a.buffer.getReadPointer(ch);
+            const auto* y = b.buffer.getReadPointer(ch);
+
+            for (int i = 0; i < a.buffer.getNumSamples(); ++i)
+                maxDifference = juce::jmax(maxDifference, std::abs(x[i] - y[i]));
+        }
+
+        return juce::Decibels::gainToDecibels(static_cast<double>(maxDifference), -200.0);
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::CharPointer_UTF8(argv[i]));
+
+    if (args.isEmpty() || args.contains("--help") || args.contains("-h"))
+    {
+        printUsage();
+        return args.isEmpty() ? 2 : 0;
+    }
+
+    Options options;
+    if (! parseArguments(args, options))
+        return 2;
+
+    Audio source;
+    if (options.generateSpec.isNotEmpty() ? ! generateSignal(options, source)
+                                          : ! readAudioFile(options.inputFile, source))
+        return 2;
+
+    resample(source, options.sampleRate);
+
+    Audio golden;
+    const bool comparing = options.goldenFile != juce::File() && ! options.updateGolden;
+    if (comparing && ! readAudioFile(options.goldenFile, golden))
+        return 2;
+
+    bool passed = true;
+
+    for (int i = 0; i < options.blockSizes.size(); ++i)
+    {
+        const int blockSize = options.blockSizes[i];
+        RenderResult result;
+
+        if (! render(source, blockSize, options, result))
+            return 2;
+
+        juce::String line;
+        line << "block " << blockSize << ": " << juce::String(result.nanosecondsPerSample, 2) << " ns/sample";
+
+        if (comparing)
+        {
+            const double difference = compare(result.audio, golden);
+            const bool ok = difference <= options.toleranceDBFS;
+            passed = passed && ok;
+
+            line << ", max diff "
+                 << (std::isinf(difference) ? juce::String("shape mismatch") : juce::String(difference, 1) + " dBFS")
+                 << (ok ? " ok" : " FAILED");
+        }
+
+        std::cout << line << std::endl;
+
+        if (options.loadReport)
+            std::cout << result.loadReport << std::flush;
+
+        if (i == 0)
+        {
+            if (options.outputFile != juce::File() && ! writeAudioFile(options.outputFile, result.audio))
+                return 2;
+
+            if (options.updateGolden)
+            {
+                if (! writeAudioFile(options.goldenFile, result.audio))
+                    return 2;
+
+                std::cout << "updated " << options.goldenFile.getFullPathName() << std::endl;
+            }
+        }
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#!/bin/sh
+# Renders every case in cases/ through OfflineRender and compares it with the
+# matching golden file in golden/. Every case is rendered at several block
+# sizes and must match the same golden, so block-size dependent output fails too.
+#
+#   regression.sh <path/to/OfflineRender> [--update]
+#
+# --update rewrites the goldens from the current build; review the change in
+# the rendered audio before committing them.
+#
+# A case without a committed golden is still checked against a scalar render
+# of the same build (made in a temporary directory), which catches block-size
+# dependence and SIMD drift but not a change in the DSP itself. If nothing
+# else failed, the script then exits with 77 so CTest reports the run as
+# skipped rather than passed: render the goldens with --update (or the
+# OfflineRenderGoldens target) and commit them. GOLDEN_DIR overrides where
+# the goldens live.
+
+set -u
+
+renderer=${1:?usage: regression.sh <path/to/OfflineRender> [--update]}
+update=${2:-}
+here=$(cd "$(dirname "$0")" && pwd)
+golden_dir=${GOLDEN_DIR:-$here/golden}
+signal="bursts:4"
+block_sizes="32,64,512,4096"
+tolerance=-90
+status=0
+missing=0
+
+if [ ! -x "$renderer" ]; then
+    echo "renderer not found or not executable: $renderer"
+    exit 1
+fi
+
+scratch=$(mktemp -d)
+trap 'rm -rf "$scratch"' EXIT
+
+if [ "$update" = "--update" ]; then
+    mkdir -p "$golden_dir"
+fi
+
+for params in "$here"/cases/*.json; do
+    name=$(basename "$params" .json)
+    golden="$golden_dir/$name.wav"
+    echo "== $name"
+
+    if [ "$update" = "--update" ]; then
+        "$renderer" --generate "$signal" --params "$params" --isa scalar \
+            --golden "$golden" --update-golden || status=1
+        continue
+    fi
+
+    if [ ! -f "$golden" ]; then
+        echo "no golden for $name, comparing against a scalar render of this build"
+        golden="$scratch/$name.wav"
+        missing=$((missing + 1))
+
+        if ! "$renderer" --generate "$signal" --params "$params" --isa scalar \
+            --golden "$golden" --update-golden > /dev/null; then
+            status=1
+            continue
+        fi
+    fi
+
+    # The golden is rendered with the scalar kernel; the default (best) kernel
+    # has to stay within the same tolerance.
+    "$renderer" --generate "$signal" --params "$params" --block-size "$block_sizes" \
+        --golden "$golden" --tolerance-dbfs "$tolerance" || status=1
+done
+
+if [ $status -eq 0 ] && [ $missing -gt 0 ]; then
+    echo "$missing case(s) without a golden in $golden_dir: run with --update and commit them"
+    exit 77
+fi
+
+exit $status
@@ -2,30 +2,89 @@
 
 VerticalMeter::VerticalMeter() : currentValue(0.0f)
 {
+    // Gain reduction falls back at 30 dB/s; the peak marker holds for 1.5 s.
+    ballistics.setDecayRate(30.0f);
+    ballistics.setHoldTime(1.5f);
+    ballistics.reset(0.0f);
 }
 
 VerticalMeter::~VerticalMeter() {}
 
-void VerticalMeter::setGainReduction(float dBValue)
+juce::Rectangle<float> VerticalMeter::getMeterBounds() const
 {
-    // Assume dBValue is positive: 0 = no reduction, 60 = full reduction.
-    dBValue = juce::jlimit(0.0f, 60.0f, dBValue);
-    if (dBValue != currentValue)
-    {
-        currentValue = dBValue;
-        repaint();
-    }
+    // Reduce slightly for a neat inset.
+    return getLocalBounds().toFloat().reduced(2.0f);
 }
 
-void VerticalMeter::setGainReduction(double dBValue)
+float VerticalMeter::levelToY(float gainReductionDB) const
 {
-    setGainReduction(static_cast<float>(dBValue));
+    const auto bounds = getMeterBounds();
+    return bounds.getBottom() - bounds.getHeight() * juce::jlimit(0.0f, 1.0f, gainReductionDB / maxDB);
 }
 
-void VerticalMeter::paint(juce::Graphics& g)
+juce::Rectangle<int> VerticalMeter::getTextArea() const
+{
+    return getMeterBounds().toNearestInt().withSizeKeepingCentre(getWidth(), 16);
+}
+
+void VerticalMeter::resized()
+{
+    // Green at 0 dB through yellow to red at full scale.
+    const auto bounds = getMeterBounds();
+    fillGradient = juce::ColourGradient(juce::Colours::red, bounds.getCentreX(), bounds.getY(),
+        juce::Colours::green, bounds.getCentreX(), bounds.getBottom(), false);
+    fillGradient.addColour(0.5, juce::Colours::yellow);
+
+    backgroundScale = 0.0f;
+    paintedFillY = paintedHoldY = paintedTenths = -1;
+    repaint();
+}
+
+void VerticalMeter::update(float gainReductionDB, float elapsedSeconds)
+{
+    // Assume gainReductionDB is positive: 0 = no reduction, 60 = full reduction.
+    ballistics.update(juce::jlimit(0.0f, maxDB, gainReductionDB), elapsedSeconds);
+    currentValue = ballistics.getValue();
+    peakHoldValue = ballistics.getPeakHold();
+
+    const int fillY = juce::roundToInt(levelToY(currentValue));
+    const int holdY = juce::roundToInt(levelToY(peakHoldValue));
+    const int tenths = juce::roundToInt(currentValue * 10.0f);
+
+    // Only the rows between the old and new bar top change (plus the rounded corners).
+    if (fillY != paintedFillY)
+    {
+        const int margin = static_cast<int>(cornerRadius) + 1;
+        const int top = juce::jmin(fillY, paintedFillY) - margin;
+        const int bottom = juce::jmax(fillY, paintedFillY) + margin;
+        repaint(0, top, getWidth(), bottom - top);
+        paintedFillY = fillY;
+    }
+
+    if (holdY != paintedHoldY)
+    {
+        repaint(0, paintedHoldY - 1, getWidth(), 3);
+        repaint(0, holdY - 1, getWidth(), 3);
+        paintedHoldY = holdY;
+    }
+
+    if (tenths != paintedTenths)
+    {
+        repaint(getTextArea());
+        paintedTenths = tenths;
+    }
+}
+
+void VerticalMeter::renderBackground(float scale)
 {
-    // Get our drawing bounds and reduce slightly for a neat inset.
-    auto bounds = getLocalBounds().toFloat().reduced(2.0f);
+    const int imageWidth = juce::jmax(1, juce::roundToInt(getWidth() * scale));
+    const int imageHeight = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+    backgroundImage = juce::Image(juce::Image::ARGB, imageWidth, imageHeight, true);
+    backgroundScale = scale;
+
+    juce::Graphics g(backgroundImage);
+    g.addTransform(juce::AffineTransform::scale(scale));
+    auto bounds = getMeterBounds();
 
     // Draw a subtle background gradient.
     juce::ColourGradient bgGradient(juce::Colours::darkgrey, bounds.getCentreX(), bounds.getY(),
@@ -34,29 +93,40 @@ void VerticalMeter::paint(juce::Graphics& g)
     g.fillRect(bounds);
 
     // Draw a rounded rectangle frame.
-    float cornerRadius = 6.0f;
     juce::Path meterFrame;
     meterFrame.addRoundedRectangle(bounds, cornerRadius);
     g.setColour(juce::Colours::grey);
     g.strokePath(meterFrame, juce::PathStrokeType(1.5f));
+}
 
-    // Compute the fill height (fraction from 0 to 1).
-    float fraction = juce::jlimit(0.0f, 1.0f, currentValue / 60.0f);
-    float fillHeight = bounds.getHeight() * fraction;
-    juce::Rectangle<float> fillRect(bounds.getX(), bounds.getBottom() - fillHeight,
-        bounds.getWidth(), fillHeight);
+void VerticalMeter::paint(juce::Graphics& g)
+{
+    auto bounds = getMeterBounds();
 
-    // Create a multi-stop gradient for a modern fill look:
-    // It goes from green at the top to yellow in the middle to red at the bottom.
-    juce::ColourGradient fillGradient(juce::Colours::green, fillRect.getCentreX(), fillRect.getY(),
-        juce::Colours::red, fillRect.getCentreX(), fillRect.getBottom(), false);
-    fillGradient.addColour(0.5, juce::Colours::yellow);
-    g.setGradientFill(fillGradient);
+    // Background and frame from the cache, re-rendered when the display scale changes.
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (scale != backgroundScale)
+        renderBackground(scale);
+
+    g.setOpacity(1.0f);
+    g.drawImage(backgroundImage, getLocalBounds().toFloat());
+
+    // Bar from the bottom up to the current level, filled from the scale-fixed gradient.
+    float fillTop = levelToY(currentValue);
+    juce::Rectangle<float> fillRect(bounds.getX(), fillTop, bounds.getWidth(), bounds.getBottom() - fillTop);
+
+    if (!fillRect.isEmpty())
+    {
+        juce::Path fillPath;
+        fillPath.addRoundedRectangle(fillRect, cornerRadius);
+        g.setGradientFill(fillGradient);
+        g.fillPath(fillPath);
+    }
 
-    // Draw the fill using a rounded rectangle.
-    juce::Path fillPath;
-    fillPath.addRoundedRectangle(fillRect, cornerRadius);
-    g.fillPath(fillPath);
+    // Peak-hold marker.
+    float holdY = levelToY(peakHoldValue);
+    g.setColour(juce::Colours::white.withAlpha(0.8f));
+    g.drawHorizontalLine(juce::roundToInt(holdY), bounds.getX() + 2.0f, bounds.getRight() - 2.0f);
 
     // Overlay the current gain reduction (in dB) as text.
     g.setColour(juce::Colours::white);
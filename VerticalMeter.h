@@ -1,24 +1,54 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MeterChannel.h"
 
+/**
+    Vertical gain reduction bar with a peak-hold line and a dB readout.
+
+    The background and frame are rendered once per size and display scale into
+    an image, and the fill gradient is fixed to the 0-60 dB scale, so a change
+    in level only touches the rows between the old and new bar top. update()
+    repaints just those rows, the peak-hold line and the readout, and nothing
+    at all when none of them moved by a visible amount.
+*/
 class VerticalMeter : public juce::Component
 {
 public:
     VerticalMeter();
     ~VerticalMeter() override;
 
-    void setGainReduction(float dBValue);
-    void setGainReduction(double dBValue); // Overloaded method
+    // Feeds the largest gain reduction (dB) since the last UI tick; ballistics run here.
+    void update(float gainReductionDB, float elapsedSeconds);
 
     void paint(juce::Graphics& g) override;
+    void resized() override;
 
 private:
     float currentValue = -60.0f;
+    float peakHoldValue = 0.0f;
+    MeterBallistics ballistics;
+
+    static constexpr float maxDB = 60.0f;
+    static constexpr float cornerRadius = 6.0f;
+
+    // Cached layers.
+    juce::Image backgroundImage;
+    float backgroundScale = 0.0f;
+    juce::ColourGradient fillGradient;
+
+    // What is currently on screen, in pixels and tenths of a dB (-1 = nothing yet).
+    int paintedFillY = -1;
+    int paintedHoldY = -1;
+    int paintedTenths = -1;
+
+    juce::Rectangle<float> getMeterBounds() const;
+    float levelToY(float gainReductionDB) const;
+    juce::Rectangle<int> getTextArea() const;
+    void renderBackground(float scale);
 
     void drawDbTicks(juce::Graphics& g);
     void drawSingleTick(juce::Graphics& g, float db);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VerticalMeter)
 };
-
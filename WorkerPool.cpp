@@ -0,0 +1,250 @@
+#include "WorkerPool.h"
+
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #include <immintrin.h>
+#endif
+
+namespace
+{
+    constexpr uint64_t taskMask = 0xffff;
+
+    // Idle backoff of the workers: spin, then yield, then park. A parked worker
+    // never holds up run(), which claims whatever tasks are left itself.
+    constexpr int spinIterations = 2000;
+    constexpr int yieldIterations = 20000;
+
+    inline void cpuRelax()
+    {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(_M_ARM64)
+        __asm__ __volatile__("yield");
+#endif
+    }
+}
+
+//==============================================================================
+class WorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker(WorkerPool& ownerPool, int index)
+        : juce::Thread("Compressor worker " + juce::String(index + 1)), pool(ownerPool)
+    {
+    }
+
+    void run() override
+    {
+        int idle = 0;
+
+        while (!threadShouldExit())
+        {
+            if (pool.runNextTask())
+            {
+                idle = 0;
+                continue;
+            }
+
+            if (idle < spinIterations)
+            {
+                cpuRelax();
+            }
+            else if (idle < yieldIterations)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                // Announce the park before the last look for work: run() publishes its
+                // job before it checks for parked workers, so one of the two sees the other.
+                parked.store(true);
+
+                if (!pool.hasPendingTask())
+                    wait(-1);
+
+                parked.store(false);
+                idle = 0;
+                continue;
+            }
+
+            ++idle;
+        }
+    }
+
+    bool isParked() const { return parked.load(); }
+
+    /** Wakes the worker if it is parked (or about to park). Signals an event, so never
+        from the audio thread. */
+    void wake()
+    {
+        if (parked.load())
+            notify();
+    }
+
+private:
+    WorkerPool& pool;
+    std::atomic<bool> parked{ false };
+};
+
+//==============================================================================
+class WorkerPool::Waker : public juce::Thread
+{
+public:
+    explicit Waker(WorkerPool& ownerPool)
+        : juce::Thread("Compressor worker waker"), pool(ownerPool)
+    {
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(wakeIntervalMs);
+
+            if (pool.wakeRequested.exchange(false))
+                pool.wakeParkedWorkers();
+        }
+    }
+
+private:
+    WorkerPool& pool;
+};
+
+//==============================================================================
+WorkerPool::WorkerPool()
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+}
+
+int WorkerPool::getDefaultNumWorkers()
+{
+    return juce::jlimit(0, 3, juce::SystemStats::getNumCpus() - 1);
+}
+
+void WorkerPool::start(int newNumWorkers)
+{
+    const juce::ScopedLock lock(startStopLock);
+    const int target = juce::jlimit(0, maxWorkers, newNumWorkers);
+
+    if (target > 0 && waker == nullptr)
+    {
+        waker = std::make_unique<Waker>(*this);
+        waker->startThread(juce::Thread::Priority::normal);
+    }
+
+    for (int i = numWorkers.load(std::memory_order_relaxed); i < target; ++i)
+    {
+        auto& worker = workers[static_cast<size_t>(i)];
+        worker = std::make_unique<Worker>(*this, i);
+
+        // Realtime priority where the platform grants it (workgroups on macOS), high otherwise.
+        if (!worker->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(8)))
+            worker->startThread(juce::Thread::Priority::highest);
+
+        numWorkers.store(i + 1, std::memory_order_release);
+    }
+}
+
+void WorkerPool::stop()
+{
+    const juce::ScopedLock lock(startStopLock);
+    const int count = numWorkers.load(std::memory_order_relaxed);
+    numWorkers.store(0, std::memory_order_release);
+
+    if (waker != nullptr)
+    {
+        waker->stopThread(1000);
+        waker.reset();
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        workers[static_cast<size_t>(i)]->signalThreadShouldExit();
+        workers[static_cast<size_t>(i)]->notify();
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        workers[static_cast<size_t>(i)]->stopThread(1000);
+        workers[static_cast<size_t>(i)].reset();
+    }
+}
+
+void WorkerPool::wakeParkedWorkers()
+{
+    const int count = numWorkers.load(std::memory_order_acquire);
+
+    for (int i = 0; i < count; ++i)
+        workers[static_cast<size_t>(i)]->wake();
+}
+
+bool WorkerPool::hasPendingTask() const
+{
+    const uint64_t state = jobState.load();
+    return (state & taskMask) < ((state >> 16) & taskMask);
+}
+
+bool WorkerPool::runNextTask()
+{
+    uint64_t state = jobState.load(std::memory_order_acquire);
+    const auto next = static_cast<int>(state & taskMask);
+    const auto count = static_cast<int>((state >> 16) & taskMask);
+
+    if (next >= count)
+        return false;
+
+    // The claim only succeeds while this job is still current, so its task and
+    // context stay valid until the task below is counted as completed.
+    if (!jobState.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+        return true;
+
+    {
+        const RealtimeMonitor::ScopedAttachment attached(jobMonitor);
+        jobTask(jobContext, next);
+    }
+
+    completedTasks.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void WorkerPool::run(Task task, void* context, int numTasks)
+{
+    const int count = numWorkers.load(std::memory_order_acquire);
+
+    if (count == 0 || numTasks <= 1)
+    {
+        for (int i = 0; i < numTasks; ++i)
+            task(context, i);
+        return;
+    }
+
+    jobTask = task;
+    jobContext = context;
+    jobMonitor = RealtimeMonitor::getCurrent();
+    completedTasks.store(0, std::memory_order_relaxed);
+
+    const uint64_t generation = (jobState.load(std::memory_order_relaxed) >> 32) + 1;
+    jobState.store((generation << 32) | (static_cast<uint64_t>(numTasks) << 16));
+
+    // Parked workers are woken by the waker, not here: signalling their event is a system call.
+    for (int i = 0; i < count && i < numTasks - 1; ++i)
+    {
+        if (workers[static_cast<size_t>(i)]->isParked())
+        {
+            wakeRequested.store(true);
+            break;
+        }
+    }
+
+    while (runNextTask())
+    {
+    }
+
+    while (completedTasks.load(std::memory_order_acquire) < numTasks)
+        cpuRelax();
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "RealtimeMonitor.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+//==============================================================================
+/**
+    A small pool of realtime worker threads for fork/join over the channel
+    groups (or bands) of one block.
+
+    run() publishes a job with a single atomic store, works on its tasks
+    itself, and spins until the workers have finished the ones they picked
+    up: the audio thread never takes a lock, allocates or makes a system call.
+    Tasks are claimed with a compare-and-swap on one 64-bit word holding the
+    job generation, the task count and the next index, so a worker that wakes
+    up late can never claim a task of a job that has already finished.
+
+    Idle workers spin briefly, then yield, then park on their thread's event,
+    so an idle pool costs next to nothing while back-to-back blocks still find
+    the workers awake. run() never signals that event itself: finding a worker
+    parked, it raises a flag that a normal-priority waker thread picks up
+    within wakeIntervalMs and wakes the workers from there, so the audio thread
+    makes no system call even after a long pause. run() only ever waits for
+    tasks a worker has already claimed and is running; tasks nobody picked up
+    (all of them, while the workers are still parked) are done by the calling
+    thread.
+
+    The pool can grow while run() is in use on another thread, so the owner
+    can start it from the message thread when multithreading is switched on.
+    Tasks run attached to the caller's RealtimeMonitor, so whatever a worker
+    allocates or locks is reported against the callback it works for.
+*/
+class WorkerPool
+{
+public:
+    using Task = void (*)(void* context, int index);
+
+    WorkerPool();
+    ~WorkerPool();
+
+    static constexpr int maxWorkers = 8;
+
+    /** How often the waker looks for a wake request from run(). */
+    static constexpr int wakeIntervalMs = 2;
+
+    /** Grows the pool to numWorkers threads (at most maxWorkers). Not realtime safe,
+        but may be called while run() is active on another thread. */
+    void start(int numWorkers);
+
+    /** Stops every worker. Not realtime safe; never while run() is active. */
+    void stop();
+
+    int getNumWorkers() const { return numWorkers.load(std::memory_order_acquire); }
+
+    /** Calls task(context, i) for i in [0, numTasks) across the workers and the
+        calling thread and returns once all have finished. */
+    void run(Task task, void* context, int numTasks);
+
+    template <typename Function>
+    void run(int numTasks, Function& function)
+    {
+        run([](void* context, int index) { (*static_cast<Function*>(context))(index); }, &function, numTasks);
+    }
+
+    /** Worker count that suits this machine: a few, leaving a core to the host. */
+    static int getDefaultNumWorkers();
+
+private:
+    class Worker;
+    class Waker;
+
+    // generation << 32 | numTasks << 16 | nextTask
+    std::atomic<uint64_t> jobState{ 0 };
+    std::atomic<int> completedTasks{ 0 };
+    Task jobTask{ nullptr };
+    void* jobContext{ nullptr };
+    RealtimeMonitor* jobMonitor{ nullptr }; // The caller's, so the workers count against its callback
+
+    // Workers [0, numWorkers) are running; start() publishes each one after creating it.
+    std::array<std::unique_ptr<Worker>, maxWorkers> workers;
+    std::atomic<int> numWorkers{ 0 };
+    juce::CriticalSection startStopLock;
+
+    // Set by run() when it finds a worker parked, cleared by the waker as it wakes them.
+    std::unique_ptr<Waker> waker;
+    std::atomic<bool> wakeRequested{ false };
+
+    bool hasPendingTask() const;
+    bool runNextTask();
+    void wakeParkedWorkers();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WorkerPool)
+};